@@ -0,0 +1,579 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include "adaptive.h"
+#include "nodepool.h"
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * adaptive contains three scan-resistant page replacement algorithms. LRU and FIFO
+ * evict a hot page as soon as a scan of more distinct pages than there are frames
+ * goes by; these keep some memory of recently evicted pages (ghosts) so that a
+ * page referenced only once can be told apart from one that is referenced again.
+ *
+ * - arc: Adaptive Replacement Cache (Megiddo & Modha, 2003). Resident pages are
+ *   split between T1 (seen once recently) and T2 (seen at least twice), with ghost
+ *   lists B1 and B2 remembering pages evicted from each. A hit on a ghost moves the
+ *   target size p of T1 towards the list that would have kept it.
+ * - 2q: the full 2Q algorithm (Johnson & Shasha, 1994). New pages go through a FIFO
+ *   A1in (a quarter of the frames); pages evicted from it are remembered in the
+ *   ghost FIFO A1out (half as many entries as frames), and only a page referenced
+ *   again while in A1out is admitted to the main LRU list Am.
+ * - lirs: Low Inter-reference Recency Set (Jiang & Zhang, 2002). Most frames hold
+ *   LIR pages, whose last two references were close together; the rest (1%, at least
+ *   one frame) hold HIR pages in a FIFO queue, which is where victims come from. A
+ *   recency stack orders every LIR page and recent HIR page, ghosts included.
+ *
+ * Each engine does O(1) work per reference. The pages tracked, resident or ghost,
+ * live in a pool of nodes on doubly linked lists (see nodepool.c). Ghosts are
+ * bounded by the number of frames: ARC tracks at most 2 * frames pages in all, 2Q at
+ * most frames / 2 ghosts, and LIRS at most frames ghosts (past that, the ghost
+ * evicted longest ago is dropped, a common bound for LIRS's otherwise unbounded
+ * stack).
+ *
+ * The engines count references and faults like every other engine (see policy.h),
+ * and fill empty frames in order before evicting anything.
+ *
+ * Usage:
+ *   Compile with another file; there is no main function
+ */
+
+//======================================================//
+
+#define ARC_T1 0	/* resident, referenced once recently */
+#define ARC_T2 1	/* resident, referenced at least twice recently */
+#define ARC_B1 2	/* ghost evicted from T1 */
+#define ARC_B2 3	/* ghost evicted from T2 */
+
+/* ARC: four lists of nodes (indexed by ARC_T1 .. ARC_B2), and the target size of T1 */
+struct arc_engine {
+	struct engine base;
+	struct node_pool pool;
+	struct dlist lists[4];
+	int p;
+};
+
+/*
+ * Function to set up an ARC engine with empty frames.
+ *		:param arr: an array of pages to be allocated
+ *		:param arr_size: the number of pages to be allocated
+ *		:param frame_num: the number of frames in physical memory
+ * **Returns**: the engine, or NULL if memory could not be allocated
+ */
+static struct engine * arc_init(page_t arr[], int arr_size, int frame_num) {
+	struct arc_engine *e = (struct arc_engine *) pool_engine_new(sizeof(struct arc_engine),
+		offsetof(struct arc_engine, pool), 2 * frame_num + 1, arr, arr_size, frame_num);
+	int i;
+	if (!e)
+		return NULL;
+	for (i = 0; i < 4; i++)
+		dlist_init(&e->lists[i]);
+	e->p = 0;
+	return &e->base;
+}
+
+/*
+ * Function to move a node to the head of one of ARC's lists.
+ *		:param e: the engine
+ *		:param node: the node (on one of the lists)
+ *		:param where: the list to move it to
+ */
+static void arc_move(struct arc_engine *e, int node, int where) {
+	dlist_remove(&e->pool.links, &e->lists[e->pool.where[node]], node);
+	dlist_push(&e->pool.links, &e->lists[where], node);
+	e->pool.where[node] = where;
+}
+
+/*
+ * Function to evict a page (ARC's REPLACE): the oldest of T1 if T1 is over its
+ * target size, else the oldest of T2. The page is remembered as a ghost.
+ *		:param e: the engine
+ *		:param in_b2: "boolean"; the page being brought in is a ghost on B2
+ * **Returns**: the frame slot the evicted page was in
+ */
+static int arc_replace(struct arc_engine *e, int in_b2) {
+	struct dlist *t1 = &e->lists[ARC_T1];
+	int victim;
+	if (t1->size >= 1 && ((in_b2 && t1->size == e->p) || t1->size > e->p)) {
+		victim = t1->tail;
+		arc_move(e, victim, ARC_B1);
+	}
+	else {
+		victim = e->lists[ARC_T2].tail;
+		arc_move(e, victim, ARC_B2);
+	}
+	return unload_page(&e->pool, victim);
+}
+
+/*
+ * Function to handle one reference under ARC.
+ *		:param e: the engine
+ *		:param page: the page referenced
+ * **Returns**: 1 if the page faulted, 0 otherwise
+ */
+static int arc_step(struct arc_engine *e, page_t page) {
+	struct dlist *lists = e->lists;
+	int c = e->base.frame_num, node, slot, delta;
+
+	if (c == 0) {
+		engine_count(&e->base, 1);
+		return 1;
+	}
+
+	node = pagemap_get(&e->pool.index, page);
+	if (node != -1 && e->pool.where[node] <= ARC_T2) {
+		/* hit: the page has now been referenced (at least) twice */
+		arc_move(e, node, ARC_T2);
+		engine_count(&e->base, 0);
+		return 0;
+	}
+
+	if (node != -1) {
+		/* ghost hit: grow the list the page was evicted from, then bring it back */
+		if (e->pool.where[node] == ARC_B1) {
+			delta = (lists[ARC_B2].size > lists[ARC_B1].size) ? lists[ARC_B2].size / lists[ARC_B1].size : 1;
+			e->p = (e->p + delta < c) ? e->p + delta : c;
+		}
+		else {
+			delta = (lists[ARC_B1].size > lists[ARC_B2].size) ? lists[ARC_B1].size / lists[ARC_B2].size : 1;
+			e->p = (e->p - delta > 0) ? e->p - delta : 0;
+		}
+		slot = arc_replace(e, e->pool.where[node] == ARC_B2);
+		arc_move(e, node, ARC_T2);
+	}
+	else {
+		/* a page not seen recently: make room in the directory, then in memory */
+		int l1 = lists[ARC_T1].size + lists[ARC_B1].size;
+		int total = l1 + lists[ARC_T2].size + lists[ARC_B2].size;
+		if (l1 == c) {
+			if (lists[ARC_T1].size < c) {
+				int ghost = lists[ARC_B1].tail;
+				dlist_remove(&e->pool.links, &lists[ARC_B1], ghost);
+				node_free(&e->pool, ghost);
+				slot = arc_replace(e, 0);
+			}
+			else {
+				/* B1 is empty: drop the oldest page of T1 outright */
+				int victim = lists[ARC_T1].tail;
+				dlist_remove(&e->pool.links, &lists[ARC_T1], victim);
+				slot = unload_page(&e->pool, victim);
+				node_free(&e->pool, victim);
+			}
+		}
+		else if (total >= c) {
+			if (total == 2 * c) {
+				int ghost = lists[ARC_B2].tail;
+				dlist_remove(&e->pool.links, &lists[ARC_B2], ghost);
+				node_free(&e->pool, ghost);
+			}
+			slot = arc_replace(e, 0);
+		}
+		else {
+			slot = e->base.num_allocated;
+		}
+
+		node = node_new(&e->pool, page);
+		e->pool.where[node] = ARC_T1;
+		dlist_push(&e->pool.links, &lists[ARC_T1], node);
+	}
+
+	load_page(&e->base, &e->pool, node, slot);
+	engine_count(&e->base, 1);
+	return 1;
+}
+
+/* ARC's access, batch access and destroy entry points (see struct policy) */
+static int arc_access(struct engine *engine, page_t page) {
+	return arc_step((struct arc_engine *) engine, page);
+}
+
+static void arc_access_batch(struct engine *engine, page_t pages[], int count) {
+	struct arc_engine *e = (struct arc_engine *) engine;
+	int i;
+	for (i = 0; i < count; i++)
+		arc_step(e, pages[i]);
+}
+
+static void arc_destroy(struct engine *engine) {
+	struct arc_engine *e = (struct arc_engine *) engine;
+	pool_destroy(&e->pool);
+	engine_free(engine);
+	free(e);
+}
+
+const struct policy arc_policy = {
+	"arc", "ARC", MAX_FAST_MEMORY_FRAMES, 0, 0, 0, NULL,
+	arc_init, arc_access, arc_access_batch, engine_stats, arc_destroy
+};
+
+//======================================================//
+
+#define TWOQ_AM 0		/* resident, on the main LRU list */
+#define TWOQ_A1IN 1		/* resident, on the FIFO of newly admitted pages */
+#define TWOQ_A1OUT 2	/* ghost evicted from A1in */
+
+/* 2Q: three lists of nodes (indexed by TWOQ_AM .. TWOQ_A1OUT), and the sizes
+ * A1in may grow to before it gives up a page, and A1out may grow to */
+struct twoq_engine {
+	struct engine base;
+	struct node_pool pool;
+	struct dlist lists[3];
+	int kin;
+	int kout;
+};
+
+/*
+ * Function to set up a 2Q engine with empty frames.
+ *		:param arr: an array of pages to be allocated
+ *		:param arr_size: the number of pages to be allocated
+ *		:param frame_num: the number of frames in physical memory
+ * **Returns**: the engine, or NULL if memory could not be allocated
+ */
+static struct engine * twoq_init(page_t arr[], int arr_size, int frame_num) {
+	struct twoq_engine *e = (struct twoq_engine *) pool_engine_new(sizeof(struct twoq_engine),
+		offsetof(struct twoq_engine, pool), frame_num + frame_num / 2 + 2, arr, arr_size, frame_num);
+	int i;
+	if (!e)
+		return NULL;
+	for (i = 0; i < 3; i++)
+		dlist_init(&e->lists[i]);
+	e->kin = frame_num / 4;
+	e->kout = frame_num / 2;
+	return &e->base;
+}
+
+/*
+ * Function to find a frame slot for a page being brought in (2Q's reclaimfor):
+ * a free one, else the oldest page of A1in if A1in is over its size (it becomes
+ * a ghost on A1out), else the least recently used page of Am.
+ *		:param e: the engine
+ * **Returns**: the frame slot
+ */
+static int twoq_reclaim(struct twoq_engine *e) {
+	struct dlist *lists = e->lists;
+	int victim, slot;
+
+	if (e->base.num_allocated < e->base.frame_num)
+		return e->base.num_allocated;
+
+	if (lists[TWOQ_A1IN].size > e->kin) {
+		victim = lists[TWOQ_A1IN].tail;
+		dlist_remove(&e->pool.links, &lists[TWOQ_A1IN], victim);
+		slot = unload_page(&e->pool, victim);
+		e->pool.where[victim] = TWOQ_A1OUT;
+		dlist_push(&e->pool.links, &lists[TWOQ_A1OUT], victim);
+		if (lists[TWOQ_A1OUT].size > e->kout) {
+			int ghost = lists[TWOQ_A1OUT].tail;
+			dlist_remove(&e->pool.links, &lists[TWOQ_A1OUT], ghost);
+			node_free(&e->pool, ghost);
+		}
+	}
+	else {
+		victim = lists[TWOQ_AM].tail;
+		dlist_remove(&e->pool.links, &lists[TWOQ_AM], victim);
+		slot = unload_page(&e->pool, victim);
+		node_free(&e->pool, victim);
+	}
+	return slot;
+}
+
+/*
+ * Function to handle one reference under 2Q.
+ *		:param e: the engine
+ *		:param page: the page referenced
+ * **Returns**: 1 if the page faulted, 0 otherwise
+ */
+static int twoq_step(struct twoq_engine *e, page_t page) {
+	struct dlist *lists = e->lists;
+	int node, slot;
+
+	if (e->base.frame_num == 0) {
+		engine_count(&e->base, 1);
+		return 1;
+	}
+
+	node = pagemap_get(&e->pool.index, page);
+	if (node != -1 && e->pool.where[node] != TWOQ_A1OUT) {
+		/* hit: a page on Am becomes the most recently used; one on A1in stays put */
+		if (e->pool.where[node] == TWOQ_AM) {
+			dlist_remove(&e->pool.links, &lists[TWOQ_AM], node);
+			dlist_push(&e->pool.links, &lists[TWOQ_AM], node);
+		}
+		engine_count(&e->base, 0);
+		return 0;
+	}
+
+	if (node != -1) {
+		/* referenced again soon after leaving A1in: admit it to Am (taking it off
+		 * A1out first, so making room can't drop it) */
+		dlist_remove(&e->pool.links, &lists[TWOQ_A1OUT], node);
+		slot = twoq_reclaim(e);
+		e->pool.where[node] = TWOQ_AM;
+		dlist_push(&e->pool.links, &lists[TWOQ_AM], node);
+	}
+	else {
+		slot = twoq_reclaim(e);
+		node = node_new(&e->pool, page);
+		e->pool.where[node] = TWOQ_A1IN;
+		dlist_push(&e->pool.links, &lists[TWOQ_A1IN], node);
+	}
+
+	load_page(&e->base, &e->pool, node, slot);
+	engine_count(&e->base, 1);
+	return 1;
+}
+
+/* 2Q's access, batch access and destroy entry points (see struct policy) */
+static int twoq_access(struct engine *engine, page_t page) {
+	return twoq_step((struct twoq_engine *) engine, page);
+}
+
+static void twoq_access_batch(struct engine *engine, page_t pages[], int count) {
+	struct twoq_engine *e = (struct twoq_engine *) engine;
+	int i;
+	for (i = 0; i < count; i++)
+		twoq_step(e, pages[i]);
+}
+
+static void twoq_destroy(struct engine *engine) {
+	struct twoq_engine *e = (struct twoq_engine *) engine;
+	pool_destroy(&e->pool);
+	engine_free(engine);
+	free(e);
+}
+
+const struct policy twoq_policy = {
+	"2q", "2Q", MAX_FAST_MEMORY_FRAMES, 0, 0, 0, NULL,
+	twoq_init, twoq_access, twoq_access_batch, engine_stats, twoq_destroy
+};
+
+//======================================================//
+
+#define LIRS_LIR 0		/* resident LIR page (always on the stack) */
+#define LIRS_HIR 1		/* resident HIR page (on the queue, and maybe the stack) */
+#define LIRS_GHOST 2	/* non-resident HIR page (on the stack, and the ghost list) */
+
+/* LIRS: the recency stack (with its own links), the queue of resident HIR pages and
+ * the list of ghosts (sharing the pool's links, since a node is on at most one of
+ * them), and the number of LIR pages (target and current) and ghosts allowed */
+struct lirs_engine {
+	struct engine base;
+	struct node_pool pool;
+	struct links stack_links;
+	char *in_stack;
+	struct dlist stack;
+	struct dlist queue;
+	struct dlist ghosts;
+	int lir_max;
+	int num_lir;
+	int ghost_max;
+};
+
+static void lirs_destroy(struct engine *engine);
+
+/*
+ * Function to set up a LIRS engine with empty frames.
+ *		:param arr: an array of pages to be allocated
+ *		:param arr_size: the number of pages to be allocated
+ *		:param frame_num: the number of frames in physical memory
+ * **Returns**: the engine, or NULL if memory could not be allocated
+ */
+static struct engine * lirs_init(page_t arr[], int arr_size, int frame_num) {
+	int pool_size = 2 * frame_num + 1;
+	struct lirs_engine *e = (struct lirs_engine *) pool_engine_new(sizeof(struct lirs_engine),
+		offsetof(struct lirs_engine, pool), pool_size, arr, arr_size, frame_num);
+	if (!e)
+		return NULL;
+	e->stack_links.prev = malloc(pool_size * sizeof(int));
+	e->stack_links.next = malloc(pool_size * sizeof(int));
+	e->in_stack = calloc(pool_size, sizeof(char));
+	if (!e->stack_links.prev || !e->stack_links.next || !e->in_stack) {
+		lirs_destroy(&e->base);
+		return NULL;
+	}
+
+	int hir_max = frame_num / 100;
+	if (hir_max < 1)
+		hir_max = 1;
+	e->lir_max = (frame_num > hir_max) ? frame_num - hir_max : 0;
+	e->num_lir = 0;
+	e->ghost_max = frame_num;
+	dlist_init(&e->stack);
+	dlist_init(&e->queue);
+	dlist_init(&e->ghosts);
+	return &e->base;
+}
+
+/*
+ * Function to move a node to the top of the recency stack.
+ *		:param e: the engine
+ *		:param node: the node
+ */
+static void lirs_stack_top(struct lirs_engine *e, int node) {
+	if (e->in_stack[node])
+		dlist_remove(&e->stack_links, &e->stack, node);
+	dlist_push(&e->stack_links, &e->stack, node);
+	e->in_stack[node] = 1;
+}
+
+/*
+ * Function to prune the recency stack: take HIR pages off its bottom until the
+ * bottom page is a LIR page. Ghosts taken off are forgotten.
+ *		:param e: the engine
+ */
+static void lirs_prune(struct lirs_engine *e) {
+	int node;
+	while (e->stack.size > 0 && e->pool.where[node = e->stack.tail] != LIRS_LIR) {
+		dlist_remove(&e->stack_links, &e->stack, node);
+		e->in_stack[node] = 0;
+		if (e->pool.where[node] == LIRS_GHOST) {
+			dlist_remove(&e->pool.links, &e->ghosts, node);
+			node_free(&e->pool, node);
+		}
+	}
+}
+
+/*
+ * Function to turn a HIR page on the stack (resident or ghost, and already off
+ * the queue and ghost list) into a LIR page, turning the LIR page at the bottom of
+ * the stack into a resident HIR page to make up for it.
+ *		:param e: the engine
+ *		:param node: the node of the page
+ */
+static void lirs_promote(struct lirs_engine *e, int node) {
+	e->pool.where[node] = LIRS_LIR;
+	lirs_stack_top(e, node);
+
+	int bottom = e->stack.tail;
+	dlist_remove(&e->stack_links, &e->stack, bottom);
+	e->in_stack[bottom] = 0;
+	e->pool.where[bottom] = LIRS_HIR;
+	dlist_push(&e->pool.links, &e->queue, bottom);
+	lirs_prune(e);
+}
+
+/*
+ * Function to handle one reference under LIRS.
+ *		:param e: the engine
+ *		:param page: the page referenced
+ * **Returns**: 1 if the page faulted, 0 otherwise
+ */
+static int lirs_step(struct lirs_engine *e, page_t page) {
+	int node, slot;
+
+	if (e->base.frame_num == 0) {
+		engine_count(&e->base, 1);
+		return 1;
+	}
+
+	node = pagemap_get(&e->pool.index, page);
+	if (node != -1 && e->pool.where[node] == LIRS_LIR) {
+		/* LIR hit: to the top of the stack, pruning if it was the bottom */
+		int was_bottom = (e->stack.tail == node);
+		lirs_stack_top(e, node);
+		if (was_bottom)
+			lirs_prune(e);
+		engine_count(&e->base, 0);
+		return 0;
+	}
+
+	if (node != -1 && e->pool.where[node] == LIRS_HIR) {
+		/* resident HIR hit: a page still on the stack was re-referenced sooner
+		 * than the oldest LIR page, so it becomes LIR; otherwise it stays HIR */
+		dlist_remove(&e->pool.links, &e->queue, node);
+		if (e->in_stack[node] && e->lir_max > 0) {
+			lirs_promote(e, node);
+		}
+		else {
+			lirs_stack_top(e, node);
+			dlist_push(&e->pool.links, &e->queue, node);
+		}
+		engine_count(&e->base, 0);
+		return 0;
+	}
+
+	/* a fault: a ghost leaves the ghost list first, so making room can't drop it */
+	if (node != -1)
+		dlist_remove(&e->pool.links, &e->ghosts, node);
+
+	if (e->base.num_allocated < e->base.frame_num) {
+		/* warming up: the first pages become LIR until there are lir_max of them */
+		slot = e->base.num_allocated;
+		node = node_new(&e->pool, page);
+		if (e->num_lir < e->lir_max) {
+			e->pool.where[node] = LIRS_LIR;
+			e->num_lir++;
+			lirs_stack_top(e, node);
+		}
+		else {
+			e->pool.where[node] = LIRS_HIR;
+			lirs_stack_top(e, node);
+			dlist_push(&e->pool.links, &e->queue, node);
+		}
+	}
+	else {
+		/* evict the oldest resident HIR page; it stays on the stack as a ghost */
+		int victim = e->queue.tail;
+		dlist_remove(&e->pool.links, &e->queue, victim);
+		slot = unload_page(&e->pool, victim);
+		if (e->in_stack[victim]) {
+			e->pool.where[victim] = LIRS_GHOST;
+			dlist_push(&e->pool.links, &e->ghosts, victim);
+			if (e->ghosts.size > e->ghost_max) {
+				int ghost = e->ghosts.tail;
+				dlist_remove(&e->pool.links, &e->ghosts, ghost);
+				dlist_remove(&e->stack_links, &e->stack, ghost);
+				e->in_stack[ghost] = 0;
+				node_free(&e->pool, ghost);
+			}
+		}
+		else {
+			node_free(&e->pool, victim);
+		}
+
+		if (node != -1 && e->lir_max > 0) {
+			lirs_promote(e, node);
+		}
+		else {
+			if (node == -1)
+				node = node_new(&e->pool, page);
+			e->pool.where[node] = LIRS_HIR;
+			lirs_stack_top(e, node);
+			dlist_push(&e->pool.links, &e->queue, node);
+		}
+	}
+
+	load_page(&e->base, &e->pool, node, slot);
+	engine_count(&e->base, 1);
+	return 1;
+}
+
+/* LIRS's access, batch access and destroy entry points (see struct policy) */
+static int lirs_access(struct engine *engine, page_t page) {
+	return lirs_step((struct lirs_engine *) engine, page);
+}
+
+static void lirs_access_batch(struct engine *engine, page_t pages[], int count) {
+	struct lirs_engine *e = (struct lirs_engine *) engine;
+	int i;
+	for (i = 0; i < count; i++)
+		lirs_step(e, pages[i]);
+}
+
+static void lirs_destroy(struct engine *engine) {
+	struct lirs_engine *e = (struct lirs_engine *) engine;
+	pool_destroy(&e->pool);
+	free(e->stack_links.prev);
+	free(e->stack_links.next);
+	free(e->in_stack);
+	engine_free(engine);
+	free(e);
+}
+
+const struct policy lirs_policy = {
+	"lirs", "LIRS", MAX_FAST_MEMORY_FRAMES, 0, 0, 0, NULL,
+	lirs_init, lirs_access, lirs_access_batch, engine_stats, lirs_destroy
+};
@@ -0,0 +1,10 @@
+#ifndef ADAPTIVE_H
+#define ADAPTIVE_H
+
+#include "policy.h"
+
+extern const struct policy arc_policy;
+extern const struct policy twoq_policy;
+extern const struct policy lirs_policy;
+
+#endif
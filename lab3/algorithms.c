@@ -1,5 +1,13 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <limits.h>
+#include "page.h"
+#include "pagemap.h"
+#include "policy.h"
+#include "smallframe.h"
+#include "stackdist.h"
+
+#define CFLRU_WINDOW 4	/* cflru: a quarter of the frames are the clean-first region */
 
 /* 
  * Author: Peter Mountanos
@@ -9,9 +17,26 @@
  * algorithms contains the implementation of two different page replacement algorithms,
  * namely the FIFO policy and the LRU policy. This source file also contains several 
  * utility methods which execute common functionality between the two different policies.
- * One of those utility functions is display, which provides the code for the common 
- * visual simulation for the page replacement process. Note, this function only gets 
- * called if the lru or fifo algorithms are run in verbose mode.
+ * The display function, which provides the code for the common visual simulation
+ * for the page replacement process, lives in display.c. Note, this function only
+ * gets called if the algorithms are run in verbose mode.
+ *
+ * lru_fast is a second LRU implementation for large numbers of frames. It keeps the
+ * resident pages on an intrusive recency list and finds them through a hash index
+ * (see pagemap.c), so a hit or an eviction costs O(1) instead of O(frames).
+ * extra_fast is the matching version of the optimal policy: it precomputes when each
+ * page is next used and keeps the frames in a max-heap ordered by that time.
+ * cflru is lru_fast made to prefer evicting clean pages, which cost nothing to
+ * throw away, over dirty ones, which have to be written back first.
+ *
+ * For up to SMALL_MAX_FRAMES frames, lru and extra hand the work to fixed-width
+ * versions of themselves (see smallframe.c) that give the same results without
+ * scanning every frame on every reference.
+ *
+ * Each algorithm is written as an engine that handles one reference at a time (see
+ * policy.h), and is registered by the struct policy after it (e.g., lru_policy).
+ * The engines share the counting rules and the frames array, so display works on
+ * any of them.
  * 
  * Usage:
  *   Compile with another file; there is no main function
@@ -19,22 +44,6 @@
 
 //======================================================//
 
-/*
- * Function to search for a value in an array. 
- * 		:param arr: array to be searched
- *		:param size: size of array
- *		:param item: item to search array for
- * **Returns**: index of item if it's in the array, -1 otherwise. 
- */
-int search(int arr[], int size, int item) {	
-	int i;
-	for (i = 0; i < size; i++) {
-		if (arr[i] == item)
-			return i;
-	}
-	return -1;
-}
-
 /*
  * Function to increment each value in an array by one.
  *		:param arr: array where values should be incremented
@@ -62,6 +71,24 @@ int find_max(int arr[], int size) {
 	return max_index;
 }
 
+/*
+ * Function to find the span of the page numbers in a reference string, which the
+ * residency index uses to decide whether it can look pages up directly.
+ *		:param arr: an array of pages to be allocated
+ *		:param arr_size: the number of pages to be allocated
+ * **Returns**: one more than the largest page in arr (0 if arr is empty, or if the
+ * largest page is the biggest 64-bit value)
+ */
+page_t page_span(page_t arr[], int arr_size) {
+	page_t max = 0;
+	int i;
+	for (i = 0; i < arr_size; i++) {
+		if (arr[i] >= max)
+			max = arr[i] + 1;
+	}
+	return max;
+}
+
 /*
  * Function to find the optimal value to replace. This is for the 
  * extra credit replacement algorithm. It follows the optimal replacement
@@ -75,7 +102,7 @@ int find_max(int arr[], int size) {
  * a page reference the farthest in the future, or not at all. If there are multiple frames
  * with no future reference, it returns the first.
  */
- int find_opt(int pages[], int num_pages, int frames[], int num_frames, int num_read) {
+ int find_opt(page_t pages[], int num_pages, page_t frames[], int num_frames, int num_read) {
 
  	/* start each page in memory to be maximum distance away from use */ 
  	int dist_from_use[num_frames], i;
@@ -99,200 +126,500 @@ int find_max(int arr[], int size) {
  }
 
 /*
- * Function to output the current status of the frames to stdout. The
- * specifications of how the frames are displayed are given in the 
- * assignment prompt.
- *		:param frames: array containing the current pages in physical memory
- *		:param num_frames: the number of frames allocated in physical memory
- *		:param page: the current page that has to be allocated
- *		:param faulted: "boolean" value which indicates if the page resulted
- *						in a fault of not (used for printing F is so)
+ * A first-in-first-out (FIFO) page replacement algorithm implementation, as specified
+ * by the assignment. On top of the state every engine shares, it keeps:
+ *	- index: page -> frame slot index of the resident pages
+ *	- pointer: value storing the index of the current object that was first allocated
+ *			   (to be used for replacement part)
  */
-void display(int frames[], int num_frames, int page, int faulted) {
+struct fifo_engine {
+	struct engine base;
+	struct pagemap index;
+	int pointer;
+};
 
-	/* for each frame pos, print it out followed by | */
-	printf("%2d: [", page);
-	int i;
-	for (i = 0; i < num_frames-1; i++) {
-		/* if unallocated, print two empty spaces */
-		if (frames[i] == -1) 
-			printf("  |");
-		else 
-			printf("%2d|", frames[i]);
+static void fifo_destroy(struct engine *engine);
+
+/*
+ * Function to set up a FIFO engine with empty frames.
+ *		:param arr: an array of pages to be allocated
+ *		:param arr_size: the number of pages to be allocated
+ *		:param frame_num: the number of frames in physical memory
+ * **Returns**: the engine, or NULL if memory could not be allocated
+ */
+static struct engine * fifo_init(page_t arr[], int arr_size, int frame_num) {
+	struct fifo_engine *e = calloc(1, sizeof(struct fifo_engine));
+	if (!e)
+		return NULL;
+	if (engine_init(&e->base, frame_num) != 0 ||
+		pagemap_init(&e->index, frame_num, page_span(arr, arr_size)) != 0) {
+		fifo_destroy(&e->base);
+		return NULL;
+	}
+	e->pointer = 0;
+	return &e->base;
+}
+
+/*
+ * Function to handle one reference under the FIFO policy.
+ *		:param e: the engine
+ *		:param page: the page referenced
+ * **Returns**: 1 if the page faulted, 0 otherwise
+ */
+static int fifo_step(struct fifo_engine *e, page_t page) {
+	page_t *frames = e->base.frames;
+	int faulted = 0;
+
+	/* is page is not in frame, replacement is needed (with no frames at all,
+	 * every reference is a fault and nothing is kept) */
+	if (pagemap_get(&e->index, page) == -1) {
+		faulted = 1;
+		if (e->base.frame_num > 0) {
+			/* replace first in with current page */
+			if (frames[e->pointer] != PAGE_NONE)
+				pagemap_remove(&e->index, frames[e->pointer]);
+			frames[e->pointer] = page;
+			pagemap_put(&e->index, page, e->pointer);
+			e->base.slot = e->pointer;
+			e->pointer = (e->pointer + 1) % e->base.frame_num;
+		}
 	}
 
-	/* for the last element, don't include | */
-	if (frames[i] == -1)
-		printf("  ");
-	else
-		printf("%2d", frames[i]);
+	engine_count(&e->base, faulted);
+	return faulted;
+}
 
-	/* if current operation was a fault, print F after frame */
-	if (faulted)
-		printf("] F\n");
-	else
-		printf("]\n");
+/* FIFO's access, batch access and destroy entry points (see struct policy) */
+static int fifo_access(struct engine *engine, page_t page) {
+	return fifo_step((struct fifo_engine *) engine, page);
+}
+
+static void fifo_access_batch(struct engine *engine, page_t pages[], int count) {
+	struct fifo_engine *e = (struct fifo_engine *) engine;
+	int i;
+	for (i = 0; i < count; i++)
+		fifo_step(e, pages[i]);
 }
 
+static void fifo_destroy(struct engine *engine) {
+	struct fifo_engine *e = (struct fifo_engine *) engine;
+	pagemap_destroy(&e->index);
+	engine_free(engine);
+	free(e);
+}
+
+const struct policy fifo_policy = {
+	"fifo", "FIFO", MAX_FAST_MEMORY_FRAMES, 0, 0, 0, NULL,
+	fifo_init, fifo_access, fifo_access_batch, engine_stats, fifo_destroy
+};
+
 /*
- * A first-in-first-out (FIFO) page replacement algorithm implementation, as specified
- * by the assignment.
+ * A least-recently-used (LRU) page replacement algorithm implementation, as specified
+ * by the assignment. Every frame has an `age`, the number of references since its
+ * page was last used; the oldest frame is the victim. On top of the state every
+ * engine shares, it keeps:
+ *	- index: page -> frame slot index of the resident pages
+ *	- last_used: the `age` of each frame
+ *	- small: the fixed-width version that runs instead, for few enough frames
+ *			 (see smallframe.c), or NULL
+ */
+struct lru_engine {
+	struct engine base;
+	struct pagemap index;
+	int *last_used;
+	struct small_frames *small;
+};
+
+static void lru_destroy(struct engine *engine);
+
+/*
+ * Function to set up an LRU engine with empty frames.
  *		:param arr: an array of pages to be allocated
  *		:param arr_size: the number of pages to be allocated
- *		:param frame_nun: the number of frames in physical memory
- *		:param stats: an array which will eventually store the number of page faults
- *					  for this run of the algorithm (at index 0), and the number of
- *					  references (at index 1). These are then used in by the caller
- *					  to calculate the miss rate
- *		:param verbose: "boolean" to indicate whether to run in verbose mode or not;
- *						if so, then each allocation process is displayed.
+ *		:param frame_num: the number of frames in physical memory
+ * **Returns**: the engine, or NULL if memory could not be allocated
  */
-void fifo(int arr[], int arr_size, int frame_num, int stats[], int verbose) {
-	
-	/* initialize frame array to -1's */
-	int frames[frame_num], i;
-	for (i = 0; i < frame_num; i++) {
-		frames[i] = -1;
+static struct engine * lru_init(page_t arr[], int arr_size, int frame_num) {
+	struct lru_engine *e = calloc(1, sizeof(struct lru_engine));
+	if (!e)
+		return NULL;
+	if (engine_init(&e->base, frame_num) != 0) {
+		lru_destroy(&e->base);
+		return NULL;
 	}
 
-	/* initialize local variables: 
-	 *	- res: stores the result of whether or not the page is already in memory
-	 *	- num_faults: stores the current number of page faults that have occured
-	 *	- num_refs: stores the current number of page references that have occured
-	 * 	- faulted: temp boolean value to determine if the current page resulted in
-	 *			   a fault or not
-	 *	- is_filled: boolean value to determine if the frames are filled
-	 *	- pointer: value storing the index of the current object that was first allocated
-	 *			   (to be used for replacement part)
-	 *	- num_allocated: stores the current number of pages allocated into a frame
-	 */
-	int res, num_faults = 0, num_refs = 0, is_filled = 0;
-	int faulted, num_allocated = 0, pointer = 0;
+	/* few enough frames for the fixed-width version */
+	if (frame_num >= 1 && frame_num <= SMALL_MAX_FRAMES) {
+		if (!(e->small = small_frames_new(frame_num, arr, arr_size, 0))) {
+			lru_destroy(&e->base);
+			return NULL;
+		}
+		return &e->base;
+	}
 
-	for (i = 0; i < arr_size; i++) {
+	if (!(e->last_used = calloc(frame_num + 1, sizeof(int))) ||
+		pagemap_init(&e->index, frame_num, page_span(arr, arr_size)) != 0) {
+		lru_destroy(&e->base);
+		return NULL;
+	}
+	return &e->base;
+}
 
-		/* see if page is already in frames */
-		res = search(frames, frame_num, arr[i]);
-		faulted = 0;
+/*
+ * Function to handle one reference under the LRU policy.
+ *		:param e: the engine
+ *		:param page: the page referenced
+ * **Returns**: 1 if the page faulted, 0 otherwise
+ */
+static int lru_step(struct lru_engine *e, page_t page) {
+	page_t *frames = e->base.frames;
+	int frame_num = e->base.frame_num, faulted = 0;
 
-		/* if the frame is full, count towards references */
-		if (is_filled || num_allocated >= frame_num) {
-			is_filled = 1;
-			num_refs++;
-		}
+	/* increment `age` of current pages in frames */
+	increment_arr(e->last_used, frame_num);
 
-		/* is page is not in frame, replacement is needed */
-		if (res == -1) {
-			/* results in a fault (but may not be counted towards num of page faults) */
-			num_allocated++;
-			faulted = 1;
+	/* see if page is already in frames */
+	int res = pagemap_get(&e->index, page);
 
-			/* replace first in with current page */
-			frames[pointer] = arr[i];
-			pointer = (pointer + 1) % frame_num;
-		}
+	/* is page is not in frame, replacement is needed */
+	if (res == -1) {
+		faulted = 1;
+		if (frame_num > 0) {
+			/* find least recently used page in frames */
+			int victim = find_max(e->last_used, frame_num);
 
-		/* if the frame is full, and the page wasn't in frame then count towards faults */
-		if (is_filled && faulted) {
-			num_faults++;
+			/* replace LRU element w/ page, and reset `age` */
+			if (frames[victim] != PAGE_NONE)
+				pagemap_remove(&e->index, frames[victim]);
+			frames[victim] = page;
+			pagemap_put(&e->index, page, victim);
+			e->base.slot = victim;
+			e->last_used[victim] = 0;
 		}
+	}
+	else {
+		/* if in frame, just reset `age` (b/c just called) */
+		e->last_used[res] = 0;
+	}
 
-		/* only print current operation if verbose mode is on */
-		if (verbose)
-			display(frames, frame_num, arr[i], (faulted && is_filled));
+	engine_count(&e->base, faulted);
+	return faulted;
+}
+
+/* LRU's access, batch access and destroy entry points (see struct policy) */
+static int lru_access(struct engine *engine, page_t page) {
+	struct lru_engine *e = (struct lru_engine *) engine;
+	if (e->small)
+		return small_access(engine, e->small, page);
+	return lru_step(e, page);
+}
+
+static void lru_access_batch(struct engine *engine, page_t pages[], int count) {
+	struct lru_engine *e = (struct lru_engine *) engine;
+	int i;
+	if (e->small) {
+		small_batch(engine, e->small, pages, count);
+		return;
 	}
+	for (i = 0; i < count; i++)
+		lru_step(e, pages[i]);
+}
 
-	/* set number of faults and references to 'return' array so miss
-	 * rate can be calculated by the caller function */
-	stats[0] = num_faults;
-	stats[1] = num_refs;
+static void lru_destroy(struct engine *engine) {
+	struct lru_engine *e = (struct lru_engine *) engine;
+	if (e->small) {
+		small_frames_free(e->small);
+	}
+	else {
+		pagemap_destroy(&e->index);
+		free(e->last_used);
+	}
+	engine_free(engine);
+	free(e);
 }
 
+const struct policy lru_policy = {
+	"lru", "LRU", MAX_MEMORY_FRAMES, 1, 0, 0, lru_stack_profile,
+	lru_init, lru_access, lru_access_batch, engine_stats, lru_destroy
+};
+
 /*
- * A least-recently-used (LRU) page replacement algorithm implementation, as specified
- * by the assignment.
+ * A doubly linked recency list threaded through the frame slots. Slot s is linked
+ * to the slot used just after it (newer[s]) and just before it (older[s]); -1 marks
+ * the ends of the list.
+ */
+struct recency_list {
+	int *newer;
+	int *older;
+	int mru;	/* most recently used slot, or -1 if the list is empty */
+	int lru;	/* least recently used slot, or -1 if the list is empty */
+};
+
+/*
+ * Function to remove a slot from a recency list.
+ *		:param list: the list the slot is on
+ *		:param slot: the slot to unlink
+ */
+void list_unlink(struct recency_list *list, int slot) {
+	if (list->older[slot] != -1)
+		list->newer[list->older[slot]] = list->newer[slot];
+	else
+		list->lru = list->newer[slot];
+
+	if (list->newer[slot] != -1)
+		list->older[list->newer[slot]] = list->older[slot];
+	else
+		list->mru = list->older[slot];
+}
+
+/*
+ * Function to link a slot in as the most recently used one.
+ *		:param list: the list to add to
+ *		:param slot: the slot to link (must not be on the list already)
+ */
+void list_push_mru(struct recency_list *list, int slot) {
+	list->older[slot] = list->mru;
+	list->newer[slot] = -1;
+	if (list->mru != -1)
+		list->newer[list->mru] = slot;
+	else
+		list->lru = slot;
+	list->mru = slot;
+}
+
+/*
+ * An O(1) least-recently-used (LRU) page replacement algorithm implementation. It
+ * produces exactly the same faults, references, and frame layout as lru, but the
+ * frames are kept on a recency list and resident pages are found through a hash
+ * index, rather than ageing and scanning every frame on each reference. On top of
+ * the state every engine shares, it keeps:
+ *	- list: the allocated slots, from least to most recently used
+ *	- index: page -> frame slot index of the resident pages
+ */
+struct lru_fast_engine {
+	struct engine base;
+	struct recency_list list;
+	struct pagemap index;
+};
+
+static void lru_fast_destroy(struct engine *engine);
+
+/*
+ * Function to set up a fast LRU engine with empty frames.
  *		:param arr: an array of pages to be allocated
  *		:param arr_size: the number of pages to be allocated
- *		:param frame_nun: the number of frames in physical memory
- *		:param stats: an array which will eventually store the number of page faults
- *					  for this run of the algorithm (at index 0), and the number of
- *					  references (at index 1). These are then used in by the caller
- *					  to calculate the miss rate
- *		:param verbose: "boolean" to indicate whether to run in verbose mode or not;
- *						if so, then each allocation process is displayed.
+ *		:param frame_num: the number of frames in physical memory
+ * **Returns**: the engine, or NULL if memory could not be allocated
  */
-void lru(int arr[], int arr_size, int frame_num, int stats[], int verbose) {
+static struct engine * lru_fast_init(page_t arr[], int arr_size, int frame_num) {
+	struct lru_fast_engine *e = calloc(1, sizeof(struct lru_fast_engine));
+	if (!e)
+		return NULL;
+	if (engine_init(&e->base, frame_num) != 0 ||
+		!(e->list.newer = malloc((frame_num + 1) * sizeof(int))) ||
+		!(e->list.older = malloc((frame_num + 1) * sizeof(int))) ||
+		pagemap_init(&e->index, frame_num, page_span(arr, arr_size)) != 0) {
+		lru_fast_destroy(&e->base);
+		return NULL;
+	}
+	e->list.mru = e->list.lru = -1;
+	return &e->base;
+}
 
-	/* initialize frame array to -1's, and last_used array to 0's */
-	int frames[frame_num], last_used[frame_num], i;
-	for (i = 0; i < frame_num; i++) {
-		frames[i] = -1;
-		last_used[i] = 0;
+/*
+ * Function to handle one reference under the fast LRU policy.
+ *		:param e: the engine
+ *		:param page: the page referenced
+ * **Returns**: 1 if the page faulted, 0 otherwise
+ */
+static int lru_fast_step(struct lru_fast_engine *e, page_t page) {
+	int faulted = 0;
+
+	/* see if page is already in frames */
+	int res = pagemap_get(&e->index, page);
+
+	/* is page is not in frame, replacement is needed (with no frames at all,
+	 * every reference is a fault and nothing is kept) */
+	if (res == -1) {
+		faulted = 1;
+		if (e->base.frame_num > 0) {
+			/* fill unallocated frames in order (as lru does), then evict the LRU slot */
+			if (e->base.num_allocated < e->base.frame_num) {
+				res = e->base.num_allocated;
+			}
+			else {
+				res = e->list.lru;
+				list_unlink(&e->list, res);
+				pagemap_remove(&e->index, e->base.frames[res]);
+			}
+
+			e->base.frames[res] = page;
+			pagemap_put(&e->index, page, res);
+			e->base.slot = res;
+			list_push_mru(&e->list, res);
+		}
+	}
+	else if (res != e->list.mru) {
+		/* if in frame, just move it to the front (b/c just called) */
+		list_unlink(&e->list, res);
+		list_push_mru(&e->list, res);
 	}
 
-	/* initialize local variables: 
-	 *	- res: stores the result of whether or not the page is already in memory
-	 *	- num_faults: stores the current number of page faults that have occured
-	 *	- num_refs: stores the current number of page references that have occured
-	 * 	- faulted: temp boolean value to determine if the current page resulted in
-	 *			   a fault or not
-	 *	- is_filled: boolean value to determine if the frames are filled
-	 *	- num_allocated: stores the current number of pages allocated into a frame
-	 */
-	int res, faulted = 0, is_filled = 0;
-	int num_faults = 0, num_refs = 0, num_allocated = 0;
-
-	/* for each page in arr...follow LRU replacement policy */
-	for (i = 0; i < arr_size; i++) {
+	engine_count(&e->base, faulted);
+	return faulted;
+}
 
-		/* increment `age` of current pages in frames */
-		increment_arr(last_used, frame_num);
+/* fast LRU's access, batch access and destroy entry points (see struct policy) */
+static int lru_fast_access(struct engine *engine, page_t page) {
+	return lru_fast_step((struct lru_fast_engine *) engine, page);
+}
 
-		/* see if page is already in frames */
-		res = search(frames, frame_num, arr[i]);
-		faulted = 0;
+static void lru_fast_access_batch(struct engine *engine, page_t pages[], int count) {
+	struct lru_fast_engine *e = (struct lru_fast_engine *) engine;
+	int i;
+	for (i = 0; i < count; i++)
+		lru_fast_step(e, pages[i]);
+}
 
-		/* if the frame is full, count towards references */
-		if (is_filled || num_allocated >= frame_num) {
-			is_filled = 1;
-			num_refs++;
-		}
+static void lru_fast_destroy(struct engine *engine) {
+	struct lru_fast_engine *e = (struct lru_fast_engine *) engine;
+	pagemap_destroy(&e->index);
+	free(e->list.newer);
+	free(e->list.older);
+	engine_free(engine);
+	free(e);
+}
 
-		/* is page is not in frame, replacement is needed */
-		if (res == -1) {
-			/* find least recently used page in frames */
-			int index = find_max(last_used, frame_num);
+const struct policy fastlru_policy = {
+	"fastlru", "FASTLRU", MAX_FAST_MEMORY_FRAMES, 0, 0, 0, lru_stack_profile,
+	lru_fast_init, lru_fast_access, lru_fast_access_batch, engine_stats, lru_fast_destroy
+};
 
-			/* replace LRU element w/ page, and reset `age` */
-			frames[index] = arr[i];
-			last_used[index] = 0;
+/*
+ * A clean-first LRU (CFLRU) page replacement algorithm implementation (Park et al.,
+ * 2006). The recency list is split in two: the working region, and the clean-first
+ * region of the 1 / CFLRU_WINDOW least recently used pages. A fault evicts the
+ * least recently used clean page of the clean-first region, and only evicts a
+ * dirty page (the least recently used one) when every page there is dirty. Reads
+ * and writes of a page are known from engine->writing; with no writes at all,
+ * every page is clean and it is exactly fastlru. On top of the state every engine
+ * shares, it keeps:
+ *	- list: the allocated slots, from least to most recently used
+ *	- index: page -> frame slot index of the resident pages
+ *	- dirty: whether each slot's page has been written since it was loaded
+ *	- window: the number of pages in the clean-first region (at least 1)
+ */
+struct cflru_engine {
+	struct engine base;
+	struct recency_list list;
+	struct pagemap index;
+	unsigned char *dirty;
+	int window;
+};
+
+static void cflru_destroy(struct engine *engine);
 
-			/* increment number allocated, and set faulted to true */
-			num_allocated++;
-			faulted = 1;
+/*
+ * Function to set up a clean-first LRU engine with empty frames.
+ *		:param arr: an array of pages to be allocated
+ *		:param arr_size: the number of pages to be allocated
+ *		:param frame_num: the number of frames in physical memory
+ * **Returns**: the engine, or NULL if memory could not be allocated
+ */
+static struct engine * cflru_init(page_t arr[], int arr_size, int frame_num) {
+	struct cflru_engine *e = calloc(1, sizeof(struct cflru_engine));
+	if (!e)
+		return NULL;
+	if (engine_init(&e->base, frame_num) != 0 ||
+		!(e->list.newer = malloc((frame_num + 1) * sizeof(int))) ||
+		!(e->list.older = malloc((frame_num + 1) * sizeof(int))) ||
+		!(e->dirty = calloc(frame_num + 1, 1)) ||
+		pagemap_init(&e->index, frame_num, page_span(arr, arr_size)) != 0) {
+		cflru_destroy(&e->base);
+		return NULL;
+	}
+	e->list.mru = e->list.lru = -1;
+	e->window = (frame_num / CFLRU_WINDOW > 1) ? frame_num / CFLRU_WINDOW : 1;
+	return &e->base;
+}
+
+/*
+ * Function to handle one reference under the clean-first LRU policy.
+ *		:param e: the engine
+ *		:param page: the page referenced
+ *		:param write: "boolean"; the reference writes the page
+ * **Returns**: 1 if the page faulted, 0 otherwise
+ */
+static int cflru_step(struct cflru_engine *e, page_t page, int write) {
+	int faulted = 0, res = pagemap_get(&e->index, page), slot, i;
+
+	if (res == -1) {
+		faulted = 1;
+		if (e->base.frame_num > 0) {
+			if (e->base.num_allocated < e->base.frame_num) {
+				res = e->base.num_allocated;
+			}
+			else {
+				/* the oldest clean page of the clean-first region, else the LRU page */
+				res = e->list.lru;
+				for (slot = e->list.lru, i = 0; slot != -1 && i < e->window;
+					 slot = e->list.newer[slot], i++) {
+					if (!e->dirty[slot]) {
+						res = slot;
+						break;
+					}
+				}
+				list_unlink(&e->list, res);
+				pagemap_remove(&e->index, e->base.frames[res]);
+			}
+
+			e->base.frames[res] = page;
+			pagemap_put(&e->index, page, res);
+			e->base.slot = res;
+			e->dirty[res] = write;
+			list_push_mru(&e->list, res);
 		}
-		else {
-			/* if in frame, just reset `age` (b/c just called) */
-			last_used[res] = 0;
+	}
+	else {
+		if (res != e->list.mru) {
+			list_unlink(&e->list, res);
+			list_push_mru(&e->list, res);
 		}
+		e->dirty[res] |= write;
+	}
 
-		/* if the frame is full, and the page wasn't in frame then count towards faults */
-		if (is_filled && faulted) {
-			num_faults++;
-		}
+	engine_count(&e->base, faulted);
+	return faulted;
+}
 
-		/* only print current operation if verbose mode is on */
-		if (verbose)
-			display(frames, frame_num, arr[i], (faulted && is_filled));
-	}
+/* clean-first LRU's access, batch access (all reads, so exactly fastlru; see
+ * struct policy's writes) and destroy entry points */
+static int cflru_access(struct engine *engine, page_t page) {
+	return cflru_step((struct cflru_engine *) engine, page, engine->writing);
+}
 
-	/* set number of faults and references to 'return' array so miss
-	 * rate can be calculated by the caller function */
-	stats[0] = num_faults;
-	stats[1] = num_refs;
+static void cflru_access_batch(struct engine *engine, page_t pages[], int count) {
+	struct cflru_engine *e = (struct cflru_engine *) engine;
+	int i;
+	for (i = 0; i < count; i++)
+		cflru_step(e, pages[i], 0);
+}
 
+static void cflru_destroy(struct engine *engine) {
+	struct cflru_engine *e = (struct cflru_engine *) engine;
+	pagemap_destroy(&e->index);
+	free(e->list.newer);
+	free(e->list.older);
+	free(e->dirty);
+	engine_free(engine);
+	free(e);
 }
 
+const struct policy cflru_policy = {
+	"cflru", "CFLRU", MAX_FAST_MEMORY_FRAMES, 1, 0, 1, NULL,
+	cflru_init, cflru_access, cflru_access_batch, engine_stats, cflru_destroy
+};
+
 /*
  * An extra page replacement algorithm implementation, known as the optimal page
  * replacement algorithm. Please note, this is not a realistic algorithm for OSs
@@ -302,83 +629,338 @@ void lru(int arr[], int arr_size, int frame_num, int stats[], int verbose) {
  * the one that has a page reference the farthest away in the future. If there are multiple
  * frames that don't have a reference in the future, the optimal is the first frame that
  * has this property.
- * 
+ *
+ * On top of the state every engine shares, it keeps:
+ *	- index: page -> frame slot index of the resident pages
+ *	- arr/arr_size: the whole reference string, to read ahead in
+ *	- count: int to keep the current count of the page we're on
+ *	- small: the fixed-width version that runs instead, for few enough frames
+ *			 (see smallframe.c), or NULL
+ */
+struct extra_engine {
+	struct engine base;
+	struct pagemap index;
+	page_t *arr;
+	int arr_size;
+	int count;
+	struct small_frames *small;
+};
+
+static void extra_destroy(struct engine *engine);
+
+/*
+ * Function to set up an optimal policy engine with empty frames.
  *		:param arr: an array of pages to be allocated
  *		:param arr_size: the number of pages to be allocated
- *		:param frame_nun: the number of frames in physical memory
- *		:param stats: an array which will eventually store the number of page faults
- *					  for this run of the algorithm (at index 0), and the number of
- *					  references (at index 1). These are then used in by the caller
- *					  to calculate the miss rate
- *		:param verbose: "boolean" to indicate whether to run in verbose mode or not;
- *						if so, then each allocation process is displayed.
+ *		:param frame_num: the number of frames in physical memory
+ * **Returns**: the engine, or NULL if memory could not be allocated
  */
-void extra(int arr[], int arr_size, int frame_num, int stats[], int verbose) {
-
-	/* initialize frame array to -1's */
-	int frames[frame_num], i;
-	for (i = 0; i < frame_num; i++) {
-		frames[i] = -1;
+static struct engine * extra_init(page_t arr[], int arr_size, int frame_num) {
+	struct extra_engine *e = calloc(1, sizeof(struct extra_engine));
+	if (!e)
+		return NULL;
+	if (engine_init(&e->base, frame_num) != 0) {
+		extra_destroy(&e->base);
+		return NULL;
 	}
-
-	/* initialize local variables: 
-	 *	- res: stores the result of whether or not the page is already in memory
-	 *	- num_faults: stores the current number of page faults that have occured
-	 *	- num_refs: stores the current number of page references that have occured
-	 * 	- faulted: temp boolean value to determine if the current page resulted in
-	 *			   a fault or not
-	 *	- is_filled: boolean value to determine if the frames are filled
-	 *	- count: int to keep the current count of the page we're on
-	 *	- num_allocated: stores the current number of pages allocated into a frame
-	 */
-	int res, faulted = 0, is_filled = 0, count = 0;
-	int num_faults = 0, num_refs = 0, num_allocated = 0;
-
-	/* for each page in arr...follow optimal replacement policy */
-	for (i = 0; i < arr_size; i++) {
-
-		/* see if page is already in frames */
-		res = search(frames, frame_num, arr[i]);
-		faulted = 0;
-		count++;
-
-		/* if the frame is full, count towards references */
-		if (is_filled || num_allocated >= frame_num) {
-			is_filled = 1;
-			num_refs++;
+	e->arr = arr;
+	e->arr_size = arr_size;
+	e->count = 0;
+
+	/* few enough frames for the fixed-width version */
+	if (frame_num >= 1 && frame_num <= SMALL_MAX_FRAMES) {
+		if (!(e->small = small_frames_new(frame_num, arr, arr_size, 1))) {
+			extra_destroy(&e->base);
+			return NULL;
 		}
+		return &e->base;
+	}
 
-		/* is page is not in frame, replacement is needed */
-		if (res == -1) {
+	if (pagemap_init(&e->index, frame_num, page_span(arr, arr_size)) != 0) {
+		extra_destroy(&e->base);
+		return NULL;
+	}
+	return &e->base;
+}
 
+/*
+ * Function to handle the next reference under the optimal policy.
+ *		:param e: the engine
+ *		:param page: the page referenced (the next one in the engine's reference string)
+ * **Returns**: 1 if the page faulted, 0 otherwise
+ */
+static int extra_step(struct extra_engine *e, page_t page) {
+	page_t *frames = e->base.frames;
+	int frame_num = e->base.frame_num, faulted = 0;
+	e->count++;
+
+	/* is page is not in frame, replacement is needed */
+	if (pagemap_get(&e->index, page) == -1) {
+		faulted = 1;
+		if (frame_num > 0) {
 			/* if the frames aren't filled, don't look for optimal, just
 			 *  put it in the next free space */
-			int index;
-			if (!is_filled) 
-				index = num_allocated;
+			int victim;
+			if (e->base.num_allocated < frame_num) 
+				victim = e->base.num_allocated;
 			else
-				index = find_opt(arr, arr_size, frames, frame_num, count);
+				victim = find_opt(e->arr, e->arr_size, frames, frame_num, e->count);
 
 			/* replace optimal element w/ page */
-			frames[index] = arr[i];
-
-			/* increment number allocated, and set faulted to true */
-			num_allocated++;
-			faulted = 1;
+			if (frames[victim] != PAGE_NONE)
+				pagemap_remove(&e->index, frames[victim]);
+			frames[victim] = page;
+			pagemap_put(&e->index, page, victim);
+			e->base.slot = victim;
 		}
+	}
+
+	engine_count(&e->base, faulted);
+	return faulted;
+}
+
+/* the optimal policy's access, batch access and destroy entry points (see struct policy) */
+static int extra_access(struct engine *engine, page_t page) {
+	struct extra_engine *e = (struct extra_engine *) engine;
+	if (e->small)
+		return small_access(engine, e->small, page);
+	return extra_step(e, page);
+}
+
+static void extra_access_batch(struct engine *engine, page_t pages[], int count) {
+	struct extra_engine *e = (struct extra_engine *) engine;
+	int i;
+	if (e->small) {
+		small_batch(engine, e->small, pages, count);
+		return;
+	}
+	for (i = 0; i < count; i++)
+		extra_step(e, pages[i]);
+}
 
-		/* if the frame is full, and the page wasn't in frame then count towards faults*/
-		if (is_filled && faulted) {
-			num_faults++;
+static void extra_destroy(struct engine *engine) {
+	struct extra_engine *e = (struct extra_engine *) engine;
+	if (e->small)
+		small_frames_free(e->small);
+	else
+		pagemap_destroy(&e->index);
+	engine_free(engine);
+	free(e);
+}
+
+const struct policy extra_policy = {
+	"extra", "EXTRA", MAX_MEMORY_FRAMES, 2, 1, 0, opt_stack_profile,
+	extra_init, extra_access, extra_access_batch, engine_stats, extra_destroy
+};
+
+/*
+ * Function to compute, for every reference, when the same page is referenced
+ * next. This is a single backward pass over the pages with a hash index holding
+ * the closest later position of each page seen so far.
+ *		:param arr: an array of pages to be allocated
+ *		:param arr_size: the number of pages to be allocated
+ * **Returns**: a malloc'd array where index i holds the position of the next
+ * reference to arr[i], or INT_MAX if it's never referenced again (NULL if memory
+ * could not be allocated). The caller is responsible for freeing it.
+ */
+int * next_use(page_t arr[], int arr_size) {
+	int *next = malloc((arr_size > 0 ? arr_size : 1) * sizeof(int));
+	struct pagemap later;
+	if (!next || pagemap_init(&later, 1024, page_span(arr, arr_size)) != 0) {
+		free(next);
+		return NULL;
+	}
+
+	int i;
+	for (i = arr_size - 1; i >= 0; i--) {
+		int pos = pagemap_get(&later, arr[i]);
+		next[i] = (pos == -1) ? INT_MAX : pos;
+		if (pagemap_put(&later, arr[i], i) != 0) {
+			free(next);
+			next = NULL;
+			break;
 		}
+	}
 
-		/* only print current operation if verbose mode is on */
-		if (verbose)
-			display(frames, frame_num, arr[i], (faulted && is_filled));
+	pagemap_destroy(&later);
+	return next;
+}
+
+/*
+ * Function to compare two frame slots in the optimal policy's victim heap.
+ *		:param when: next use of the page held by each slot
+ *		:param a: first slot
+ *		:param b: second slot
+ * **Returns**: nonzero if slot a is a better victim than slot b, i.e., its page is
+ * used farther in the future, or neither page is used again and a is the earlier
+ * frame (the same tie-break as find_opt).
+ */
+int opt_before(int when[], int a, int b) {
+	if (when[a] != when[b])
+		return when[a] > when[b];
+	return a < b;
+}
+
+/*
+ * Function to restore the heap order around one entry of the optimal policy's
+ * victim heap after that entry's next use changed.
+ *		:param heap: slots in heap order (heap[0] is the best victim)
+ *		:param pos: position of each slot within heap
+ *		:param size: number of slots in the heap
+ *		:param when: next use of the page held by each slot
+ *		:param at: the heap position whose key changed
+ */
+void opt_fix(int heap[], int pos[], int size, int when[], int at) {
+
+	/* move up while better than the parent */
+	while (at > 0 && opt_before(when, heap[at], heap[(at - 1) / 2])) {
+		int parent = (at - 1) / 2, tmp = heap[at];
+		heap[at] = heap[parent];
+		heap[parent] = tmp;
+		pos[heap[at]] = at;
+		pos[heap[parent]] = parent;
+		at = parent;
+	}
+
+	/* move down while a child is better */
+	for (;;) {
+		int best = at, child = 2 * at + 1;
+		if (child < size && opt_before(when, heap[child], heap[best]))
+			best = child;
+		if (child + 1 < size && opt_before(when, heap[child + 1], heap[best]))
+			best = child + 1;
+		if (best == at)
+			break;
+
+		int tmp = heap[at];
+		heap[at] = heap[best];
+		heap[best] = tmp;
+		pos[heap[at]] = at;
+		pos[heap[best]] = best;
+		at = best;
 	}
+}
+
+/*
+ * The optimal page replacement algorithm (see extra) in O(n log frames) time. The
+ * next use of every reference is computed up front, and the frames sit in a max-heap
+ * keyed on when their page is next used, so the victim is always at the top instead
+ * of being found by reading ahead through the rest of the pages once per frame. It
+ * produces exactly the same faults, references, and frame layout as extra. On top
+ * of the state every engine shares, it keeps:
+ *	- next: position of the next reference to the page at each position
+ *	- at: position of the reference being handled
+ *	- when: next use of the page held by each slot
+ *	- heap/pos: victim heap over the allocated slots, and each slot's position in it
+ *	- index: page -> frame slot index of the resident pages
+ */
+struct extra_fast_engine {
+	struct engine base;
+	int *next;
+	int at;
+	int *when;
+	int *heap;
+	int *pos;
+	struct pagemap index;
+};
+
+static void extra_fast_destroy(struct engine *engine);
+
+/*
+ * Function to set up a fast optimal policy engine with empty frames.
+ *		:param arr: an array of pages to be allocated
+ *		:param arr_size: the number of pages to be allocated
+ *		:param frame_num: the number of frames in physical memory
+ * **Returns**: the engine, or NULL if memory could not be allocated
+ */
+static struct engine * extra_fast_init(page_t arr[], int arr_size, int frame_num) {
+	struct extra_fast_engine *e = calloc(1, sizeof(struct extra_fast_engine));
+	if (!e)
+		return NULL;
+	if (engine_init(&e->base, frame_num) != 0 || !(e->next = next_use(arr, arr_size)) ||
+		!(e->when = malloc((frame_num + 1) * sizeof(int))) ||
+		!(e->heap = malloc((frame_num + 1) * sizeof(int))) ||
+		!(e->pos = malloc((frame_num + 1) * sizeof(int))) ||
+		pagemap_init(&e->index, frame_num, page_span(arr, arr_size)) != 0) {
+		extra_fast_destroy(&e->base);
+		return NULL;
+	}
+	e->at = 0;
+	return &e->base;
+}
+
+/*
+ * Function to handle the next reference under the fast optimal policy.
+ *		:param e: the engine
+ *		:param page: the page referenced (the next one in the engine's reference string)
+ * **Returns**: 1 if the page faulted, 0 otherwise
+ */
+static int extra_fast_step(struct extra_fast_engine *e, page_t page) {
+	int frame_num = e->base.frame_num, num_allocated = e->base.num_allocated;
+	int next = e->next[e->at++], faulted = 0;
+
+	/* see if page is already in frames */
+	int res = pagemap_get(&e->index, page);
+
+	if (res != -1) {
+		/* in frame, so it's now next needed at its following reference */
+		e->when[res] = next;
+		opt_fix(e->heap, e->pos, (num_allocated < frame_num) ? num_allocated : frame_num,
+				e->when, e->pos[res]);
+	}
+	else {
+		/* if the frames aren't filled, just put it in the next free space;
+		 * otherwise replace the page at the top of the heap */
+		if (num_allocated < frame_num) {
+			res = num_allocated;
+			e->heap[res] = res;
+			e->pos[res] = res;
+			e->when[res] = next;
+			e->base.frames[res] = page;
+			pagemap_put(&e->index, page, res);
+			e->base.slot = res;
+			opt_fix(e->heap, e->pos, num_allocated + 1, e->when, res);
+		}
+		else if (frame_num > 0) {
+			res = e->heap[0];
+			pagemap_remove(&e->index, e->base.frames[res]);
+			e->when[res] = next;
+			e->base.frames[res] = page;
+			pagemap_put(&e->index, page, res);
+			e->base.slot = res;
+			opt_fix(e->heap, e->pos, frame_num, e->when, 0);
+		}
+		faulted = 1;
+	}
+
+	engine_count(&e->base, faulted);
+	return faulted;
+}
+
+/* the fast optimal policy's access, batch access and destroy entry points (see struct policy) */
+static int extra_fast_access(struct engine *engine, page_t page) {
+	return extra_fast_step((struct extra_fast_engine *) engine, page);
+}
+
+static void extra_fast_access_batch(struct engine *engine, page_t pages[], int count) {
+	struct extra_fast_engine *e = (struct extra_fast_engine *) engine;
+	int i;
+	for (i = 0; i < count; i++)
+		extra_fast_step(e, pages[i]);
+}
+
+static void extra_fast_destroy(struct engine *engine) {
+	struct extra_fast_engine *e = (struct extra_fast_engine *) engine;
+	pagemap_destroy(&e->index);
+	free(e->next);
+	free(e->when);
+	free(e->heap);
+	free(e->pos);
+	engine_free(engine);
+	free(e);
+}
 
-	/* set number of faults and references to 'return' array so miss
-	 * rate can be calculated by the caller function */
-	stats[0] = num_faults;
-	stats[1] = num_refs;
-}
\ No newline at end of file
+const struct policy fastextra_policy = {
+	"fastextra", "FASTEXTRA", MAX_FAST_MEMORY_FRAMES, 0, 1, 0, opt_stack_profile,
+	extra_fast_init, extra_fast_access, extra_fast_access_batch, engine_stats, extra_fast_destroy
+};
\ No newline at end of file
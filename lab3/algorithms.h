@@ -1,3 +1,12 @@
-void fifo(int arr[], int arr_size, int frame_num, int stats[], int verbose);
-void lru(int arr[], int arr_size, int frame_num, int stats[], int verbose);
-void extra(int arr[], int arr_size, int frame_num, int stats[], int verbose);
\ No newline at end of file
+#include "page.h"
+#include "policy.h"
+
+extern const struct policy fifo_policy;
+extern const struct policy lru_policy;
+extern const struct policy fastlru_policy;
+extern const struct policy extra_policy;
+extern const struct policy fastextra_policy;
+extern const struct policy cflru_policy;
+
+int * next_use(page_t arr[], int arr_size);
+page_t page_span(page_t arr[], int arr_size);
\ No newline at end of file
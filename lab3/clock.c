@@ -0,0 +1,769 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "algorithms.h"
+#include "clock.h"
+#include "nodepool.h"
+
+#define GCLOCK_MAX 4	/* highest a GCLOCK reference counter goes */
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * clock contains the CLOCK family of page replacement algorithms, the LRU
+ * approximations real kernels use. Instead of keeping exact recency, each frame
+ * has a reference bit that is set whenever its page is used, and a hand sweeps
+ * around the frames looking for a victim.
+ *
+ * - clock: the hand clears each set bit it passes (a second chance), and evicts
+ *   the first frame whose bit is already clear.
+ * - gclock: generalized CLOCK. Each frame has a counter (1 when loaded, plus one per
+ *   hit, up to GCLOCK_MAX) that the hand decrements as it passes; the first frame at
+ *   zero is evicted, so frequently used pages survive several sweeps.
+ * - wsclock: working set CLOCK. The hand also records when it last saw each page
+ *   referenced, and evicts the first unreferenced page that has gone unused for
+ *   longer than the working set window tau (half as many references as there are
+ *   frames, so a turn usually finds one soon). An old page that is dirty isn't
+ *   evicted: its write-back is scheduled (the page is clean from then on) and the
+ *   hand moves on, so clean victims are preferred. If a whole turn finds no old
+ *   clean page, the first page it scheduled goes (its write has finished by then),
+ *   or if there was none, the oldest page it passed.
+ * - clockpro: CLOCK-Pro (Jiang, Chen & Zhang, 2005). Pages are hot or cold; a new
+ *   page is cold and in a test period, and becomes hot if it is referenced again
+ *   before the period ends, even after being evicted (it is then remembered as a
+ *   non-resident cold page, at most as many of them as there are frames). Three
+ *   hands demote hot pages, evict cold ones, and end test periods, and the number
+ *   of frames set aside for cold pages adapts to how often test periods succeed.
+ *
+ * The reference and dirty bits of clock, gclock and wsclock are packed 64 to a word
+ * (a page is dirty if it was written, engine->writing, since it was loaded or last
+ * written back; only wsclock acts on it), and the hand moves a word at a time: the
+ * next victim candidate in a word is found with a count-trailing-zeros, and every
+ * frame passed on the way has its bit cleared with one mask, so a sweep costs
+ * O(frames / 64) instead of O(frames) (gclock and wsclock still touch each passed
+ * frame's counter or time, but only those whose bit is set). clockpro's pages sit on
+ * one circular list with non-resident pages among them, so its hands step a page at
+ * a time; its reference bits are packed all the same.
+ *
+ * Usage:
+ *   Compile with another file; there is no main function
+ */
+
+//======================================================//
+
+/*
+ * Function to compute how many 64-bit words a bitmap of some number of bits needs.
+ *		:param bits: the number of bits
+ * **Returns**: the number of words (at least one)
+ */
+static int bitmap_words(int bits) {
+	return bits / 64 + 1;
+}
+
+/*
+ * Function to set a bit of a bitmap.
+ *		:param map: the bitmap
+ *		:param bit: the bit to set
+ */
+static void bit_set(uint64_t *map, int bit) {
+	map[bit >> 6] |= 1ULL << (bit & 63);
+}
+
+/*
+ * Function to clear a bit of a bitmap.
+ *		:param map: the bitmap
+ *		:param bit: the bit to clear
+ */
+static void bit_clear(uint64_t *map, int bit) {
+	map[bit >> 6] &= ~(1ULL << (bit & 63));
+}
+
+/*
+ * Function to read a bit of a bitmap.
+ *		:param map: the bitmap
+ *		:param bit: the bit to read
+ * **Returns**: nonzero if the bit is set
+ */
+static int bit_test(uint64_t *map, int bit) {
+	return (map[bit >> 6] >> (bit & 63)) & 1;
+}
+
+/*
+ * Function to build a mask of a range of bits within one word.
+ *		:param lo: the first bit in the range
+ *		:param hi: one past the last bit in the range (lo <= hi <= 64)
+ * **Returns**: a word with bits lo to hi - 1 set
+ */
+static uint64_t word_mask(int lo, int hi) {
+	uint64_t below_hi = (hi == 64) ? ~0ULL : (1ULL << hi) - 1;
+	return (lo == 64) ? 0 : below_hi & (~0ULL << lo);
+}
+
+//======================================================//
+
+/* the frame-based clocks (clock, gclock and wsclock): frames in a circle, each with
+ * a reference bit (for gclock, whether its counter is above zero) */
+struct clock_engine {
+	struct engine base;
+	struct pagemap index;	/* page -> frame slot of the resident pages */
+	uint64_t *ref;			/* reference bit of each frame */
+	uint64_t *dirty;		/* dirty bit of each frame */
+	int hand;				/* the frame the hand looks at next */
+	unsigned char *count;	/* gclock: reference counter of each frame (else NULL) */
+	int *last_use;			/* wsclock: time its page was last seen referenced (else NULL) */
+	int now;				/* wsclock: references so far (the virtual time) */
+	int tau;				/* wsclock: the working set window */
+};
+
+static void clock_destroy(struct engine *engine);
+
+/*
+ * Function to set up a frame-based clock engine with empty frames.
+ *		:param arr: an array of pages to be allocated
+ *		:param arr_size: the number of pages to be allocated
+ *		:param frame_num: the number of frames in physical memory
+ *		:param counters: "boolean"; the engine needs a counter per frame (gclock)
+ *		:param times: "boolean"; the engine needs a last use time per frame (wsclock)
+ * **Returns**: the engine, or NULL if memory could not be allocated
+ */
+static struct clock_engine * clock_new(page_t arr[], int arr_size, int frame_num,
+									   int counters, int times) {
+	struct clock_engine *e = calloc(1, sizeof(struct clock_engine));
+	if (!e)
+		return NULL;
+	if (engine_init(&e->base, frame_num) != 0 ||
+		!(e->ref = calloc(bitmap_words(frame_num), sizeof(uint64_t))) ||
+		!(e->dirty = calloc(bitmap_words(frame_num), sizeof(uint64_t))) ||
+		pagemap_init(&e->index, frame_num, page_span(arr, arr_size)) != 0 ||
+		(counters && !(e->count = calloc(frame_num + 1, sizeof(unsigned char)))) ||
+		(times && !(e->last_use = calloc(frame_num + 1, sizeof(int)))) ||
+		(times && !(e->base.cleaned = malloc((frame_num + 1) * sizeof(int))))) {
+		clock_destroy(&e->base);
+		return NULL;
+	}
+	e->hand = 0;
+	e->now = 0;
+	e->tau = frame_num / 2;
+	return e;
+}
+
+/*
+ * Function to find a frame for a page that faulted: a free frame if there is one,
+ * else the victim the engine's sweep picks (whose page leaves the index).
+ *		:param e: the engine
+ *		:param sweep: the engine's sweep
+ * **Returns**: the frame slot
+ */
+static int clock_frame(struct clock_engine *e, int (*sweep)(struct clock_engine *)) {
+	int slot;
+	if (e->base.num_allocated < e->base.frame_num)
+		return e->base.num_allocated;
+	slot = sweep(e);
+	pagemap_remove(&e->index, e->base.frames[slot]);
+	return slot;
+}
+
+/*
+ * Function to load a page into a frame (dirty if the reference writes it).
+ *		:param e: the engine
+ *		:param slot: the frame slot
+ *		:param page: the page
+ */
+static void clock_load(struct clock_engine *e, int slot, page_t page) {
+	e->base.frames[slot] = page;
+	e->base.slot = slot;
+	pagemap_put(&e->index, page, slot);
+	bit_set(e->ref, slot);
+	if (e->base.writing)
+		bit_set(e->dirty, slot);
+	else
+		bit_clear(e->dirty, slot);
+}
+
+/*
+ * Function to note a hit on a frame: its reference bit, and its dirty bit if the
+ * reference writes the page.
+ *		:param e: the engine
+ *		:param slot: the frame slot
+ */
+static void clock_hit(struct clock_engine *e, int slot) {
+	bit_set(e->ref, slot);
+	if (e->base.writing)
+		bit_set(e->dirty, slot);
+}
+
+/*
+ * Function to sweep the hand to CLOCK's next victim: the first frame from the hand
+ * on whose reference bit is clear. Set bits passed on the way are cleared.
+ *		:param e: the engine (with at least one frame)
+ * **Returns**: the victim's frame slot
+ */
+static int clock_sweep(struct clock_engine *e) {
+	int n = e->base.frame_num, at = e->hand;
+	for (;;) {
+		int w = at >> 6, lo = at & 63;
+		int hi = (n - (w << 6) < 64) ? n - (w << 6) : 64;
+		uint64_t mask = word_mask(lo, hi), clear = ~e->ref[w] & mask;
+
+		if (clear) {
+			int victim = (w << 6) + __builtin_ctzll(clear);
+			e->ref[w] &= ~word_mask(lo, victim & 63);
+			e->hand = (victim + 1 < n) ? victim + 1 : 0;
+			return victim;
+		}
+
+		/* every frame left in this word gets its second chance */
+		e->ref[w] &= ~mask;
+		at = (w << 6) + hi;
+		if (at >= n)
+			at = 0;
+	}
+}
+
+/*
+ * Function to sweep the hand to GCLOCK's next victim: the first frame from the hand
+ * on whose counter is zero. Counters passed on the way are decremented.
+ *		:param e: the engine (with at least one frame)
+ * **Returns**: the victim's frame slot
+ */
+static int gclock_sweep(struct clock_engine *e) {
+	int n = e->base.frame_num, at = e->hand, victim = -1;
+	while (victim == -1) {
+		int w = at >> 6, lo = at & 63;
+		int hi = (n - (w << 6) < 64) ? n - (w << 6) : 64;
+		uint64_t mask = word_mask(lo, hi), zero = ~e->ref[w] & mask, passed;
+
+		if (zero) {
+			victim = (w << 6) + __builtin_ctzll(zero);
+			passed = e->ref[w] & word_mask(lo, victim & 63);
+		}
+		else {
+			passed = e->ref[w] & mask;
+		}
+
+		/* decrement every counter passed (all of them above zero) */
+		while (passed) {
+			int bit = __builtin_ctzll(passed);
+			if (--e->count[(w << 6) + bit] == 0)
+				e->ref[w] &= ~(1ULL << bit);
+			passed &= passed - 1;
+		}
+
+		at = (w << 6) + hi;
+		if (at >= n)
+			at = 0;
+	}
+	e->hand = (victim + 1 < n) ? victim + 1 : 0;
+	return victim;
+}
+
+/*
+ * Function to sweep the hand to WSClock's next victim: the first frame from the hand
+ * on whose page is unreferenced, clean, and older than the working set window.
+ * Referenced frames passed on the way have their bit cleared and their time set to
+ * now; old dirty ones are written back (reported in engine->cleaned) and left
+ * clean. If a whole turn finds no victim, the first page written back is the
+ * victim, else the oldest unreferenced page passed (or, if there was none, the
+ * frame the hand started at).
+ *		:param e: the engine (with at least one frame)
+ * **Returns**: the victim's frame slot
+ */
+static int wsclock_sweep(struct clock_engine *e) {
+	int n = e->base.frame_num, start = e->hand, victim = -1, oldest = -1, scheduled = -1;
+	int seg_lo[2] = { start, 0 }, seg_hi[2] = { n, start }, seg;
+
+	/* one turn: from the hand to the last frame, then from the first to the hand */
+	for (seg = 0; seg < 2 && victim == -1; seg++) {
+		int at = seg_lo[seg];
+		while (at < seg_hi[seg] && victim == -1) {
+			int w = at >> 6, lo = at & 63;
+			int hi = (seg_hi[seg] - (w << 6) < 64) ? seg_hi[seg] - (w << 6) : 64;
+			uint64_t mask = word_mask(lo, hi), unref = ~e->ref[w] & mask, clean, dirty, passed;
+
+			clean = unref & ~e->dirty[w];
+			while (clean) {
+				int slot = (w << 6) + __builtin_ctzll(clean);
+				if (e->now - e->last_use[slot] > e->tau) {
+					victim = slot;
+					break;
+				}
+				if (oldest == -1 || e->last_use[slot] < e->last_use[oldest])
+					oldest = slot;
+				clean &= clean - 1;
+			}
+
+			/* old dirty pages passed on the way are written back, and stay */
+			dirty = unref & e->dirty[w] & ((victim == -1) ? mask : word_mask(lo, victim & 63));
+			while (dirty) {
+				int bit = __builtin_ctzll(dirty), slot = (w << 6) + bit;
+				if (e->now - e->last_use[slot] > e->tau) {
+					e->dirty[w] &= ~(1ULL << bit);
+					e->base.cleaned[e->base.num_cleaned++] = slot;
+					if (scheduled == -1)
+						scheduled = slot;
+				}
+				else if (oldest == -1 || e->last_use[slot] < e->last_use[oldest]) {
+					oldest = slot;
+				}
+				dirty &= dirty - 1;
+			}
+
+			/* referenced pages passed are in the working set as of now */
+			passed = e->ref[w] & ((victim == -1) ? mask : word_mask(lo, victim & 63));
+			e->ref[w] &= ~passed;
+			while (passed) {
+				e->last_use[(w << 6) + __builtin_ctzll(passed)] = e->now;
+				passed &= passed - 1;
+			}
+			at = (w << 6) + hi;
+		}
+	}
+
+	if (victim == -1 && scheduled != -1)
+		victim = scheduled;
+	else if (victim == -1)
+		victim = (oldest != -1) ? oldest : start;
+	e->hand = (victim + 1 < n) ? victim + 1 : 0;
+	return victim;
+}
+
+/*
+ * Function to handle one reference under CLOCK.
+ *		:param e: the engine
+ *		:param page: the page referenced
+ * **Returns**: 1 if the page faulted, 0 otherwise
+ */
+static int clock_step(struct clock_engine *e, page_t page) {
+	int slot = pagemap_get(&e->index, page), faulted = 0;
+	if (slot != -1) {
+		clock_hit(e, slot);
+	}
+	else {
+		faulted = 1;
+		if (e->base.frame_num > 0)
+			clock_load(e, clock_frame(e, clock_sweep), page);
+	}
+	engine_count(&e->base, faulted);
+	return faulted;
+}
+
+/*
+ * Function to handle one reference under GCLOCK.
+ *		:param e: the engine
+ *		:param page: the page referenced
+ * **Returns**: 1 if the page faulted, 0 otherwise
+ */
+static int gclock_step(struct clock_engine *e, page_t page) {
+	int slot = pagemap_get(&e->index, page), faulted = 0;
+	if (slot != -1) {
+		if (e->count[slot] < GCLOCK_MAX)
+			e->count[slot]++;
+		clock_hit(e, slot);
+	}
+	else {
+		faulted = 1;
+		if (e->base.frame_num > 0) {
+			slot = clock_frame(e, gclock_sweep);
+			e->count[slot] = 1;
+			clock_load(e, slot, page);
+		}
+	}
+	engine_count(&e->base, faulted);
+	return faulted;
+}
+
+/*
+ * Function to handle one reference under WSClock.
+ *		:param e: the engine
+ *		:param page: the page referenced
+ * **Returns**: 1 if the page faulted, 0 otherwise
+ */
+static int wsclock_step(struct clock_engine *e, page_t page) {
+	int slot = pagemap_get(&e->index, page), faulted = 0;
+	e->now++;
+	e->base.num_cleaned = 0;
+	if (slot != -1) {
+		clock_hit(e, slot);
+	}
+	else {
+		faulted = 1;
+		if (e->base.frame_num > 0) {
+			/* its use is recorded as its time, so it needs no reference bit too */
+			slot = clock_frame(e, wsclock_sweep);
+			e->last_use[slot] = e->now;
+			clock_load(e, slot, page);
+			bit_clear(e->ref, slot);
+		}
+	}
+	engine_count(&e->base, faulted);
+	return faulted;
+}
+
+/* the frame-based clocks' init, access, batch access (all reads) and destroy entry
+ * points (see struct policy) */
+static struct engine * clock_init(page_t arr[], int arr_size, int frame_num) {
+	struct clock_engine *e = clock_new(arr, arr_size, frame_num, 0, 0);
+	return e ? &e->base : NULL;
+}
+
+static struct engine * gclock_init(page_t arr[], int arr_size, int frame_num) {
+	struct clock_engine *e = clock_new(arr, arr_size, frame_num, 1, 0);
+	return e ? &e->base : NULL;
+}
+
+static struct engine * wsclock_init(page_t arr[], int arr_size, int frame_num) {
+	struct clock_engine *e = clock_new(arr, arr_size, frame_num, 0, 1);
+	return e ? &e->base : NULL;
+}
+
+static int clock_access(struct engine *engine, page_t page) {
+	return clock_step((struct clock_engine *) engine, page);
+}
+
+static int gclock_access(struct engine *engine, page_t page) {
+	return gclock_step((struct clock_engine *) engine, page);
+}
+
+static int wsclock_access(struct engine *engine, page_t page) {
+	return wsclock_step((struct clock_engine *) engine, page);
+}
+
+static void clock_access_batch(struct engine *engine, page_t pages[], int count) {
+	struct clock_engine *e = (struct clock_engine *) engine;
+	int i;
+	engine->writing = 0;
+	for (i = 0; i < count; i++)
+		clock_step(e, pages[i]);
+}
+
+static void gclock_access_batch(struct engine *engine, page_t pages[], int count) {
+	struct clock_engine *e = (struct clock_engine *) engine;
+	int i;
+	engine->writing = 0;
+	for (i = 0; i < count; i++)
+		gclock_step(e, pages[i]);
+}
+
+static void wsclock_access_batch(struct engine *engine, page_t pages[], int count) {
+	struct clock_engine *e = (struct clock_engine *) engine;
+	int i;
+	engine->writing = 0;
+	for (i = 0; i < count; i++)
+		wsclock_step(e, pages[i]);
+}
+
+static void clock_destroy(struct engine *engine) {
+	struct clock_engine *e = (struct clock_engine *) engine;
+	pagemap_destroy(&e->index);
+	free(e->ref);
+	free(e->dirty);
+	free(e->count);
+	free(e->last_use);
+	engine_free(engine);
+	free(e);
+}
+
+const struct policy clock_policy = {
+	"clock", "CLOCK", MAX_FAST_MEMORY_FRAMES, 0, 0, 0, NULL,
+	clock_init, clock_access, clock_access_batch, engine_stats, clock_destroy
+};
+
+const struct policy gclock_policy = {
+	"gclock", "GCLOCK", MAX_FAST_MEMORY_FRAMES, 0, 0, 0, NULL,
+	gclock_init, gclock_access, gclock_access_batch, engine_stats, clock_destroy
+};
+
+const struct policy wsclock_policy = {
+	"wsclock", "WSCLOCK", MAX_FAST_MEMORY_FRAMES, 0, 0, 1, NULL,
+	wsclock_init, wsclock_access, wsclock_access_batch, engine_stats, clock_destroy
+};
+
+//======================================================//
+
+#define CP_HOT 0	/* hot page (always resident) */
+#define CP_COLD 1	/* cold page, resident or not (a non-resident one is always in its test period) */
+
+/* CLOCK-Pro: the pages on one circular list (threaded through the pool's links,
+ * in the direction of next), the three hands, and the page counts */
+struct clockpro_engine {
+	struct engine base;
+	struct node_pool pool;	/* where is CP_HOT or CP_COLD; slot is -1 if not resident */
+	uint64_t *ref;			/* reference bit of each node */
+	char *test;				/* "boolean"; each cold node is in its test period */
+	int hand_hot;			/* demotes hot pages, and ends test periods on its way */
+	int hand_cold;			/* evicts resident cold pages */
+	int hand_test;			/* ends test periods, dropping non-resident pages */
+	int num_hot;			/* hot pages */
+	int num_cold;			/* resident cold pages */
+	int num_nonres;			/* non-resident cold pages */
+	int cold_target;		/* frames set aside for cold pages (the rest are for hot ones) */
+	int cold_max;			/* most frames cold_target may grow to */
+};
+
+static void clockpro_destroy(struct engine *engine);
+
+/*
+ * Function to set up a CLOCK-Pro engine with empty frames.
+ *		:param arr: an array of pages to be allocated
+ *		:param arr_size: the number of pages to be allocated
+ *		:param frame_num: the number of frames in physical memory
+ * **Returns**: the engine, or NULL if memory could not be allocated
+ */
+static struct engine * clockpro_init(page_t arr[], int arr_size, int frame_num) {
+	int pool_size = 2 * frame_num + 2;
+	struct clockpro_engine *e = (struct clockpro_engine *) pool_engine_new(
+		sizeof(struct clockpro_engine), offsetof(struct clockpro_engine, pool), pool_size,
+		arr, arr_size, frame_num);
+	if (!e)
+		return NULL;
+	e->ref = calloc(bitmap_words(pool_size), sizeof(uint64_t));
+	e->test = calloc(pool_size, sizeof(char));
+	if (!e->ref || !e->test) {
+		clockpro_destroy(&e->base);
+		return NULL;
+	}
+
+	e->hand_hot = e->hand_cold = e->hand_test = -1;
+	e->num_hot = e->num_cold = e->num_nonres = 0;
+	e->cold_max = (frame_num > 1) ? frame_num - 1 : 1;
+	e->cold_target = (frame_num / 2 > 1) ? frame_num / 2 : 1;
+	return &e->base;
+}
+
+/*
+ * Function to add a node to the circular list as its newest page: just behind the
+ * hot hand, so it is the last page that hand comes to.
+ *		:param e: the engine
+ *		:param node: the node (not on the list)
+ */
+static void cp_insert(struct clockpro_engine *e, int node) {
+	struct links *links = &e->pool.links;
+	if (e->hand_hot == -1) {
+		links->prev[node] = links->next[node] = node;
+		e->hand_hot = e->hand_cold = e->hand_test = node;
+		return;
+	}
+	links->next[node] = e->hand_hot;
+	links->prev[node] = links->prev[e->hand_hot];
+	links->next[links->prev[e->hand_hot]] = node;
+	links->prev[e->hand_hot] = node;
+}
+
+/*
+ * Function to take a node off the circular list, moving any hand on it to the
+ * next page.
+ *		:param e: the engine
+ *		:param node: the node (on the list)
+ */
+static void cp_unlink(struct clockpro_engine *e, int node) {
+	struct links *links = &e->pool.links;
+	int next = (links->next[node] != node) ? links->next[node] : -1;
+	if (e->hand_hot == node)
+		e->hand_hot = next;
+	if (e->hand_cold == node)
+		e->hand_cold = next;
+	if (e->hand_test == node)
+		e->hand_test = next;
+	links->next[links->prev[node]] = links->next[node];
+	links->prev[links->next[node]] = links->prev[node];
+}
+
+/*
+ * Function to end a cold page's test period without it being referenced again:
+ * the cold pages didn't need the frames they had, so they get one fewer. A
+ * non-resident page is forgotten.
+ *		:param e: the engine
+ *		:param node: the node of the page
+ * **Returns**: 1 if the page was non-resident (and is now gone), 0 otherwise
+ */
+static int cp_end_test(struct clockpro_engine *e, int node) {
+	e->test[node] = 0;
+	if (e->cold_target > 1)
+		e->cold_target--;
+	if (e->pool.slot[node] != -1)
+		return 0;
+	cp_unlink(e, node);
+	node_free(&e->pool, node);
+	e->num_nonres--;
+	return 1;
+}
+
+/*
+ * Function to run the hot hand until it demotes a hot page to cold, clearing the
+ * reference bits of hot pages it passes and ending the test periods of cold ones.
+ *		:param e: the engine (with at least one hot page)
+ */
+static void cp_hand_hot(struct clockpro_engine *e) {
+	for (;;) {
+		int node = e->hand_hot;
+		e->hand_hot = e->pool.links.next[node];
+
+		if (e->pool.where[node] == CP_HOT) {
+			if (!bit_test(e->ref, node)) {
+				e->pool.where[node] = CP_COLD;
+				e->num_hot--;
+				e->num_cold++;
+				return;
+			}
+			bit_clear(e->ref, node);
+		}
+		else if (e->test[node]) {
+			cp_end_test(e, node);
+		}
+	}
+}
+
+/*
+ * Function to run the test hand until it drops a non-resident page, ending the
+ * test periods of the cold pages it passes.
+ *		:param e: the engine (with at least one non-resident page)
+ */
+static void cp_hand_test(struct clockpro_engine *e) {
+	for (;;) {
+		int node = e->hand_test;
+		e->hand_test = e->pool.links.next[node];
+		if (e->pool.where[node] == CP_COLD && e->test[node] && cp_end_test(e, node))
+			return;
+	}
+}
+
+/*
+ * Function to make a page hot, and run the hot hand until the hot pages fit in
+ * the frames not set aside for cold ones.
+ *		:param e: the engine
+ *		:param node: the node of the page (resident, on the list)
+ */
+static void cp_make_hot(struct clockpro_engine *e, int node) {
+	e->pool.where[node] = CP_HOT;
+	e->test[node] = 0;
+	e->num_hot++;
+	while (e->num_hot > e->base.frame_num - e->cold_target)
+		cp_hand_hot(e);
+}
+
+/*
+ * Function to run the cold hand until it evicts a resident cold page. A cold page
+ * passed with its reference bit set is moved to the head of the list: it becomes
+ * hot if it was in its test period, else it starts one.
+ *		:param e: the engine (with every frame in use)
+ * **Returns**: the frame slot the evicted page was in
+ */
+static int cp_hand_cold(struct clockpro_engine *e) {
+	for (;;) {
+		if (e->num_cold == 0)
+			cp_hand_hot(e);
+
+		int node = e->hand_cold;
+		e->hand_cold = e->pool.links.next[node];
+		if (e->pool.where[node] != CP_COLD || e->pool.slot[node] == -1)
+			continue;
+
+		if (!bit_test(e->ref, node)) {
+			/* evict it; in its test period, it's remembered as non-resident */
+			int slot = unload_page(&e->pool, node);
+			e->num_cold--;
+			if (e->test[node]) {
+				e->num_nonres++;
+			}
+			else {
+				cp_unlink(e, node);
+				node_free(&e->pool, node);
+			}
+			return slot;
+		}
+
+		bit_clear(e->ref, node);
+		cp_unlink(e, node);
+		cp_insert(e, node);
+		if (e->test[node]) {
+			e->num_cold--;
+			cp_make_hot(e, node);
+		}
+		else {
+			e->test[node] = 1;
+		}
+	}
+}
+
+/*
+ * Function to handle one reference under CLOCK-Pro.
+ *		:param e: the engine
+ *		:param page: the page referenced
+ * **Returns**: 1 if the page faulted, 0 otherwise
+ */
+static int clockpro_step(struct clockpro_engine *e, page_t page) {
+	int node, slot;
+
+	if (e->base.frame_num == 0) {
+		engine_count(&e->base, 1);
+		return 1;
+	}
+
+	node = pagemap_get(&e->pool.index, page);
+	if (node != -1 && e->pool.slot[node] != -1) {
+		bit_set(e->ref, node);
+		engine_count(&e->base, 0);
+		return 0;
+	}
+
+	if (node != -1) {
+		/* referenced again during its test period, after being evicted: cold pages
+		 * need more frames. It comes back hot (off the list while room is made,
+		 * so no hand can drop it). */
+		if (e->cold_target < e->cold_max)
+			e->cold_target++;
+		cp_unlink(e, node);
+		e->num_nonres--;
+		slot = (e->base.num_allocated < e->base.frame_num) ? e->base.num_allocated : cp_hand_cold(e);
+		bit_clear(e->ref, node);
+		cp_insert(e, node);
+		load_page(&e->base, &e->pool, node, slot);
+		cp_make_hot(e, node);
+	}
+	else {
+		/* a new page starts cold, in its test period */
+		slot = (e->base.num_allocated < e->base.frame_num) ? e->base.num_allocated : cp_hand_cold(e);
+		node = node_new(&e->pool, page);
+		e->pool.where[node] = CP_COLD;
+		e->test[node] = 1;
+		bit_clear(e->ref, node);
+		e->num_cold++;
+		cp_insert(e, node);
+		load_page(&e->base, &e->pool, node, slot);
+	}
+
+	while (e->num_nonres > e->base.frame_num)
+		cp_hand_test(e);
+
+	engine_count(&e->base, 1);
+	return 1;
+}
+
+/* CLOCK-Pro's access, batch access and destroy entry points (see struct policy) */
+static int clockpro_access(struct engine *engine, page_t page) {
+	return clockpro_step((struct clockpro_engine *) engine, page);
+}
+
+static void clockpro_access_batch(struct engine *engine, page_t pages[], int count) {
+	struct clockpro_engine *e = (struct clockpro_engine *) engine;
+	int i;
+	for (i = 0; i < count; i++)
+		clockpro_step(e, pages[i]);
+}
+
+static void clockpro_destroy(struct engine *engine) {
+	struct clockpro_engine *e = (struct clockpro_engine *) engine;
+	pool_destroy(&e->pool);
+	free(e->ref);
+	free(e->test);
+	engine_free(engine);
+	free(e);
+}
+
+const struct policy clockpro_policy = {
+	"clockpro", "CLOCKPRO", MAX_FAST_MEMORY_FRAMES, 0, 0, 0, NULL,
+	clockpro_init, clockpro_access, clockpro_access_batch, engine_stats, clockpro_destroy
+};
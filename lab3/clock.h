@@ -0,0 +1,11 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include "policy.h"
+
+extern const struct policy clock_policy;
+extern const struct policy gclock_policy;
+extern const struct policy clockpro_policy;
+extern const struct policy wsclock_policy;
+
+#endif
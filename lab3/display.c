@@ -0,0 +1,325 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "display.h"
+#include "policy.h"
+#include "trace.h"
+
+#define DISPLAY_BUFFER_SIZE (1 << 16)	/* bytes of rows gathered before each write */
+#define DISPLAY_MAX_FIELD 24			/* longest piece of a row added at once */
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * display contains the verbose output of a simulation: one row per reference,
+ * showing the page referenced, what each frame holds afterwards, and whether the
+ * reference was a page fault, as in
+ *
+ *    7: [ 7| 0| 1] F
+ *
+ * Rather than one printf per frame, display formats each row by hand into one large
+ * buffer (small page numbers come from a table of two-digit strings) and writes the
+ * buffer to stdout with a single fwrite whenever it fills; display_flush writes
+ * whatever is left, and must be called before anything else is printed.
+ *
+ * The event log is a compact binary record of a simulation, which can be turned
+ * into the same rows later (see pagereplay.c) without running the policy again.
+ * All fields are little-endian:
+ *
+ *   offset  size  field
+ *        0     4  magic number "PGEV"
+ *        4     2  format version (1)
+ *        6     2  reserved (0)
+ *        8     4  number of frames
+ *       12     4  reserved (0)
+ *       16        the events, EVENT_SIZE bytes each
+ *
+ * and each event is the 8-byte page referenced, followed by the 4-byte (signed)
+ * frame slot it faulted into, EVENT_HIT if it was resident, or EVENT_NO_FRAME if it
+ * faulted with no frames to load it into. Since each fault records where the page
+ * went, replaying the events rebuilds the frames after every reference. An event
+ * whose page is PAGE_NONE is not a reference: it records that the slot was emptied
+ * (the working set engines shrink their resident sets), before the reference that
+ * emptied it.
+ *
+ * Usage:
+ *   Compile with another file; there is no main function
+ */
+
+//======================================================//
+
+/* the two-digit strings "00" to "99", one after another */
+static const char digit_pairs[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+static char out[DISPLAY_BUFFER_SIZE];	/* rows not yet written */
+static size_t out_len;					/* bytes in out */
+
+/*
+ * Function to format a page number right-aligned in at least two characters (as
+ * printf's "%2" does).
+ *		:param dst: where to write it (room for at least 20 characters)
+ *		:param page: the page number
+ * **Returns**: the number of characters written
+ */
+static int format_page(char *dst, page_t page) {
+	char digits[20];
+	int len = 0;
+
+	if (page < 10) {
+		dst[0] = ' ';
+		dst[1] = '0' + page;
+		return 2;
+	}
+
+	/* two digits at a time from the right, then the odd digit, if any */
+	while (page >= 100) {
+		int pair = (page % 100) * 2;
+		page /= 100;
+		digits[19 - len++] = digit_pairs[pair + 1];
+		digits[19 - len++] = digit_pairs[pair];
+	}
+	if (page >= 10) {
+		digits[19 - len++] = digit_pairs[page * 2 + 1];
+		digits[19 - len++] = digit_pairs[page * 2];
+	}
+	else {
+		digits[19 - len++] = '0' + page;
+	}
+	memcpy(dst, digits + 20 - len, len);
+	return len;
+}
+
+/*
+ * Function to make room for another piece of a row, writing out the buffer if it
+ * is nearly full.
+ */
+static void reserve(void) {
+	if (out_len + DISPLAY_MAX_FIELD > DISPLAY_BUFFER_SIZE)
+		display_flush();
+}
+
+/*
+ * Function to output the current status of the frames to stdout. The
+ * specifications of how the frames are displayed are given in the 
+ * assignment prompt. The row goes into the output buffer, which is written
+ * out as it fills (see display_flush).
+ *		:param frames: array containing the current pages in physical memory
+ *		:param num_frames: the number of frames allocated in physical memory
+ *		:param page: the current page that has to be allocated
+ *		:param faulted: "boolean" value which indicates if the page resulted
+ *						in a fault of not (used for printing F is so)
+ */
+void display(page_t frames[], int num_frames, page_t page, int faulted) {
+	int i;
+
+	/* the page, then each frame followed by | (two spaces if unallocated) */
+	reserve();
+	out_len += format_page(out + out_len, page);
+	memcpy(out + out_len, ": [", 3);
+	out_len += 3;
+
+	for (i = 0; i < num_frames - 1; i++) {
+		reserve();
+		if (frames[i] == PAGE_NONE) {
+			out[out_len++] = ' ';
+			out[out_len++] = ' ';
+		}
+		else {
+			out_len += format_page(out + out_len, frames[i]);
+		}
+		out[out_len++] = '|';
+	}
+
+	/* for the last element, don't include |; if the current operation was a
+	 * fault, print F after the frames */
+	reserve();
+	if (frames[i] == PAGE_NONE) {
+		out[out_len++] = ' ';
+		out[out_len++] = ' ';
+	}
+	else {
+		out_len += format_page(out + out_len, frames[i]);
+	}
+	if (faulted) {
+		memcpy(out + out_len, "] F\n", 4);
+		out_len += 4;
+	}
+	else {
+		memcpy(out + out_len, "]\n", 2);
+		out_len += 2;
+	}
+}
+
+/*
+ * Function to write out the rows display has buffered.
+ */
+void display_flush(void) {
+	if (out_len > 0)
+		fwrite(out, 1, out_len, stdout);
+	out_len = 0;
+}
+
+//======================================================//
+
+/*
+ * Function to store a number in little-endian byte order.
+ *		:param dst: where to store it
+ *		:param size: the number of bytes
+ *		:param value: the number
+ */
+static void put_le(unsigned char *dst, int size, page_t value) {
+	int i;
+	for (i = 0; i < size; i++)
+		dst[i] = (unsigned char) (value >> (8 * i));
+}
+
+/*
+ * Function to read a little-endian number.
+ *		:param src: where it is stored
+ *		:param size: the number of bytes
+ * **Returns**: the number
+ */
+static page_t get_le(const unsigned char *src, int size) {
+	page_t value = 0;
+	int i;
+	for (i = 0; i < size; i++)
+		value |= (page_t) src[i] << (8 * i);
+	return value;
+}
+
+/*
+ * Function to create an event log and write its header.
+ *		:param log: the log to set up
+ *		:param file_name: the name of the file to write
+ *		:param frame_num: the number of frames in the simulated memory
+ * **Returns**: 0, or TRACE_ERR_OPEN if the file can't be written, or
+ *				TRACE_ERR_MEMORY if memory runs out
+ */
+int event_log_open(struct event_log *log, const char *file_name, int frame_num) {
+	unsigned char header[EVENT_HEADER_SIZE] = { 0 };
+
+	log->frame_num = frame_num;
+	log->len = 0;
+	if (!(log->buf = malloc(DISPLAY_BUFFER_SIZE)))
+		return TRACE_ERR_MEMORY;
+	if (!(log->fp = fopen(file_name, "wb"))) {
+		free(log->buf);
+		return TRACE_ERR_OPEN;
+	}
+
+	memcpy(header, EVENT_MAGIC, 4);
+	put_le(header + 4, 2, EVENT_VERSION);
+	put_le(header + 8, 4, frame_num);
+	if (fwrite(header, 1, sizeof(header), log->fp) != sizeof(header)) {
+		fclose(log->fp);
+		free(log->buf);
+		return TRACE_ERR_OPEN;
+	}
+	return 0;
+}
+
+/*
+ * Function to write out the events an event log has buffered.
+ *		:param log: the log
+ * **Returns**: 0, or TRACE_ERR_OPEN if the write fails
+ */
+static int event_log_flush(struct event_log *log) {
+	size_t len = log->len;
+	log->len = 0;
+	return (fwrite(log->buf, 1, len, log->fp) != len) ? TRACE_ERR_OPEN : 0;
+}
+
+/*
+ * Function to add one reference to an event log.
+ *		:param log: the log
+ *		:param page: the page referenced
+ *		:param slot: the frame slot it faulted into, EVENT_HIT, or EVENT_NO_FRAME
+ * **Returns**: 0, or TRACE_ERR_OPEN if a write fails
+ */
+int event_log_put(struct event_log *log, page_t page, int slot) {
+	if (log->len + EVENT_SIZE > DISPLAY_BUFFER_SIZE && event_log_flush(log) != 0)
+		return TRACE_ERR_OPEN;
+	put_le(log->buf + log->len, 8, page);
+	put_le(log->buf + log->len + 8, 4, (page_t) (unsigned int) slot);
+	log->len += EVENT_SIZE;
+	return 0;
+}
+
+/*
+ * Function to finish an event log that was being written, and close its file.
+ *		:param log: the log
+ * **Returns**: 0, or TRACE_ERR_OPEN if a write fails
+ */
+int event_log_close(struct event_log *log) {
+	int err = event_log_flush(log);
+	if (fclose(log->fp) != 0)
+		err = TRACE_ERR_OPEN;
+	free(log->buf);
+	return err;
+}
+
+/*
+ * Function to open an event log for reading, and read its header. The log is
+ * closed once event_log_next reaches its end (or an error).
+ *		:param log: the log to set up
+ *		:param file_name: the name of the file to read ("-" reads stdin)
+ * **Returns**: 0, or TRACE_ERR_OPEN if the file can't be opened, or
+ *				TRACE_ERR_FORMAT if it isn't an event log
+ */
+int event_log_read(struct event_log *log, const char *file_name) {
+	unsigned char header[EVENT_HEADER_SIZE];
+
+	log->buf = NULL;
+	log->len = 0;
+	log->fp = (strcmp(file_name, "-") == 0) ? stdin : fopen(file_name, "rb");
+	if (!log->fp)
+		return TRACE_ERR_OPEN;
+
+	if (fread(header, 1, sizeof(header), log->fp) != sizeof(header) ||
+		memcmp(header, EVENT_MAGIC, 4) != 0 || get_le(header + 4, 2) != EVENT_VERSION ||
+		get_le(header + 8, 4) > MAX_FAST_MEMORY_FRAMES) {
+		fclose(log->fp);
+		return TRACE_ERR_FORMAT;
+	}
+	log->frame_num = (int) get_le(header + 8, 4);
+	return 0;
+}
+
+/*
+ * Function to read the next reference from an event log.
+ *		:param log: the log (opened by event_log_read)
+ *		:param page: where to store the page referenced
+ *		:param slot: where to store its frame slot, EVENT_HIT, or EVENT_NO_FRAME
+ * **Returns**: 1 if an event was read, 0 at the end of the log, or
+ *				TRACE_ERR_FORMAT if the log ends partway through an event or
+ *				its slot is out of range
+ */
+int event_log_next(struct event_log *log, page_t *page, int *slot) {
+	unsigned char event[EVENT_SIZE];
+	size_t got = fread(event, 1, sizeof(event), log->fp);
+
+	if (got != sizeof(event)) {
+		fclose(log->fp);
+		return (got == 0) ? 0 : TRACE_ERR_FORMAT;
+	}
+
+	*page = get_le(event, 8);
+	*slot = (int) (unsigned int) get_le(event + 8, 4);
+	if (*slot >= log->frame_num || *slot < EVENT_NO_FRAME) {
+		fclose(log->fp);
+		return TRACE_ERR_FORMAT;
+	}
+	return 1;
+}
@@ -0,0 +1,32 @@
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include <stdio.h>
+#include "page.h"
+
+/* binary event log format (see display.c) */
+#define EVENT_MAGIC "PGEV"
+#define EVENT_VERSION 1
+#define EVENT_HEADER_SIZE 16
+#define EVENT_SIZE 12
+
+#define EVENT_HIT -1		/* slot of a reference that was resident */
+#define EVENT_NO_FRAME -2	/* slot of a fault with no frames to load the page into */
+
+/* an event log being written or read one reference at a time */
+struct event_log {
+	FILE *fp;			/* the log file */
+	int frame_num;		/* number of frames in the simulated memory */
+	unsigned char *buf;	/* events not yet written (when writing) */
+	size_t len;			/* bytes in buf */
+};
+
+void display(page_t frames[], int num_frames, page_t page, int faulted);
+void display_flush(void);
+int event_log_open(struct event_log *log, const char *file_name, int frame_num);
+int event_log_put(struct event_log *log, page_t page, int slot);
+int event_log_close(struct event_log *log);
+int event_log_read(struct event_log *log, const char *file_name);
+int event_log_next(struct event_log *log, page_t *page, int *slot);
+
+#endif
@@ -0,0 +1,356 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "algorithms.h"
+#include "instrument.h"
+#include "pagemap.h"
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * instrument records why a policy faults as often as it does, rather than just how
+ * often: how long the pages it evicts had been resident, how soon an evicted page
+ * is faulted back in, how the faults spread over the pages, and how many frames
+ * are in use and how many faults happen over the course of the run. It is built
+ * into pagesim and pagestats only with make INSTRUMENT=1 (which defines
+ * INSTRUMENT), so their ordinary runs don't carry it at all.
+ *
+ * It watches an engine from the outside, through the shared state of struct
+ * engine, so no engine needs changing: a run goes one reference at a time, and
+ * after each fault the slot the page was loaded into (engine->slot) says which
+ * page was evicted, since every engine loads a faulting page into the slot of its
+ * victim; the engines whose resident sets shrink also list the frames they empty
+ * (engine->released). The pages are first numbered densely (struct page_ids,
+ * which pagestats shares between its runs), and everything a run updates per
+ * reference is allocated before it starts; the histograms and timeline it fills
+ * are in a struct instrument, allocated on cache line boundaries by
+ * instrument_new.
+ *
+ * instrument_write writes the records of any number of runs as JSON, or as CSV (one
+ * value per row) if the file name ends in ".csv".
+ *
+ * Usage:
+ *   Compile with another file; there is no main function
+ */
+
+//======================================================//
+
+/*
+ * Function to find the histogram bucket a value falls in.
+ *		:param value: the value (not negative)
+ * **Returns**: the bucket: floor(log2(value)), or 0 for 0, capped at the last bucket
+ */
+static int bucket_of(long value) {
+	int b = (value < 2) ? 0 : 63 - __builtin_clzl((unsigned long) value);
+	return (b < INSTR_BUCKETS) ? b : INSTR_BUCKETS - 1;
+}
+
+/*
+ * Function to number the distinct pages of a reference string, in order of their
+ * first reference.
+ *		:param ids: the numbering to set up
+ *		:param arr: the page references
+ *		:param arr_size: the number of page references
+ * **Returns**: 0 on success, -1 if memory could not be allocated
+ */
+int page_ids_init(struct page_ids *ids, page_t arr[], int arr_size) {
+	struct pagemap map;
+	int i, id, capacity = 1024;
+
+	ids->ids = malloc((arr_size + 1) * sizeof(int));
+	ids->pages = malloc(capacity * sizeof(page_t));
+	ids->num_ids = 0;
+	if (!ids->ids || !ids->pages || pagemap_init(&map, capacity, page_span(arr, arr_size)) != 0) {
+		free(ids->ids);
+		free(ids->pages);
+		return -1;
+	}
+
+	for (i = 0; i < arr_size; i++) {
+		id = pagemap_get(&map, arr[i]);
+		if (id < 0) {
+			id = ids->num_ids++;
+			if (id == capacity) {
+				page_t *grown = realloc(ids->pages, 2 * capacity * sizeof(page_t));
+				if (!grown)
+					break;
+				ids->pages = grown;
+				capacity *= 2;
+			}
+			ids->pages[id] = arr[i];
+			if (pagemap_put(&map, arr[i], id) != 0)
+				break;
+		}
+		ids->ids[i] = id;
+	}
+	pagemap_destroy(&map);
+
+	if (i < arr_size) {
+		page_ids_free(ids);
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * Function to release a numbering of pages.
+ *		:param ids: the numbering
+ */
+void page_ids_free(struct page_ids *ids) {
+	free(ids->ids);
+	free(ids->pages);
+	ids->ids = NULL;
+	ids->pages = NULL;
+	ids->num_ids = 0;
+}
+
+/*
+ * Function to allocate the (empty) records of some instrumented runs, each
+ * starting a cache line.
+ *		:param count: the number of runs
+ * **Returns**: the records, to be released with free, or NULL if memory could not be
+ *				allocated
+ */
+struct instrument * instrument_new(int count) {
+	struct instrument *instr = aligned_alloc(INSTR_LINE, (count > 0 ? count : 1) *
+											 sizeof(struct instrument));
+	if (instr)
+		memset(instr, 0, (count > 0 ? count : 1) * sizeof(struct instrument));
+	return instr;
+}
+
+/*
+ * Function to run a policy over a whole reference string, recording what it does
+ * (exits with an error message if memory runs out).
+ *		:param policy: the policy to run
+ *		:param arr: an array of pages to be allocated
+ *		:param arr_size: the number of pages to be allocated
+ *		:param frame_num: the number of frames in physical memory
+ *		:param ids: the numbering of the pages in arr
+ *		:param stats: an array which will store the number of page faults (index 0)
+ *					  and the number of references (index 1), counted as usual
+ *		:param instr: the record to fill in (zeroed, e.g., by instrument_new)
+ */
+void simulate_instrumented(const struct policy *policy, page_t arr[], int arr_size,
+						   int frame_num, const struct page_ids *ids, int stats[],
+						   struct instrument *instr) {
+
+	/* everything updated per reference, allocated up front */
+	int *resident = malloc((frame_num + 1) * sizeof(int));		/* page number in each slot */
+	long *loaded_at = malloc((frame_num + 1) * sizeof(long));	/* when each slot was loaded */
+	long *evicted_at = malloc((ids->num_ids + 1) * sizeof(long));	/* when each page was
+																	   last evicted (-1 if not) */
+	long *faults = calloc(ids->num_ids + 1, sizeof(long));		/* faults of each page */
+	if (!resident || !loaded_at || !evicted_at || !faults) {
+		printf("Error: cannot allocate memory for instrumenting %s.\n", policy->name);
+		exit(1);
+	}
+
+	int i, j, id, slot, faulted, occupied = 0;
+	long dist, left;
+	for (i = 0; i < frame_num; i++)
+		resident[i] = -1;
+	for (i = 0; i < ids->num_ids; i++)
+		evicted_at[i] = -1;
+
+	instr->policy = policy->name;
+	instr->frame_num = frame_num;
+	instr->num_refs = arr_size;
+	instr->interval = (arr_size + INSTR_TIMELINE - 1) / INSTR_TIMELINE;
+	if (instr->interval < 1)
+		instr->interval = 1;
+	left = instr->interval;
+
+	struct engine *engine = engine_new(policy, arr, arr_size, frame_num);
+	engine->released = malloc((frame_num + 1) * sizeof(int));
+	if (!engine->released) {
+		printf("Error: cannot allocate memory for instrumenting %s.\n", policy->name);
+		exit(1);
+	}
+
+	for (i = 0; i < arr_size; i++) {
+		engine->num_released = 0;
+		faulted = policy->access(engine, arr[i]);
+
+		/* pages let go of (before any page this reference loaded) */
+		for (j = 0; j < engine->num_released; j++) {
+			slot = engine->released[j];
+			instr->evict_age[bucket_of(i - loaded_at[slot])]++;
+			instr->num_releases++;
+			evicted_at[resident[slot]] = i;
+			resident[slot] = -1;
+			occupied--;
+		}
+
+		if (faulted) {
+			id = ids->ids[i];
+			faults[id]++;
+			instr->num_faults++;
+			instr->sample_faults[instr->num_samples]++;
+
+			if (evicted_at[id] >= 0) {
+				dist = i - evicted_at[id];
+				instr->refault_distance[bucket_of(dist)]++;
+				instr->num_refaults++;
+				if (dist <= frame_num)
+					instr->num_quick_refaults++;
+				evicted_at[id] = -1;
+			}
+
+			/* the page went into its victim's slot (there is none without frames) */
+			slot = engine->slot;
+			if (frame_num > 0 && slot >= 0) {
+				if (resident[slot] >= 0) {
+					instr->evict_age[bucket_of(i - loaded_at[slot])]++;
+					instr->num_evictions++;
+					evicted_at[resident[slot]] = i;
+				}
+				else {
+					occupied++;
+				}
+				resident[slot] = id;
+				loaded_at[slot] = i;
+			}
+		}
+
+		if (--left == 0 || i == arr_size - 1) {
+			instr->occupancy[instr->num_samples++] = occupied;
+			left = instr->interval;
+		}
+	}
+	free(engine->released);
+	engine->released = NULL;
+	policy->stats(engine, stats);
+	policy->destroy(engine);
+
+	/* the spread of faults over the pages, and the pages that faulted most (the
+	 * earliest referenced first, among equals) */
+	for (id = 0; id < ids->num_ids; id++) {
+		if (faults[id] == 0)
+			continue;
+		instr->page_faults[bucket_of(faults[id])]++;
+		if (instr->num_top == INSTR_TOP && faults[id] <= instr->top_faults[INSTR_TOP - 1])
+			continue;
+		j = (instr->num_top < INSTR_TOP) ? instr->num_top++ : INSTR_TOP - 1;
+		while (j > 0 && instr->top_faults[j - 1] < faults[id]) {
+			instr->top_pages[j] = instr->top_pages[j - 1];
+			instr->top_faults[j] = instr->top_faults[j - 1];
+			j--;
+		}
+		instr->top_pages[j] = ids->pages[id];
+		instr->top_faults[j] = faults[id];
+	}
+
+	free(resident);
+	free(loaded_at);
+	free(evicted_at);
+	free(faults);
+}
+
+/*
+ * Function to write an array of counts as a JSON array.
+ *		:param fp: the file to write to
+ *		:param name: the key of the array
+ *		:param values: the counts
+ *		:param count: the number of counts
+ */
+static void write_json_array(FILE *fp, const char *name, const long values[], int count) {
+	int i;
+	fprintf(fp, ",\n     \"%s\": [", name);
+	for (i = 0; i < count; i++)
+		fprintf(fp, (i > 0) ? ", %ld" : "%ld", values[i]);
+	fprintf(fp, "]");
+}
+
+/*
+ * Function to write the record of one run as a JSON object.
+ *		:param fp: the file to write to
+ *		:param instr: the record
+ *		:param last: "boolean"; the record is the last one (no comma after it)
+ */
+static void write_json(FILE *fp, const struct instrument *instr, int last) {
+	int i;
+	fprintf(fp, "    {\"policy\": \"%s\", \"frames\": %d, \"references\": %ld, \"faults\": %ld, "
+			"\"evictions\": %ld, \"releases\": %ld, \"refaults\": %ld, \"quick_refaults\": %ld",
+			instr->policy, instr->frame_num, instr->num_refs, instr->num_faults,
+			instr->num_evictions, instr->num_releases, instr->num_refaults,
+			instr->num_quick_refaults);
+	write_json_array(fp, "eviction_age", instr->evict_age, INSTR_BUCKETS);
+	write_json_array(fp, "refault_distance", instr->refault_distance, INSTR_BUCKETS);
+	write_json_array(fp, "faults_per_page", instr->page_faults, INSTR_BUCKETS);
+	fprintf(fp, ",\n     \"interval\": %ld", instr->interval);
+	write_json_array(fp, "occupancy", instr->occupancy, instr->num_samples);
+	write_json_array(fp, "interval_faults", instr->sample_faults, instr->num_samples);
+	fprintf(fp, ",\n     \"top_pages\": [");
+	for (i = 0; i < instr->num_top; i++)
+		fprintf(fp, "%s{\"page\": %" PRIpage ", \"faults\": %ld}", (i > 0) ? ", " : "",
+				instr->top_pages[i], instr->top_faults[i]);
+	fprintf(fp, "]}%s\n", last ? "" : ",");
+}
+
+/*
+ * Function to write the record of one run as CSV rows of policy, frames, metric,
+ * index and value: the index is empty for a counter, the smallest value of the
+ * bucket for a histogram, the last reference of the sample for the timeline, and
+ * the page for the most-faulted pages.
+ *		:param fp: the file to write to
+ *		:param instr: the record
+ */
+static void write_csv(FILE *fp, const struct instrument *instr) {
+	const char *names[] = { "eviction_age", "refault_distance", "faults_per_page" };
+	const long *histograms[] = { instr->evict_age, instr->refault_distance, instr->page_faults };
+	const char *p = instr->policy;
+	int f = instr->frame_num, h, i;
+
+	fprintf(fp, "%s,%d,references,,%ld\n", p, f, instr->num_refs);
+	fprintf(fp, "%s,%d,faults,,%ld\n", p, f, instr->num_faults);
+	fprintf(fp, "%s,%d,evictions,,%ld\n", p, f, instr->num_evictions);
+	fprintf(fp, "%s,%d,releases,,%ld\n", p, f, instr->num_releases);
+	fprintf(fp, "%s,%d,refaults,,%ld\n", p, f, instr->num_refaults);
+	fprintf(fp, "%s,%d,quick_refaults,,%ld\n", p, f, instr->num_quick_refaults);
+	for (h = 0; h < 3; h++) {
+		for (i = 0; i < INSTR_BUCKETS; i++)
+			fprintf(fp, "%s,%d,%s,%ld,%ld\n", p, f, names[h], (i > 0) ? 1L << i : 0L,
+					histograms[h][i]);
+	}
+	for (i = 0; i < instr->num_samples; i++) {
+		long end = (i == instr->num_samples - 1) ? instr->num_refs : (i + 1) * instr->interval;
+		fprintf(fp, "%s,%d,occupancy,%ld,%ld\n", p, f, end, instr->occupancy[i]);
+		fprintf(fp, "%s,%d,interval_faults,%ld,%ld\n", p, f, end, instr->sample_faults[i]);
+	}
+	for (i = 0; i < instr->num_top; i++)
+		fprintf(fp, "%s,%d,page_faults,%" PRIpage ",%ld\n", p, f, instr->top_pages[i],
+				instr->top_faults[i]);
+}
+
+/*
+ * Function to write the records of some instrumented runs to a file, as CSV if its
+ * name ends in ".csv" and as JSON otherwise.
+ *		:param file_name: the name of the file
+ *		:param instr: the records
+ *		:param count: the number of records
+ * **Returns**: 0 on success, -1 if the file could not be written
+ */
+int instrument_write(const char *file_name, const struct instrument instr[], int count) {
+	size_t len = strlen(file_name);
+	int csv = len >= 4 && strcmp(file_name + len - 4, ".csv") == 0;
+	int i;
+
+	FILE *fp = fopen(file_name, "w");
+	if (!fp)
+		return -1;
+	if (csv) {
+		fprintf(fp, "policy,frames,metric,index,value\n");
+		for (i = 0; i < count; i++)
+			write_csv(fp, &instr[i]);
+	}
+	else {
+		fprintf(fp, "{\n  \"buckets\": \"log2\",\n  \"runs\": [\n");
+		for (i = 0; i < count; i++)
+			write_json(fp, &instr[i], i == count - 1);
+		fprintf(fp, "  ]\n}\n");
+	}
+	return (fclose(fp) == 0) ? 0 : -1;
+}
@@ -0,0 +1,58 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include "page.h"
+#include "policy.h"
+
+#define INSTR_BUCKETS 32	/* buckets of each histogram, one per power of two */
+#define INSTR_TIMELINE 256	/* most samples of a run's timeline */
+#define INSTR_TOP 16		/* most-faulted pages listed per run */
+#define INSTR_LINE 64		/* cache line size; each group of counters starts a line */
+
+/* the distinct pages of a reference string, numbered in order of first reference */
+struct page_ids {
+	int *ids;		/* number of the page at each position */
+	page_t *pages;	/* page of each number */
+	int num_ids;
+};
+
+/* what one instrumented run of a policy recorded, counting every reference from
+ * empty memory; bucket b of a histogram counts values from 2^b to 2^(b+1) - 1
+ * (bucket 0 also counts 0) */
+struct instrument {
+	const char *policy;		/* name of the policy run */
+	int frame_num;
+	long num_refs;
+	long num_faults;
+	long num_evictions;		/* pages replaced by another */
+	long num_releases;		/* pages let go of (by the policies whose resident sets shrink) */
+	long num_refaults;		/* faults of a page that had been evicted */
+	long num_quick_refaults;	/* of those, faults within frame_num references of it */
+
+	_Alignas(INSTR_LINE) long evict_age[INSTR_BUCKETS];	/* references a page was resident
+														   for when it was evicted or let go */
+	_Alignas(INSTR_LINE) long refault_distance[INSTR_BUCKETS];	/* references from a page's
+																   leaving to its next fault */
+	_Alignas(INSTR_LINE) long page_faults[INSTR_BUCKETS];	/* pages by how often they faulted */
+
+	/* timeline: the references are cut into samples of interval references each */
+	long interval;
+	int num_samples;
+	_Alignas(INSTR_LINE) long occupancy[INSTR_TIMELINE];	/* frames holding a page at the
+															   end of each sample */
+	_Alignas(INSTR_LINE) long sample_faults[INSTR_TIMELINE];	/* faults within each sample */
+
+	int num_top;
+	page_t top_pages[INSTR_TOP];	/* the pages that faulted most, most first */
+	long top_faults[INSTR_TOP];
+};
+
+int page_ids_init(struct page_ids *ids, page_t arr[], int arr_size);
+void page_ids_free(struct page_ids *ids);
+struct instrument * instrument_new(int count);
+void simulate_instrumented(const struct policy *policy, page_t arr[], int arr_size,
+						   int frame_num, const struct page_ids *ids, int stats[],
+						   struct instrument *instr);
+int instrument_write(const char *file_name, const struct instrument instr[], int count);
+
+#endif
@@ -0,0 +1,316 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "latency.h"
+
+#define LATENCY_TLB_ENTRIES 64		/* default TLB: 64 entries, 4 ways */
+#define LATENCY_TLB_WAYS 4
+#define LATENCY_LOOKUP 1.0			/* default latencies (ns) */
+#define LATENCY_WALK 30.0
+#define LATENCY_MEM 100.0
+#define LATENCY_SWAP 100000.0		/* a page read in from an SSD */
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * latency puts a price on a policy's misses. Every reference is looked up in a TLB
+ * in front of the frames; a TLB miss walks the page table; the page is then
+ * accessed in its frame, after being read in from a swap device behind the frames
+ * if it faulted (and after the page it replaces is written back, if that one is
+ * dirty). Each of these layers has a latency (see struct latency_model), and a
+ * run adds up what the counted references spent in each, for the effective access
+ * time (the mean per reference) and the stall time (what the walks, swap-ins and
+ * write-backs added to the TLB lookups and memory accesses every reference makes).
+ *
+ * The TLB is set associative, with up to 16 ways: a page's set is picked by the
+ * low bits of its number (the number of sets is a power of two), and each set is
+ * a short array of page numbers kept in order of use, so a lookup is a scan of a
+ * few entries in one or two cache lines, and the least recently used entry is the
+ * one replaced. The TLB only ever maps pages in memory: when an engine replaces a
+ * page or lets it go, the page's entry is shot down. The page each frame holds is
+ * shadowed here, so finding what left costs O(1) per reference as well.
+ *
+ * Usage:
+ *   Compile with another file; there is no main function
+ */
+
+//======================================================//
+
+/* a set associative TLB */
+struct tlb {
+	int num_sets;	/* a power of two (0 if there is no TLB) */
+	int ways;
+	page_t *tags;	/* ways entries per set, most recently used first (PAGE_NONE if empty) */
+};
+
+/*
+ * Function to fill in the default cost model.
+ *		:param model: the model
+ */
+void latency_defaults(struct latency_model *model) {
+	model->tlb_entries = LATENCY_TLB_ENTRIES;
+	model->tlb_ways = LATENCY_TLB_WAYS;
+	model->tlb_hit = LATENCY_LOOKUP;
+	model->walk = LATENCY_WALK;
+	model->mem = LATENCY_MEM;
+	model->swap = LATENCY_SWAP;
+}
+
+/*
+ * Function to read a latency in ns.
+ *		:param value: the text of it
+ *		:param latency: where to store it
+ * **Returns**: 0, or -1 if it is not a non-negative number
+ */
+static int parse_latency(const char *value, double *latency) {
+	char *end;
+	*latency = strtod(value, &end);
+	return (end == value || *end != '\0' || !(*latency >= 0)) ? -1 : 0;
+}
+
+/*
+ * Function to read a cost model: comma separated settings, each of which changes
+ * one thing about the default model, or "default" for the default model as it is.
+ * The settings are tlb=entries[:ways] (the TLB's size, 64:4 by default; the ways
+ * stay as they were if only the entries are given, entries/ways must be a power of
+ * two, and 0 entries is no TLB), and the latencies in ns of
+ * lookup=1 (a TLB lookup), walk=30 (a page table walk), mem=100 (a memory access)
+ * and swap=100000 (reading a page in from swap, or writing one back).
+ *		:param spec: the settings (i.e., "tlb=1536:12,swap=8000000"; 1536/12 = 128 sets)
+ *		:param model: where to store the model
+ * **Returns**: 0, or -1 if a setting is not one of these
+ */
+int latency_parse(const char *spec, struct latency_model *model) {
+	char *copy = malloc(strlen(spec) + 1), *setting, *value, *end;
+	int err = 0;
+
+	if (!copy)
+		return -1;
+	strcpy(copy, spec);
+	latency_defaults(model);
+
+	for (setting = strtok(copy, ","); setting && err == 0; setting = strtok(NULL, ",")) {
+		if (strcmp(setting, "default") == 0)
+			continue;
+		value = strchr(setting, '=');
+		if (!value) {
+			err = -1;
+			break;
+		}
+		*value++ = '\0';
+
+		if (strcmp(setting, "tlb") == 0) {
+			model->tlb_entries = (int) strtol(value, &end, 10);
+			if (end != value && *end == ':')
+				model->tlb_ways = (int) strtol(end + 1, &end, 10);
+			int sets = (model->tlb_ways > 0) ? model->tlb_entries / model->tlb_ways : 0;
+			if (end == value || *end != '\0' || model->tlb_entries < 0)
+				err = -1;
+			else if (model->tlb_entries > 0 && (model->tlb_ways < 1 ||
+					 model->tlb_ways > LATENCY_MAX_WAYS ||
+					 model->tlb_entries % model->tlb_ways != 0 || (sets & (sets - 1)) != 0))
+				err = -1;
+		}
+		else if (strcmp(setting, "lookup") == 0)
+			err = parse_latency(value, &model->tlb_hit);
+		else if (strcmp(setting, "walk") == 0)
+			err = parse_latency(value, &model->walk);
+		else if (strcmp(setting, "mem") == 0)
+			err = parse_latency(value, &model->mem);
+		else if (strcmp(setting, "swap") == 0)
+			err = parse_latency(value, &model->swap);
+		else
+			err = -1;
+	}
+
+	free(copy);
+	return err;
+}
+
+/*
+ * Function to look a page up in the TLB, making it the most recently used entry
+ * of its set if it is there.
+ *		:param tlb: the TLB
+ *		:param page: the page
+ * **Returns**: 1 if the page was in the TLB, else 0
+ */
+static int tlb_lookup(struct tlb *tlb, page_t page) {
+	if (tlb->num_sets == 0)
+		return 0;
+	page_t *set = &tlb->tags[(size_t) (page & (page_t) (tlb->num_sets - 1)) * tlb->ways];
+	int w;
+	for (w = 0; w < tlb->ways; w++) {
+		if (set[w] == page) {
+			memmove(&set[1], &set[0], w * sizeof(page_t));
+			set[0] = page;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Function to put a page into the TLB as the most recently used entry of its set,
+ * replacing the least recently used one.
+ *		:param tlb: the TLB
+ *		:param page: the page (not already in it)
+ */
+static void tlb_insert(struct tlb *tlb, page_t page) {
+	if (tlb->num_sets == 0)
+		return;
+	page_t *set = &tlb->tags[(size_t) (page & (page_t) (tlb->num_sets - 1)) * tlb->ways];
+	memmove(&set[1], &set[0], (tlb->ways - 1) * sizeof(page_t));
+	set[0] = page;
+}
+
+/*
+ * Function to shoot a page's entry down, if it has one.
+ *		:param tlb: the TLB
+ *		:param page: the page
+ * **Returns**: 1 if the page was in the TLB, else 0
+ */
+static int tlb_invalidate(struct tlb *tlb, page_t page) {
+	if (tlb->num_sets == 0)
+		return 0;
+	page_t *set = &tlb->tags[(size_t) (page & (page_t) (tlb->num_sets - 1)) * tlb->ways];
+	int w;
+	for (w = 0; w < tlb->ways; w++) {
+		if (set[w] == page) {
+			memmove(&set[w], &set[w + 1], (tlb->ways - 1 - w) * sizeof(page_t));
+			set[tlb->ways - 1] = PAGE_NONE;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Function to run a policy with a TLB in front of its frames and swap behind them
+ * (exits with an error message if memory runs out), adding up what the counted
+ * references cost in each layer.
+ *		:param policy: the policy to run
+ *		:param arr: an array of page references
+ *		:param writes: whether each reference writes its page (NULL if none does)
+ *		:param arr_size: the number of page references
+ *		:param frame_num: the number of frames in physical memory
+ *		:param model: the cost model
+ *		:param stats: an array which will store the number of page faults (index 0)
+ *					  and the number of references (index 1)
+ *		:param report: where to store the costs
+ */
+void simulate_latency(const struct policy *policy, page_t arr[], const unsigned char writes[],
+					  int arr_size, int frame_num, const struct latency_model *model,
+					  int stats[], struct latency_report *report) {
+	struct engine *engine = engine_new(policy, arr, arr_size, frame_num);
+	struct dirty_pages dirty;
+	struct tlb tlb;
+	page_t *shadow = malloc((frame_num + 1) * sizeof(page_t));	/* page held by each slot */
+	int i, j, hit, faulted, writebacks = 0;
+
+	tlb.ways = model->tlb_ways;
+	tlb.num_sets = (model->tlb_entries > 0) ? model->tlb_entries / model->tlb_ways : 0;
+	tlb.tags = malloc(((size_t) model->tlb_entries + 1) * sizeof(page_t));
+	engine->released = malloc((frame_num + 1) * sizeof(int));
+	if (!shadow || !tlb.tags || !engine->released ||
+		(writes && dirty_init(&dirty, engine, 0) != 0)) {
+		printf("Error: cannot allocate memory for %d frames.\n", frame_num);
+		exit(1);
+	}
+	for (i = 0; i < model->tlb_entries; i++)
+		tlb.tags[i] = PAGE_NONE;
+	for (i = 0; i < frame_num; i++)
+		shadow[i] = PAGE_NONE;
+	memset(report, 0, sizeof(struct latency_report));
+
+	for (i = 0; i < arr_size; i++) {
+		hit = tlb_lookup(&tlb, arr[i]);
+		engine->num_released = 0;
+		engine->writing = writes && writes[i];
+		faulted = policy->access(engine, arr[i]);
+		if (writes) {
+			writebacks = dirty_update(&dirty, engine, arr[i], writes[i], faulted);
+			if (writebacks < 0) {
+				printf("Error: cannot allocate memory for the dirty pages.\n");
+				exit(1);
+			}
+		}
+
+		/* the pages that left memory lose their entries; the page that came in
+		 * (or was there all along, on a TLB miss) gets one */
+		for (j = 0; j < engine->num_released; j++) {
+			report->shootdowns += tlb_invalidate(&tlb, shadow[engine->released[j]]);
+			shadow[engine->released[j]] = PAGE_NONE;
+		}
+		if (faulted && frame_num > 0) {
+			if (shadow[engine->slot] != PAGE_NONE)
+				report->shootdowns += tlb_invalidate(&tlb, shadow[engine->slot]);
+			shadow[engine->slot] = arr[i];
+		}
+		if (!hit && (!faulted || frame_num > 0))
+			tlb_insert(&tlb, arr[i]);
+
+		if (engine->is_filled) {
+			report->refs++;
+			report->tlb_hits += hit;
+			report->walks += !hit;
+			report->faults += faulted;
+			report->writebacks += writebacks;
+		}
+	}
+
+	report->tlb_time = report->refs * model->tlb_hit;
+	report->walk_time = report->walks * model->walk;
+	report->mem_time = report->refs * model->mem;
+	report->swap_time = report->faults * model->swap;
+	report->writeback_time = report->writebacks * model->swap;
+
+	free(engine->released);
+	engine->released = NULL;
+	policy->stats(engine, stats);
+	policy->destroy(engine);
+	free(tlb.tags);
+	free(shadow);
+	if (writes)
+		dirty_free(&dirty);
+}
+
+/*
+ * Function to print what a run cost: a line per layer, then the effective access
+ * time and the stall time.
+ *		:param model: the cost model the run used
+ *		:param report: the costs of the run
+ */
+void latency_print(const struct latency_model *model, const struct latency_report *report) {
+	double total = report->tlb_time + report->walk_time + report->mem_time + report->swap_time +
+				   report->writeback_time;
+	double stall = report->walk_time + report->swap_time + report->writeback_time;
+	double share = (total > 0) ? 100 / total : 0;
+
+	if (model->tlb_entries > 0)
+		printf("TLB: %d entries, %d-way; hit rate = %ld / %ld = %3.2f%%, %ld shootdowns\n",
+			   model->tlb_entries, model->tlb_ways, report->tlb_hits, report->refs,
+			   (report->refs > 0) ? 100.0 * report->tlb_hits / report->refs : 0,
+			   report->shootdowns);
+	else
+		printf("TLB: none; every reference walks the page table\n");
+
+	printf("\n%-12s %10s %12s %18s %8s\n", "layer", "events", "latency (ns)", "time (ns)", "share");
+	printf("%-12s %10ld %12.2f %18.2f %7.2f%%\n", "tlb lookup", report->refs, model->tlb_hit,
+		   report->tlb_time, report->tlb_time * share);
+	printf("%-12s %10ld %12.2f %18.2f %7.2f%%\n", "page walk", report->walks, model->walk,
+		   report->walk_time, report->walk_time * share);
+	printf("%-12s %10ld %12.2f %18.2f %7.2f%%\n", "memory", report->refs, model->mem,
+		   report->mem_time, report->mem_time * share);
+	printf("%-12s %10ld %12.2f %18.2f %7.2f%%\n", "swap", report->faults, model->swap,
+		   report->swap_time, report->swap_time * share);
+	printf("%-12s %10ld %12.2f %18.2f %7.2f%%\n", "write-back", report->writebacks, model->swap,
+		   report->writeback_time, report->writeback_time * share);
+	printf("%-12s %10s %12s %18.2f\n", "total", "", "", total);
+
+	printf("\nEffective access time = %.2f ns per reference\n",
+		   (report->refs > 0) ? total / report->refs : 0);
+	printf("Stall time = %.2f ns (page walks, swap-ins and write-backs; %3.2f%% of the "
+		   "total)\n", stall, stall * share);
+}
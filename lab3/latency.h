@@ -0,0 +1,43 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "page.h"
+#include "policy.h"
+
+#define LATENCY_MAX_WAYS 16		/* most entries in a TLB set */
+
+/* the layers a reference goes through, and what each costs (in ns) */
+struct latency_model {
+	int tlb_entries;	/* entries in the TLB (0 for none) */
+	int tlb_ways;		/* entries per set */
+	double tlb_hit;		/* looking a page up in the TLB, hit or miss */
+	double walk;		/* walking the page table after a TLB miss */
+	double mem;			/* accessing the page in its frame */
+	double swap;		/* reading a faulting page in from the swap device, or writing a
+						   dirty page back to it */
+};
+
+/* what the counted references of a run cost, by layer */
+struct latency_report {
+	long refs;			/* references counted (once memory has filled up) */
+	long tlb_hits;
+	long walks;			/* TLB misses */
+	long faults;		/* swap-ins */
+	long writebacks;	/* dirty pages written back to swap */
+	long shootdowns;	/* TLB entries invalidated as their page left memory (every
+						   reference, counted or not) */
+	double tlb_time;
+	double walk_time;
+	double mem_time;
+	double swap_time;
+	double writeback_time;
+};
+
+void latency_defaults(struct latency_model *model);
+int latency_parse(const char *spec, struct latency_model *model);
+void simulate_latency(const struct policy *policy, page_t arr[], const unsigned char writes[],
+					  int arr_size, int frame_num, const struct latency_model *model,
+					  int stats[], struct latency_report *report);
+void latency_print(const struct latency_model *model, const struct latency_report *report);
+
+#endif
@@ -0,0 +1,307 @@
+#include <stdlib.h>
+#include <string.h>
+#include "libpagesim.h"
+#include "policy.h"
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * libpagesim is the replacement engines as a library (libpagesim.a and
+ * libpagesim.so; make lib), for programs that ask many questions of the policies
+ * without running pagesim for each one. A simulator is created for any registered
+ * policy (see policy.c) and a number of frames, then fed references one at a time
+ * or in blocks as they become known, and its miss rate can be read at any point
+ * along the way:
+ *
+ *   struct pagesim *sim = pagesim_create("lru", 64, NULL, 0, &err);
+ *   pagesim_access_batch(sim, pages, num_pages);
+ *   pagesim_snapshot_stats(sim, &stats);
+ *   pagesim_destroy(sim);
+ *
+ * Everything a simulator holds is on the heap, behind its handle, and nothing is
+ * shared between simulators, so any number of them can run in one process (each
+ * used by one thread at a time). The offline policies (extra and fastextra) read
+ * ahead in the references, so they have to be given all of them when they are
+ * created (they are copied), and then fed them in that order (anything else is
+ * refused). PAGE_NONE marks an empty frame, so it is refused as a reference too.
+ * Running out of memory is reported to the caller (PAGESIM_ERR_MEMORY, or -1),
+ * never by exiting.
+ *
+ * A reference can also write its page (pagesim_write). From the first write on,
+ * the simulator follows which of its pages are dirty (see struct dirty_pages in
+ * policy.h) and counts the write-backs as they are replaced; blocks are then fed
+ * one reference at a time, since the dirty pages (and the policies that act on
+ * writes, cflru and wsclock) need to see each one. Before that every reference is
+ * a read, which is all an engine's batch entry point handles.
+ *
+ * Usage:
+ *   Compile with another file; there is no main function
+ */
+
+//======================================================//
+
+/* one policy over one set of frames */
+struct pagesim {
+	const struct policy *policy;
+	struct engine *engine;
+	int frame_num;
+	page_t *pages;		/* offline policies: the references they read ahead in */
+	int num_pages;
+	long accesses;		/* pages referenced since creation or the last reset */
+	int tracking;		/* "boolean"; a page has been written, so dirty is followed */
+	struct dirty_pages dirty;
+};
+
+/*
+ * Function to name the registered policies, for a caller to list them.
+ *		:param index: the position of the policy in the list (from 0)
+ * **Returns**: the name the policy is created by, or NULL past the end of the list
+ */
+const char * pagesim_policy_name(int index) {
+	int i;
+	for (i = 0; i < index && policies[i]; i++)
+		;
+	return (index >= 0 && policies[i]) ? policies[i]->name : NULL;
+}
+
+/*
+ * Function to check that none of some pages is PAGE_NONE, which marks an empty frame
+ * and can't be referenced.
+ *		:param pages: the pages
+ *		:param count: the number of pages
+ * **Returns**: 1 if none of them is, else 0
+ */
+static int real_pages(const page_t pages[], int count) {
+	int i;
+	for (i = 0; i < count; i++) {
+		if (pages[i] == PAGE_NONE)
+			return 0;
+	}
+	return 1;
+}
+
+/*
+ * Function to create a simulator with frame_num empty frames.
+ *		:param algo: the name of the policy (see pagesim_policy_name)
+ *		:param frame_num: the number of frames
+ *		:param pages: the references, for the offline policies (NULL for the others)
+ *		:param num_pages: the number of references
+ *		:param err: where to store why it could not be created (PAGESIM_ERR_*), or NULL
+ * **Returns**: the simulator, or NULL if it could not be created
+ */
+struct pagesim * pagesim_create(const char *algo, int frame_num, const page_t pages[],
+								int num_pages, int *err) {
+	const struct policy *policy = find_policy(algo);
+	struct pagesim *sim;
+	int code = 0;
+
+	if (!policy)
+		code = PAGESIM_ERR_POLICY;
+	else if (frame_num < 0 || frame_num > policy->max_frames)
+		code = PAGESIM_ERR_FRAMES;
+	else if (policy->lookahead && (!pages || num_pages < 0 || !real_pages(pages, num_pages)))
+		code = PAGESIM_ERR_PAGES;
+	if (code != 0) {
+		if (err)
+			*err = code;
+		return NULL;
+	}
+
+	sim = malloc(sizeof(struct pagesim));
+	if (sim) {
+		sim->policy = policy;
+		sim->frame_num = frame_num;
+		sim->pages = NULL;
+		sim->num_pages = 0;
+		sim->engine = NULL;
+		if (policy->lookahead) {
+			sim->pages = malloc((num_pages + 1) * sizeof(page_t));
+			if (sim->pages) {
+				memcpy(sim->pages, pages, num_pages * sizeof(page_t));
+				sim->num_pages = num_pages;
+			}
+		}
+		if (sim->pages || !policy->lookahead)
+			sim->engine = policy->init(sim->pages, sim->num_pages, frame_num);
+	}
+	if (!sim || !sim->engine) {
+		if (sim)
+			free(sim->pages);
+		free(sim);
+		if (err)
+			*err = PAGESIM_ERR_MEMORY;
+		return NULL;
+	}
+
+	sim->accesses = 0;
+	sim->tracking = 0;
+	return sim;
+}
+
+/*
+ * Function to stop following the dirty pages of a simulator.
+ *		:param sim: the simulator
+ */
+static void stop_tracking(struct pagesim *sim) {
+	if (!sim->tracking)
+		return;
+	free(sim->engine->released);
+	sim->engine->released = NULL;
+	dirty_free(&sim->dirty);
+	sim->tracking = 0;
+}
+
+/*
+ * Function to check that pages can be fed to a simulator: none of them is
+ * PAGE_NONE, and as an offline policy has read ahead in its references, it can
+ * only be given the next of them.
+ *		:param sim: the simulator
+ *		:param pages: the pages about to be referenced
+ *		:param count: the number of pages
+ * **Returns**: 1 if they can, else 0
+ */
+static int can_feed(const struct pagesim *sim, const page_t pages[], int count) {
+	if (!sim->policy->lookahead)
+		return count >= 0 && real_pages(pages, count);
+	if (count < 0 || sim->accesses + count > sim->num_pages)
+		return 0;
+	return count == 0 || memcmp(pages, sim->pages + sim->accesses, count * sizeof(page_t)) == 0;
+}
+
+/*
+ * Function to reference one page, following the dirty pages if a page has been
+ * written.
+ *		:param sim: the simulator
+ *		:param page: the page referenced
+ *		:param write: "boolean"; the reference writes the page
+ * **Returns**: 1 if it faulted, else 0, or -1 if memory could not be allocated to
+ *				mark a written page dirty (a read never needs any)
+ */
+static int reference(struct pagesim *sim, page_t page, int write) {
+	struct engine *engine = sim->engine;
+	int faulted;
+
+	sim->accesses++;
+	if (!sim->tracking)
+		return sim->policy->access(engine, page);
+	engine->num_released = 0;
+	engine->writing = write;
+	faulted = sim->policy->access(engine, page);
+	if (dirty_update(&sim->dirty, engine, page, write, faulted) < 0)
+		return -1;
+	return faulted;
+}
+
+/*
+ * Function to reference one page.
+ *		:param sim: the simulator
+ *		:param page: the page referenced
+ * **Returns**: 1 if it faulted (counted or not), 0 if it was in memory, or -1 if
+ *				page is PAGE_NONE, or an offline policy has been fed all of its
+ *				references already, or page is not the next of them
+ */
+int pagesim_access(struct pagesim *sim, page_t page) {
+	if (!can_feed(sim, &page, 1))
+		return -1;
+	return reference(sim, page, 0);
+}
+
+/*
+ * Function to reference one page, writing it (so that it is dirty until it leaves
+ * memory, when it has to be written back).
+ *		:param sim: the simulator
+ *		:param page: the page written
+ * **Returns**: 1 if it faulted (counted or not), 0 if it was in memory, or -1 if
+ *				page is PAGE_NONE, or an offline policy has been fed all of its
+ *				references already (or page is not the next of them), or memory
+ *				could not be allocated to follow the dirty pages (the page was still
+ *				referenced if the simulator already followed them)
+ */
+int pagesim_write(struct pagesim *sim, page_t page) {
+	if (!can_feed(sim, &page, 1))
+		return -1;
+	if (!sim->tracking) {
+		sim->engine->released = malloc((sim->frame_num + 1) * sizeof(int));
+		if (!sim->engine->released || dirty_init(&sim->dirty, sim->engine, 0) != 0) {
+			free(sim->engine->released);
+			sim->engine->released = NULL;
+			return -1;
+		}
+		sim->tracking = 1;
+	}
+	return reference(sim, page, 1);
+}
+
+/*
+ * Function to reference a block of pages, without reporting on each one.
+ *		:param sim: the simulator
+ *		:param pages: the pages referenced
+ *		:param count: the number of pages
+ * **Returns**: 0, or -1 (referencing none of them) if one of them is PAGE_NONE,
+ *				or an offline policy would be fed more references than it was
+ *				given, or other ones
+ */
+int pagesim_access_batch(struct pagesim *sim, const page_t pages[], int count) {
+	int i;
+	if (!can_feed(sim, pages, count))
+		return -1;
+	if (sim->tracking) {
+		for (i = 0; i < count; i++)
+			reference(sim, pages[i], 0);
+		return 0;
+	}
+	sim->accesses += count;
+	sim->policy->access_batch(sim->engine, (page_t *) pages, count);
+	return 0;
+}
+
+/*
+ * Function to read the results of a simulator so far (it carries on as before).
+ *		:param sim: the simulator
+ *		:param stats: where to store them
+ */
+void pagesim_snapshot_stats(struct pagesim *sim, struct pagesim_stats *stats) {
+	int counted[2], i;
+	sim->policy->stats(sim->engine, counted);
+	stats->faults = counted[0];
+	stats->refs = counted[1];
+	stats->writebacks = sim->tracking ? sim->dirty.num_writebacks : 0;
+	stats->accesses = sim->accesses;
+	stats->frame_num = sim->frame_num;
+	stats->resident = 0;
+	for (i = 0; i < sim->frame_num; i++)
+		stats->resident += (sim->engine->frames[i] != PAGE_NONE);
+}
+
+/*
+ * Function to empty a simulator's frames and forget its results, as if it had just
+ * been created (an offline policy starts again from its first reference).
+ *		:param sim: the simulator
+ * **Returns**: 0, or PAGESIM_ERR_MEMORY (leaving the simulator as it was) if memory
+ *				could not be allocated for the new frames
+ */
+int pagesim_reset(struct pagesim *sim) {
+	struct engine *engine = sim->policy->init(sim->pages, sim->num_pages, sim->frame_num);
+	if (!engine)
+		return PAGESIM_ERR_MEMORY;
+	stop_tracking(sim);
+	sim->policy->destroy(sim->engine);
+	sim->engine = engine;
+	sim->accesses = 0;
+	return 0;
+}
+
+/*
+ * Function to release a simulator.
+ *		:param sim: the simulator (may be NULL)
+ */
+void pagesim_destroy(struct pagesim *sim) {
+	if (!sim)
+		return;
+	stop_tracking(sim);
+	sim->policy->destroy(sim->engine);
+	free(sim->pages);
+	free(sim);
+}
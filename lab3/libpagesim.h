@@ -0,0 +1,44 @@
+#ifndef LIBPAGESIM_H
+#define LIBPAGESIM_H
+
+#include "page.h"
+
+#define PAGESIM_ERR_POLICY -1	/* no registered policy has the name */
+#define PAGESIM_ERR_FRAMES -2	/* the number of frames is out of the policy's range */
+#define PAGESIM_ERR_PAGES -3	/* an offline policy was not given its references, or
+								   one of them is PAGE_NONE */
+#define PAGESIM_ERR_MEMORY -4	/* memory could not be allocated */
+
+/* the library is built with -fvisibility=hidden, so only these functions are
+ * exported from libpagesim.so, and the engines' own names can't clash with the
+ * program's */
+#if defined(__GNUC__)
+#define PAGESIM_API __attribute__((visibility("default")))
+#else
+#define PAGESIM_API
+#endif
+
+/* a simulator: one policy over one set of frames (opaque) */
+struct pagesim;
+
+/* the results of a simulator so far */
+struct pagesim_stats {
+	int faults;			/* page faults counted (once memory has filled up, as in pagesim) */
+	int refs;			/* page references counted */
+	int writebacks;		/* dirty pages written back as they were replaced, counted */
+	long accesses;		/* pages referenced since it was created or reset, counted or not */
+	int frame_num;		/* number of frames */
+	int resident;		/* frames holding a page */
+};
+
+PAGESIM_API const char * pagesim_policy_name(int index);
+PAGESIM_API struct pagesim * pagesim_create(const char *algo, int frame_num,
+											const page_t pages[], int num_pages, int *err);
+PAGESIM_API int pagesim_access(struct pagesim *sim, page_t page);
+PAGESIM_API int pagesim_write(struct pagesim *sim, page_t page);
+PAGESIM_API int pagesim_access_batch(struct pagesim *sim, const page_t pages[], int count);
+PAGESIM_API void pagesim_snapshot_stats(struct pagesim *sim, struct pagesim_stats *stats);
+PAGESIM_API int pagesim_reset(struct pagesim *sim);
+PAGESIM_API void pagesim_destroy(struct pagesim *sim);
+
+#endif
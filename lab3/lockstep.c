@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "lockstep.h"
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * lockstep simulates FIFO with many numbers of frames in a single pass over the
+ * references. FIFO is not a stack algorithm, so pagestats would otherwise need a
+ * separate simulation for each number of frames; but when every page is below
+ * LOCKSTEP_MAX_PAGE, the resident sets of up to LOCKSTEP_LANES configurations fit
+ * in one small table, and they can all advance together.
+ *
+ * The table is transposed: rather than a bitmap of resident pages per
+ * configuration, each page has a 64-bit mask with bit c set if configuration c
+ * holds it. Testing whether a reference hits is then one load for every
+ * configuration at once (a 64-lane bit test, done in an ordinary register), and
+ * only the configurations that missed, found from the mask's set bits, have work
+ * to do: each evicts the page at its own ring pointer, clears that page's bit,
+ * and sets the new page's. A hit costs the same however many configurations run.
+ *
+ * The counting rules are those of the engines (see engine_count in policy.h):
+ * references start counting right after a configuration's frame_num-th fault,
+ * which is recorded when it happens, so nothing has to be counted per reference.
+ * The total faults from empty memory are kept too; with them, pagestats points out
+ * Belady's anomaly, when more frames fault more often.
+ *
+ * Usage:
+ *   Compile with another file; there is no main function
+ */
+
+//======================================================//
+
+/*
+ * Function to find the lowest set bit of a mask.
+ *		:param mask: the mask (not 0)
+ * **Returns**: the position of its lowest set bit
+ */
+static int lowest_bit(uint64_t mask) {
+	return __builtin_ctzll(mask);
+}
+
+/*
+ * Function to simulate FIFO with several numbers of frames at once.
+ *		:param arr: an array of pages to be allocated (each below LOCKSTEP_MAX_PAGE)
+ *		:param arr_size: the number of pages to be allocated
+ *		:param frame_nums: the number of frames of each configuration
+ *		:param num_configs: the number of configurations (at most LOCKSTEP_LANES)
+ *		:param stats: an array which will store the number of page faults (index
+ *					  2 * c) and the number of references (index 2 * c + 1) counted
+ *					  by configuration c, as FIFO's engine counts them
+ *		:param totals: an array which will store the total faults of each
+ *					   configuration, from empty memory (or NULL)
+ * **Returns**: 0 on success, -1 if a page is too large or memory could not be
+ *				allocated
+ */
+int fifo_lockstep(page_t arr[], int arr_size, const int frame_nums[], int num_configs,
+				  int stats[], long totals[]) {
+
+	/* initialize local state:
+	 *	- resident: the mask of configurations holding each page
+	 *	- ring/pointer: each configuration's frames, in load order, and the slot it
+	 *					replaces next (only the first LOCKSTEP_MAX_PAGE slots can ever
+	 *					be used, as there are no more distinct pages than that)
+	 *	- faults/filled: each configuration's faults so far, and the position of
+	 *					 its frame_num-th fault (-1 before the first reference,
+	 *					 -2 if it hasn't happened yet)
+	 */
+	uint64_t resident[LOCKSTEP_MAX_PAGE] = { 0 };
+	int pointer[LOCKSTEP_LANES], filled[LOCKSTEP_LANES];
+	long faults[LOCKSTEP_LANES];
+	unsigned char (*ring)[LOCKSTEP_MAX_PAGE] = malloc(num_configs * sizeof(*ring));
+	uint64_t all = (num_configs == LOCKSTEP_LANES) ? ~0ull : (1ull << num_configs) - 1;
+	int i, c;
+
+	if (!ring)
+		return -1;
+	for (i = 0; i < arr_size; i++) {
+		if (arr[i] >= LOCKSTEP_MAX_PAGE) {
+			free(ring);
+			return -1;
+		}
+	}
+	for (c = 0; c < num_configs; c++) {
+		pointer[c] = 0;
+		faults[c] = 0;
+		filled[c] = (frame_nums[c] == 0) ? -1 : -2;
+	}
+
+	/* every configuration that doesn't hold the page faults on it */
+	for (i = 0; i < arr_size; i++) {
+		int page = (int) arr[i];
+		uint64_t missed = ~resident[page] & all;
+
+		while (missed) {
+			c = lowest_bit(missed);
+			missed &= missed - 1;
+
+			if (++faults[c] == frame_nums[c])
+				filled[c] = i;
+			if (frame_nums[c] == 0)
+				continue;
+
+			/* replace the first page in (if the frames are full) with this one */
+			if (faults[c] > frame_nums[c])
+				resident[ring[c][pointer[c]]] &= ~(1ull << c);
+			ring[c][pointer[c]] = (unsigned char) page;
+			resident[page] |= 1ull << c;
+			if (++pointer[c] == frame_nums[c])
+				pointer[c] = 0;
+		}
+	}
+
+	/* counting started after each configuration's frame_num-th fault */
+	for (c = 0; c < num_configs; c++) {
+		if (filled[c] == -2) {
+			stats[2 * c] = stats[2 * c + 1] = 0;
+		}
+		else {
+			stats[2 * c] = (int) (faults[c] - frame_nums[c]);
+			stats[2 * c + 1] = arr_size - (filled[c] + 1);
+		}
+		if (totals)
+			totals[c] = faults[c];
+	}
+
+	free(ring);
+	return 0;
+}
@@ -0,0 +1,12 @@
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include "page.h"
+
+#define LOCKSTEP_MAX_PAGE 256	/* pages must be below this to run in lockstep */
+#define LOCKSTEP_LANES 64		/* most frame counts run at once (one bit each) */
+
+int fifo_lockstep(page_t arr[], int arr_size, const int frame_nums[], int num_configs,
+				  int stats[], long totals[]);
+
+#endif
@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "algorithms.h"
+#include "nodepool.h"
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * nodepool keeps track of the pages a list-based replacement engine knows about
+ * (see adaptive.c and clock.c), whether they are resident or ghosts (pages recently
+ * evicted whose history is still remembered). Each page has a node, found through
+ * a page -> node index (see pagemap.c), and nodes are threaded on doubly linked
+ * lists whose links live in plain arrays, so moving a page between lists is O(1)
+ * and allocates nothing. The engine decides how many nodes it may need at once.
+ *
+ * Usage:
+ *   Compile with another file; there is no main function
+ */
+
+//======================================================//
+
+/*
+ * Function to empty a list.
+ *		:param list: the list
+ */
+void dlist_init(struct dlist *list) {
+	list->head = list->tail = -1;
+	list->size = 0;
+}
+
+/*
+ * Function to add a node as the newest one on a list.
+ *		:param links: links of the list's family
+ *		:param list: the list
+ *		:param node: the node (must not be on a list of the family)
+ */
+void dlist_push(struct links *links, struct dlist *list, int node) {
+	links->prev[node] = -1;
+	links->next[node] = list->head;
+	if (list->head != -1)
+		links->prev[list->head] = node;
+	else
+		list->tail = node;
+	list->head = node;
+	list->size++;
+}
+
+/*
+ * Function to take a node off a list.
+ *		:param links: links of the list's family
+ *		:param list: the list the node is on
+ *		:param node: the node
+ */
+void dlist_remove(struct links *links, struct dlist *list, int node) {
+	if (links->prev[node] != -1)
+		links->next[links->prev[node]] = links->next[node];
+	else
+		list->head = links->next[node];
+	if (links->next[node] != -1)
+		links->prev[links->next[node]] = links->prev[node];
+	else
+		list->tail = links->prev[node];
+	list->size--;
+}
+
+/*
+ * Function to allocate a pool of nodes, all unused.
+ *		:param pool: the pool
+ *		:param size: the most nodes in use at once
+ *		:param span: one more than the largest page (see pagemap_init)
+ * **Returns**: 0 on success, -1 if memory could not be allocated
+ */
+int pool_init(struct node_pool *pool, int size, page_t span) {
+	int i;
+	pool->page = malloc(size * sizeof(page_t));
+	pool->slot = malloc(size * sizeof(int));
+	pool->where = malloc(size * sizeof(int));
+	pool->links.prev = malloc(size * sizeof(int));
+	pool->links.next = malloc(size * sizeof(int));
+	pool->free = malloc(size * sizeof(int));
+	if (!pool->page || !pool->slot || !pool->where || !pool->links.prev ||
+		!pool->links.next || !pool->free || pagemap_init(&pool->index, size, span) != 0)
+		return -1;
+
+	for (i = 0; i < size; i++)
+		pool->free[i] = size - 1 - i;
+	pool->num_free = size;
+	return 0;
+}
+
+/*
+ * Function to start tracking a page with an unused node.
+ *		:param pool: the pool
+ *		:param page: the page
+ * **Returns**: the node
+ */
+int node_new(struct node_pool *pool, page_t page) {
+	int node = pool->free[--pool->num_free];
+	pool->page[node] = page;
+	pool->slot[node] = -1;
+	pagemap_put(&pool->index, page, node);
+	return node;
+}
+
+/*
+ * Function to stop tracking a node's page (the node must be off every list).
+ *		:param pool: the pool
+ *		:param node: the node
+ */
+void node_free(struct node_pool *pool, int node) {
+	pagemap_remove(&pool->index, pool->page[node]);
+	pool->free[pool->num_free++] = node;
+}
+
+/*
+ * Function to release a pool.
+ *		:param pool: the pool
+ */
+void pool_destroy(struct node_pool *pool) {
+	pagemap_destroy(&pool->index);
+	free(pool->page);
+	free(pool->slot);
+	free(pool->where);
+	free(pool->links.prev);
+	free(pool->links.next);
+	free(pool->free);
+}
+
+/*
+ * Function to put a page into a frame slot.
+ *		:param engine: the engine
+ *		:param pool: the engine's nodes
+ *		:param node: the node of the page
+ *		:param slot: the frame slot
+ */
+void load_page(struct engine *engine, struct node_pool *pool, int node, int slot) {
+	pool->slot[node] = slot;
+	engine->frames[slot] = pool->page[node];
+	engine->slot = slot;
+}
+
+/*
+ * Function to take the frame slot from a page being evicted.
+ *		:param pool: the engine's nodes
+ *		:param node: the node of the page
+ * **Returns**: the slot the page was in
+ */
+int unload_page(struct node_pool *pool, int node) {
+	int slot = pool->slot[node];
+	pool->slot[node] = -1;
+	return slot;
+}
+
+/*
+ * Function to allocate an engine with a pool of nodes (every other field of the
+ * engine's struct zeroed).
+ *		:param size: the size of the engine's struct
+ *		:param pool_offset: where the engine's pool is within that struct
+ *		:param pool_size: the most nodes the engine tracks at once
+ *		:param arr: an array of pages to be allocated
+ *		:param arr_size: the number of pages to be allocated
+ *		:param frame_num: the number of frames in physical memory
+ * **Returns**: the engine, its shared state set up (see engine_init), or NULL if
+ *				memory could not be allocated
+ */
+struct engine * pool_engine_new(size_t size, size_t pool_offset, int pool_size,
+								page_t arr[], int arr_size, int frame_num) {
+	struct engine *engine = calloc(1, size);
+	struct node_pool *pool;
+	if (!engine)
+		return NULL;
+	pool = (struct node_pool *) ((char *) engine + pool_offset);
+	if (pool_init(pool, pool_size, page_span(arr, arr_size)) != 0 ||
+		engine_init(engine, frame_num) != 0) {
+		pool_destroy(pool);
+		engine_free(engine);
+		free(engine);
+		return NULL;
+	}
+	return engine;
+}
@@ -0,0 +1,45 @@
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <stddef.h>
+#include "page.h"
+#include "pagemap.h"
+#include "policy.h"
+
+/* links of a family of doubly linked lists over node ids; -1 ends a list */
+struct links {
+	int *prev;		/* node on the newer side of each node */
+	int *next;		/* node on the older side of each node */
+};
+
+/* one list of nodes, from its newest (head) to its oldest (tail) node */
+struct dlist {
+	int head;		/* newest node, or -1 if the list is empty */
+	int tail;		/* oldest node, or -1 if the list is empty */
+	int size;		/* number of nodes on the list */
+};
+
+/* the nodes of one engine: the pages it tracks, resident or ghost */
+struct node_pool {
+	page_t *page;		/* page tracked by each node */
+	int *slot;			/* frame slot holding the node's page, or -1 for a ghost */
+	int *where;			/* list (or status) the node is on; meaning depends on the engine */
+	struct links links;	/* links of the lists the nodes are on */
+	int *free;			/* stack of unused nodes */
+	int num_free;
+	struct pagemap index;	/* page -> node of every tracked page */
+};
+
+void dlist_init(struct dlist *list);
+void dlist_push(struct links *links, struct dlist *list, int node);
+void dlist_remove(struct links *links, struct dlist *list, int node);
+int pool_init(struct node_pool *pool, int size, page_t span);
+int node_new(struct node_pool *pool, page_t page);
+void node_free(struct node_pool *pool, int node);
+void pool_destroy(struct node_pool *pool);
+void load_page(struct engine *engine, struct node_pool *pool, int node, int slot);
+int unload_page(struct node_pool *pool, int node);
+struct engine * pool_engine_new(size_t size, size_t pool_offset, int pool_size,
+								page_t arr[], int arr_size, int frame_num);
+
+#endif
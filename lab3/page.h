@@ -0,0 +1,13 @@
+#ifndef PAGE_H
+#define PAGE_H
+
+#include <stdint.h>
+#include <inttypes.h>
+
+/* a page number: any 64-bit virtual page number except PAGE_NONE */
+typedef uint64_t page_t;
+
+#define PAGE_NONE UINT64_MAX	/* marks an unallocated frame */
+#define PRIpage PRIu64			/* printf conversion for a page_t */
+
+#endif
@@ -0,0 +1,436 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "policy.h"
+#include "workload.h"
+
+#define BENCH_BLOCK 1024		/* references timed together as one sample */
+#define BENCH_MAX_GRID 16		/* most values in each dimension of the grid */
+#define BENCH_SEED 201			/* seed of the reference strings, so runs compare */
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * pagebench times the page replacement policies, to tell when a change to one of
+ * them slows down its loop. It runs each policy over a grid of trace lengths, page
+ * ranges and numbers of frames; each reference string is uniformly distributed
+ * (see workload.c) and generated from a fixed seed, so every run of pagebench times
+ * exactly the same work.
+ *
+ * Each combination is first simulated a few times untimed, to warm the caches and
+ * the branch predictors, then simulated a number of times more with the clock
+ * read every BENCH_BLOCK references (handing each block to the engine's
+ * access_batch, as simulate does). Each block gives one sample of the nanoseconds
+ * per reference; the median and the 99th percentile of the samples of every
+ * repetition are reported. Setting up and releasing the engine aren't timed.
+ * The reference strings are all reads, so a policy that acts on writes (cflru,
+ * wsclock; see struct policy) is timed on its read path, and pagebench says so.
+ *
+ * The results are written as JSON, one combination per line:
+ *
+ *   {"policy": "lru", "length": 100000, "range": 100, "frames": 10,
+ *    "faults": 90021, "median_ns": 21.503, "p99_ns": 25.887}
+ *
+ * With -c, the results are also compared with those of an earlier run (a file
+ * pagebench wrote), and every combination whose median grew by more than the
+ * threshold is flagged; pagebench then exits with status 2. `make bench` builds
+ * pagebench with optimization and runs it (with BASELINE=file, comparing).
+ *
+ * Usage:
+ *   pagebench [-n lengths] [-r ranges] [-f frames] [-w warmups] [-k repetitions]
+ *             [-o output] [-c baseline] [-t threshold] [algo ...]
+ *
+ * pagebench accepts only optional arguments
+ * -n - trace lengths, separated by commas (default 10000,100000)
+ * -r - page ranges, separated by commas (default 10,100,1000)
+ * -f - numbers of frames, separated by commas (default 3,10,30,100); those
+ *      above a policy's limit are skipped for it
+ * -w - untimed runs before the timed ones (default 2)
+ * -k - timed runs (default 10)
+ * -o - the name of the JSON file to write (default bench.json)
+ * -c - the name of a JSON file from an earlier run to compare against (not the
+ *      output)
+ * -t - the percentage a median may grow by before it is flagged (default 10)
+ * algo - registered policies to time, in order (see policy.c); defaults to
+ *        lru fifo extra
+ */
+
+//======================================================//
+const char * usage = "Usage:"
+"   pagebench [-n lengths] [-r ranges] [-f frames] [-w warmups] [-k repetitions]\n"
+"             [-o output] [-c baseline] [-t threshold] [algo ...]\n"
+"\n"
+"pagebench accepts only optional arguments\n"
+"-n - trace lengths, separated by commas (default 10000,100000)\n"
+"-r - page ranges, separated by commas (default 10,100,1000)\n"
+"-f - numbers of frames, separated by commas (default 3,10,30,100); those\n"
+"     above a policy's limit are skipped for it\n"
+"-w - untimed runs before the timed ones (default 2)\n"
+"-k - timed runs (default 10)\n"
+"-o - the name of the JSON file to write (default bench.json)\n"
+"-c - the name of a JSON file from an earlier run to compare against (not the\n"
+"     output)\n"
+"-t - the percentage a median may grow by before it is flagged (default 10)\n"
+"algo - registered policies to time, in order (lru, fifo, extra, fastlru,\n"
+"       fastextra, arc, 2q, lirs, clock, gclock, clockpro, wsclock, ws, pff, or cflru);\n"
+"       defaults to lru fifo extra\n"
+"\n";
+//======================================================//
+
+/* the timing of one (policy, length, range, frames) combination */
+struct result {
+	char policy[32];
+	long length;
+	long range;
+	long frames;
+	int faults;			/* faults counted, so runs can be checked for the same work */
+	double median_ns;	/* median nanoseconds per reference, over every block */
+	double p99_ns;		/* 99th percentile of the same */
+};
+
+/*
+ * Function to read a list of positive numbers separated by commas.
+ *		:param spec: the list (e.g., "3,10,30")
+ *		:param values: where to store the numbers (room for BENCH_MAX_GRID)
+ * **Returns**: how many numbers were read, or 0 if the list is not valid
+ */
+int parse_list(const char *spec, long values[]) {
+	int count = 0;
+	char *end;
+
+	while (count < BENCH_MAX_GRID) {
+		values[count] = strtol(spec, &end, 10);
+		if (end == spec || values[count] < 1)
+			return 0;
+		count++;
+		if (*end == '\0')
+			return count;
+		if (*end != ',')
+			return 0;
+		spec = end + 1;
+	}
+	return 0;
+}
+
+/*
+ * Function to read the monotonic clock.
+ * **Returns**: the time, in nanoseconds
+ */
+double now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/*
+ * Function to compare two doubles, for qsort.
+ */
+int compare_doubles(const void *a, const void *b) {
+	double x = *(const double *) a, y = *(const double *) b;
+	return (x > y) - (x < y);
+}
+
+/*
+ * Function to time one policy over one reference string, storing the median and
+ * 99th percentile of its nanoseconds per reference.
+ *		:param policy: the policy to time
+ *		:param arr: the reference string
+ *		:param arr_size: the number of references
+ *		:param frame_num: the number of frames to simulate
+ *		:param warmups: the number of untimed runs
+ *		:param reps: the number of timed runs
+ *		:param res: where to store the timing (and the faults counted)
+ */
+void time_policy(const struct policy *policy, page_t arr[], int arr_size, int frame_num,
+				 int warmups, int reps, struct result *res) {
+	int blocks = (arr_size + BENCH_BLOCK - 1) / BENCH_BLOCK;
+	double *samples = malloc((long) blocks * reps * sizeof(double));
+	int run, b, count, stats[2], num_samples = 0;
+	struct engine *engine;
+	double start;
+
+	if (!samples) {
+		printf("Error: cannot allocate memory for %d samples\n", blocks * reps);
+		exit(1);
+	}
+
+	for (run = 0; run < warmups + reps; run++) {
+		engine = engine_new(policy, arr, arr_size, frame_num);
+		for (b = 0; b < blocks; b++) {
+			count = (arr_size - b * BENCH_BLOCK < BENCH_BLOCK) ? arr_size - b * BENCH_BLOCK : BENCH_BLOCK;
+			start = now_ns();
+			policy->access_batch(engine, arr + b * BENCH_BLOCK, count);
+			if (run >= warmups)
+				samples[num_samples++] = (now_ns() - start) / count;
+		}
+		policy->stats(engine, stats);
+		policy->destroy(engine);
+	}
+
+	/* nearest-rank percentiles of the samples */
+	qsort(samples, num_samples, sizeof(double), compare_doubles);
+	res->faults = stats[0];
+	res->median_ns = samples[(num_samples - 1) / 2];
+	res->p99_ns = samples[(int) (0.99 * num_samples + 0.999999) - 1];
+	free(samples);
+}
+
+/*
+ * Function to write one result as a line of JSON.
+ *		:param fp: the file to write to
+ *		:param res: the result
+ *		:param last: "boolean"; no comma after it, as it is the last of the list
+ */
+void write_result(FILE *fp, const struct result *res, int last) {
+	fprintf(fp, "    {\"policy\": \"%s\", \"length\": %ld, \"range\": %ld, \"frames\": %ld, "
+			"\"faults\": %d, \"median_ns\": %.3f, \"p99_ns\": %.3f}%s\n",
+			res->policy, res->length, res->range, res->frames, res->faults,
+			res->median_ns, res->p99_ns, last ? "" : ",");
+}
+
+/*
+ * Function to read the results of an earlier run from the JSON file pagebench
+ * wrote (one result per line; other lines are skipped).
+ *		:param file_name: the name of the file
+ *		:param count: where to store the number of results
+ * **Returns**: the results (to be freed by the caller), or NULL if the file can't
+ *				be read
+ */
+struct result * read_results(const char *file_name, int *count) {
+	FILE *fp = fopen(file_name, "r");
+	struct result *res = NULL, *grown, r;
+	int capacity = 0;
+	char line[512];
+
+	*count = 0;
+	if (!fp)
+		return NULL;
+	while (fgets(line, sizeof(line), fp)) {
+		if (sscanf(line, " {\"policy\": \"%31[^\"]\", \"length\": %ld, \"range\": %ld, "
+				   "\"frames\": %ld, \"faults\": %d, \"median_ns\": %lf, \"p99_ns\": %lf}",
+				   r.policy, &r.length, &r.range, &r.frames, &r.faults, &r.median_ns,
+				   &r.p99_ns) != 7)
+			continue;
+		if (*count == capacity) {
+			capacity = capacity ? 2 * capacity : 64;
+			if (!(grown = realloc(res, capacity * sizeof(struct result)))) {
+				printf("Error: cannot allocate memory for %d results\n", capacity);
+				exit(1);
+			}
+			res = grown;
+		}
+		res[(*count)++] = r;
+	}
+	fclose(fp);
+	if (!res)
+		res = malloc(sizeof(struct result));
+	return res;
+}
+
+/*
+ * Function to compare the results of this run with those of an earlier one, and
+ * print how each median changed.
+ *		:param res: the results of this run
+ *		:param count: the number of them
+ *		:param base: the results of the earlier run
+ *		:param base_count: the number of them
+ *		:param threshold: the percentage a median may grow by before it is flagged
+ * **Returns**: the number of results flagged
+ */
+int compare_results(const struct result res[], int count, const struct result base[],
+					int base_count, double threshold) {
+	int i, j, flagged = 0;
+	double change;
+
+	printf("\n%-10s %9s %7s %7s %12s %12s %9s\n", "policy", "length", "range", "frames",
+		   "base ns/ref", "now ns/ref", "change");
+	for (i = 0; i < count; i++) {
+		for (j = 0; j < base_count; j++) {
+			if (strcmp(res[i].policy, base[j].policy) == 0 && res[i].length == base[j].length &&
+				res[i].range == base[j].range && res[i].frames == base[j].frames)
+				break;
+		}
+		if (j == base_count)
+			continue;
+
+		change = (res[i].median_ns / base[j].median_ns - 1) * 100;
+		printf("%-10s %9ld %7ld %7ld %12.3f %12.3f %+8.1f%%", res[i].policy, res[i].length,
+			   res[i].range, res[i].frames, base[j].median_ns, res[i].median_ns, change);
+		if (change > threshold) {
+			printf("  REGRESSION");
+			flagged++;
+		}
+		if (res[i].faults != base[j].faults)
+			printf("  (faults %d, were %d)", res[i].faults, base[j].faults);
+		printf("\n");
+	}
+	return flagged;
+}
+
+/*
+ * Main function for the pagebench application. This function reads the options,
+ * times every (policy, length, range, frames) combination of the grid, writes
+ * the results, and compares them with a baseline if one was given.
+ */
+int main(int argc, char *argv[]) {
+
+	long lengths[BENCH_MAX_GRID] = { 10000, 100000 };
+	long ranges[BENCH_MAX_GRID] = { 10, 100, 1000 };
+	long frames[BENCH_MAX_GRID] = { 3, 10, 30, 100 };
+	int num_lengths = 2, num_ranges = 3, num_frames = 4;
+	int warmups = 2, reps = 10, opt;
+	char *output = "bench.json", *baseline = NULL;
+	double threshold = 10;
+
+	/* checking the options from the command line */
+	while ((opt = getopt(argc, argv, "n:r:f:w:k:o:c:t:")) != -1) {
+		if (opt == 'n')
+			num_lengths = parse_list(optarg, lengths);
+		else if (opt == 'r')
+			num_ranges = parse_list(optarg, ranges);
+		else if (opt == 'f')
+			num_frames = parse_list(optarg, frames);
+		else if (opt == 'w')
+			warmups = atoi(optarg);
+		else if (opt == 'k')
+			reps = atoi(optarg);
+		else if (opt == 'o')
+			output = optarg;
+		else if (opt == 'c')
+			baseline = optarg;
+		else if (opt == 't')
+			threshold = atof(optarg);
+		else {
+			printf("Error: Invalid option.\n\n%s", usage);
+			exit(1);
+		}
+	}
+	if (num_lengths == 0 || num_ranges == 0 || num_frames == 0) {
+		printf("Error: Invalid list of lengths, ranges or frames (at most %d positive "
+			   "numbers, separated by commas).\n\n%s", BENCH_MAX_GRID, usage);
+		exit(1);
+	}
+	if (warmups < 0 || reps < 1) {
+		printf("Error: Invalid number of warm-up or timed runs.\n\n%s", usage);
+		exit(1);
+	}
+
+	/* read the baseline now, since writing the results over it would compare the run
+	 * with itself */
+	struct result *base = NULL;
+	struct stat out_info, base_info;
+	int base_count = 0;
+	if (baseline) {
+		if (stat(output, &out_info) == 0 && stat(baseline, &base_info) == 0 &&
+			out_info.st_dev == base_info.st_dev && out_info.st_ino == base_info.st_ino) {
+			printf("Error: %s and %s are the same file.\n", baseline, output);
+			exit(1);
+		}
+		if (!(base = read_results(baseline, &base_count))) {
+			printf("Error: cannot open file %s for reading.\n", baseline);
+			exit(1);
+		}
+	}
+
+	/* the policies to time: those named, or LRU, FIFO and extra */
+	const char *default_algos[] = { "lru", "fifo", "extra" };
+	const char **algo_names = default_algos;
+	int num_algos = 3, a;
+	if (optind < argc) {
+		algo_names = (const char **) argv + optind;
+		num_algos = argc - optind;
+	}
+	const struct policy **algos = malloc(num_algos * sizeof(struct policy *));
+	if (!algos) {
+		printf("Error: cannot allocate memory for %d algorithms\n", num_algos);
+		exit(1);
+	}
+	for (a = 0; a < num_algos; a++) {
+		if (!(algos[a] = find_policy(algo_names[a]))) {
+			printf("Error: unknown algorithm %s; expected one of ", algo_names[a]);
+			print_policy_names();
+			printf("\n\n%s", usage);
+			exit(1);
+		}
+		if (algos[a]->writes)
+			printf("Note: %s acts on writes, and is timed here on references that "
+				   "are all reads.\n", algos[a]->name);
+	}
+
+	int max_results = num_algos * num_lengths * num_ranges * num_frames, count = 0;
+	struct result *res = malloc(max_results * sizeof(struct result));
+	if (!res) {
+		printf("Error: cannot allocate memory for %d results\n", max_results);
+		exit(1);
+	}
+
+	/* time every combination, a reference string at a time */
+	struct workload workload;
+	int l, r, f;
+	for (l = 0; l < num_lengths; l++) {
+		page_t *arr = malloc(lengths[l] * sizeof(page_t));
+		if (!arr) {
+			printf("Error: cannot allocate memory for %ld page references\n", lengths[l]);
+			exit(1);
+		}
+		for (r = 0; r < num_ranges; r++) {
+			if (workload_parse(&workload, "uniform", ranges[r], lengths[l], BENCH_SEED) != 0) {
+				printf("\n%s", usage);
+				exit(1);
+			}
+			workload_fill(&workload, 0, lengths[l], 0, arr);
+
+			for (a = 0; a < num_algos; a++) {
+				for (f = 0; f < num_frames; f++) {
+					if (frames[f] > algos[a]->max_frames)
+						continue;
+					strncpy(res[count].policy, algos[a]->name, sizeof(res[count].policy) - 1);
+					res[count].policy[sizeof(res[count].policy) - 1] = '\0';
+					res[count].length = lengths[l];
+					res[count].range = ranges[r];
+					res[count].frames = frames[f];
+					time_policy(algos[a], arr, lengths[l], frames[f], warmups, reps, &res[count]);
+					printf("%-10s length %9ld  range %7ld  frames %7ld  median %9.3f ns/ref"
+						   "  p99 %9.3f ns/ref\n", res[count].policy, lengths[l], ranges[r],
+						   frames[f], res[count].median_ns, res[count].p99_ns);
+					count++;
+				}
+			}
+		}
+		free(arr);
+	}
+
+	/* write the results */
+	FILE *fp = fopen(output, "w");
+	int i;
+	if (!fp) {
+		printf("Error: cannot create file %s\n", output);
+		exit(1);
+	}
+	fprintf(fp, "{\n  \"warmups\": %d,\n  \"repetitions\": %d,\n  \"block\": %d,\n"
+			"  \"results\": [\n", warmups, reps, BENCH_BLOCK);
+	for (i = 0; i < count; i++)
+		write_result(fp, &res[i], i == count - 1);
+	fprintf(fp, "  ]\n}\n");
+	if (fclose(fp) != 0) {
+		printf("Error: cannot write file %s\n", output);
+		exit(1);
+	}
+
+	/* compare them with the baseline, if there is one */
+	int flagged = 0;
+	if (base) {
+		flagged = compare_results(res, count, base, base_count, threshold);
+		printf("\n%d of %d medians grew by more than %.1f%%\n", flagged, count, threshold);
+		free(base);
+	}
+
+	free(res);
+	free(algos);
+	return (flagged > 0) ? 2 : 0;
+}
@@ -2,6 +2,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
+#include "trace.h"
+#include "workload.h"
+#include "workpool.h"
+
+#define SHARD_PAGES (4 * TRACE_INDEX_STRIDE)	/* references generated per job */
 
 /* 
  * Author: Joanna Klukowska
@@ -12,13 +18,31 @@
  * random page numbers univformly distributed between 0 and the range
  * minus 1. No page number in the sequence is ever equal to the number
  * that preceeds it in the sequence. 
+ * With -m, the pages follow a workload with locality instead: Zipfian
+ * popularity, phase-changing working sets, sequential or looping scans,
+ * or a weighted mixture of these (see workload.c for the descriptions).
+ * The random numbers come from a counter-based generator, so the trace
+ * is cut into shards that are generated, encoded and written (each at
+ * its own offset in the file) on -j threads, and the output for a
+ * given seed is the same whatever the thread count.
+ * With -w, that share of the references write their page (marked w in
+ * a text trace, and in a bitmap in a binary one; see trace.c).
  * 
  * Usage:
- *   pagegenerator range count file [seed]
+ *   pagegenerator [-f format] [-m workload] [-w ratio] [-j threads] range count file [seed]
  *
  * pagegenerator accepts four command-line arguments in the
  * following order:
- * range - the range of page references (maximum 100)
+ * -f    - (optional) output format: text (default), or one of the
+ *         binary trace formats fixed, fixed32 or varint (see trace.c)
+ * -m    - (optional) workload: uniform (default), zipf[:s],
+ *         phase[:size[:period]], seq[:run], loop[:length], or several
+ *         of these with @weight, separated by commas
+ * -w    - (optional) share of the references that are writes,
+ *         from 0 (default) to 1
+ * -j    - (optional) number of threads to generate the trace on
+ *         (0 = one per CPU)
+ * range - the range of page references (any 64-bit number)
  * count - the length of sequence to be generated
  * file  - the name of the output file that will be generated
  * seed  - (optional) the seed to be used for the random number
@@ -29,11 +53,20 @@
 
 
 const char * usage = "Usage:"
-"   pagegenerator range count file [seed]\n"
+"   pagegenerator [-f format] [-m workload] [-w ratio] [-j threads] range count file [seed]\n"
 "\n"
 "pagegenerator accepts four command-line arguments in the\n"
 "following order:\n"
-"range - the range of page references (maximum 100)\n"
+"-f    - (optional) output format: text (default), or one of the\n"
+"        binary trace formats fixed, fixed32 or varint\n"
+"-m    - (optional) workload: uniform (default), zipf[:s],\n"
+"        phase[:size[:period]], seq[:run], loop[:length], or several\n"
+"        of these with @weight, separated by commas (e.g. zipf@9,loop:500@1)\n"
+"-w    - (optional) share of the references that are writes,\n"
+"        from 0 (default) to 1\n"
+"-j    - (optional) number of threads to generate the trace on\n"
+"        (0 = one per CPU)\n"
+"range - the range of page references (any 64-bit number)\n"
 "count - the length of sequence to be generated            \n"
 "file  - the name of the output file that will be generated     \n"
 "seed  - (optional) the seed to be used for the random number   \n"
@@ -43,25 +76,122 @@ const char * usage = "Usage:"
 
 
 
+/***************************************************************/
+/* One chunk of the trace, cut into shards of SHARD_PAGES references
+ * that are generated, encoded, and then written, as separate jobs. */
+struct chunk {
+	const struct workload * workload;
+	int encoding;		/*format of the output file */
+	long start;			/*position of the chunk's first reference */
+	int num_pages;		/*references in the chunk */
+	page_t * pages;		/*the references */
+	unsigned char * writes;	/*whether each reference writes (NULL if none do) */
+	unsigned char ** bytes;	/*each shard, encoded */
+	long * len;			/*bytes in each encoded shard (or an error) */
+	const struct trace_writer * writer;	/*the output file */
+	long * at;			/*where each shard goes in it */
+	int * failed;		/*whether writing each shard failed */
+};
+
+/* Number of references in one shard of a chunk. */
+int shard_size(struct chunk * chunk, int shard)
+{
+	int left = chunk->num_pages - shard * SHARD_PAGES;
+	return (left < SHARD_PAGES) ? left : SHARD_PAGES;
+}
+
+/* The page before reference i, as a shard generated on its own has
+ * to guess it: the first candidate for it (page 0 before the first). */
+page_t guess_previous(const struct workload * workload, long i)
+{
+	return (i == 0) ? 0 : workload_page(workload, i - 1, 0);
+}
+
+/* Job that generates one shard of a chunk. */
+void generate_shard(void * ctx, int shard)
+{
+	struct chunk * chunk = ctx;
+	long first = chunk->start + (long) shard * SHARD_PAGES;
+	workload_fill(chunk->workload, first, shard_size(chunk, shard),
+				  guess_previous(chunk->workload, first),
+				  chunk->pages + (long) shard * SHARD_PAGES);
+	if (chunk->writes)
+		workload_fill_writes(chunk->workload, first, shard_size(chunk, shard),
+							 chunk->writes + (long) shard * SHARD_PAGES);
+}
+
+/* Job that encodes one shard of a chunk in the output format. */
+void encode_shard(void * ctx, int shard)
+{
+	struct chunk * chunk = ctx;
+	chunk->len[shard] = trace_encode(chunk->encoding,
+									 chunk->pages + (long) shard * SHARD_PAGES,
+									 chunk->writes ? chunk->writes + (long) shard * SHARD_PAGES : NULL,
+									 shard_size(chunk, shard), chunk->bytes[shard]);
+}
+
+/* Job that writes one encoded shard at its place in the output file. */
+void write_shard(void * ctx, int shard)
+{
+	struct chunk * chunk = ctx;
+	chunk->failed[shard] = trace_writer_write_at(chunk->writer, chunk->bytes[shard],
+												 chunk->len[shard], chunk->at[shard]) != 0;
+}
+
 /***************************************************************/
 int main(int argc, char * argv[])
 {
 	int seed = time(NULL);	/*seed for the random number generator*/
-	FILE *fp;   /*output file */
-	int range;	/*range of page references (max 100) */
+	struct trace_writer writer;   /*output file */
+	int encoding = TRACE_TEXT;	/*format of the output file */
+	int opt;
+	char * workload_spec = "uniform";	/*description of the workload */
+	struct workload workload;	/*the workload it describes */
+	int num_threads = 1;	/*threads to generate the trace on */
+	double write_ratio = 0;	/*share of the references that are writes */
+	page_t range;	/*range of page references */
+	char * end;
 	int count;	/*length of sequence to be generated */
 	char file_name [256]; /*name of the output file*/
 	
 	
-	/* Checking the input from the command line */
+	/* Checking the options, then the rest of the input from the command line */
+	while ((opt = getopt(argc, argv, "f:m:w:j:")) != -1) {
+		if (opt == 'm') {
+			workload_spec = optarg;
+		}
+		else if (opt == 'w') {
+			write_ratio = strtod(optarg, &end);
+			if (end == optarg || *end != '\0' || !(write_ratio >= 0 && write_ratio <= 1)) {
+				printf("Error: write ratio must be between 0 and 1; received %s\n", optarg);
+				exit(1);
+			}
+		}
+		else if (opt == 'j') {
+			num_threads = atoi(optarg);
+			if (num_threads == 0)
+				num_threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+			if (num_threads < 1) {
+				printf("Error: number of threads must be a positive integer; received %s\n", optarg);
+				exit(1);
+			}
+		}
+		else if (opt != 'f' || (encoding = trace_encoding(optarg)) == -2) {
+			printf("Error: Invalid format specification.\n\n%s", usage);
+			exit(1);
+		}
+	}
+	argv += optind - 1;
+	argc -= optind - 1;
+
 	if(argc < 4 ) 	{
 		printf("Error: Invalid number of paramters.\n\n%s", usage);
 		exit(1);
 	}
 	
 	/* Get the values of range, count, file name and seed */
-	range = atoi(argv[1]);
-	if (range > 100 || range < 1 )	{
+	range = strtoull(argv[1], &end, 10);
+	if (*end != '\0' || argv[1][0] == '-' || range < 1 || range > PAGE_NONE - 1)	{
 		printf("Error: Invalid range specification.\n\n%s", usage);
 		exit(1);
 	}
@@ -70,35 +200,113 @@ int main(int argc, char * argv[])
 		printf("Error: Invalid count specification.\n\n%s", usage);
 		exit(1);
 	}
-	strncpy (file_name, argv[3], 256);
+	strncpy (file_name, argv[3], sizeof(file_name) - 1);
+	file_name[sizeof(file_name) - 1] = '\0';
 	if (argc >= 5 )
 		seed = atoi(argv[4]);
+	if (workload_parse(&workload, workload_spec, range, count, (uint64_t) seed) != 0) {
+		printf("\n%s", usage);
+		exit(1);
+	}
+	workload.write_ratio = write_ratio;
 		
 	/* Create the output file */
-	fp = fopen(file_name, "w");
-	if(!fp)
+	if (trace_writer_open(&writer, file_name, encoding) != 0)
 	{
 		printf("Error: cannot create file %s\n", file_name);
 		exit(1);
 	}
 
-	/* Start random number generator with a given seed */
-	srand(seed);
-	
-	/* Write a random sequence to the output file */
-	int i = 0;
-	int current=0, previous=0;
-	for (i = 0; i < count; i++ ) {
-		current = random()%range;
-		/* make sure we do not have repeated values */
-		while (current == previous) 
-			current = random()%range;
-		previous = current;
-		/* write value of current to the output file */
-		fprintf ( fp, "%d ", current);
+	/* Set up a chunk with two shards per thread (so idle threads can steal) */
+	struct chunk chunk;
+	int num_shards = 2 * num_threads, i, shard;
+	long * cost = malloc(num_shards * sizeof(long));
+	chunk.workload = &workload;
+	chunk.encoding = encoding;
+	chunk.pages = malloc((long) num_shards * SHARD_PAGES * sizeof(page_t));
+	chunk.writes = (write_ratio > 0) ? malloc((long) num_shards * SHARD_PAGES) : NULL;
+	chunk.bytes = malloc(num_shards * sizeof(unsigned char *));
+	chunk.len = malloc(num_shards * sizeof(long));
+	chunk.writer = &writer;
+	chunk.at = malloc(num_shards * sizeof(long));
+	chunk.failed = malloc(num_shards * sizeof(int));
+	if (!cost || !chunk.pages || !chunk.bytes || !chunk.len || !chunk.at || !chunk.failed ||
+		(write_ratio > 0 && !chunk.writes)) {
+		printf("Error: cannot allocate memory for %d threads\n", num_threads);
+		exit(1);
+	}
+	for (i = 0; i < num_shards; i++) {
+		cost[i] = 1;
+		if (!(chunk.bytes[i] = malloc((long) SHARD_PAGES * TRACE_MAX_ENCODED))) {
+			printf("Error: cannot allocate memory for %d threads\n", num_threads);
+			exit(1);
+		}
+	}
+
+	/* Write the sequence to the output file a chunk at a time */
+	page_t previous = 0;	/*the page before the chunk */
+	for (chunk.start = 0; chunk.start < count; chunk.start += chunk.num_pages) {
+		chunk.num_pages = (count - chunk.start < (long) num_shards * SHARD_PAGES) ?
+						  count - chunk.start : num_shards * SHARD_PAGES;
+		int shards = (chunk.num_pages + SHARD_PAGES - 1) / SHARD_PAGES;
+
+		if (run_jobs(shards, cost, num_threads, generate_shard, &chunk) != 0) {
+			printf("Error: cannot start %d threads\n", num_threads);
+			exit(1);
+		}
+
+		/* each shard guessed at the page before it: make sure we do not
+		 * have repeated values where a guess was wrong, in order */
+		for (shard = 0; shard < shards; shard++) {
+			long first = chunk.start + (long) shard * SHARD_PAGES;
+			page_t before = (shard == 0) ? previous : chunk.pages[first - chunk.start - 1];
+			if (before != guess_previous(&workload, first))
+				workload_refill(&workload, first, shard_size(&chunk, shard), before,
+								chunk.pages + (long) shard * SHARD_PAGES);
+		}
+		previous = chunk.pages[chunk.num_pages - 1];
+
+		/* encode the shards, give each one its place in the file after
+		 * the ones before it, then write them all there at once */
+		if (run_jobs(shards, cost, num_threads, encode_shard, &chunk) != 0) {
+			printf("Error: cannot start %d threads\n", num_threads);
+			exit(1);
+		}
+		for (shard = 0; shard < shards; shard++) {
+			if (chunk.len[shard] < 0 ||
+				(chunk.at[shard] = trace_writer_place(&writer, chunk.bytes[shard], chunk.len[shard],
+													  shard_size(&chunk, shard),
+													  chunk.writes ? chunk.writes + (long) shard * SHARD_PAGES : NULL)) < 0) {
+				printf("Error: cannot write file %s\n", file_name);
+				exit(1);
+			}
+		}
+		if (run_jobs(shards, cost, num_threads, write_shard, &chunk) != 0) {
+			printf("Error: cannot start %d threads\n", num_threads);
+			exit(1);
+		}
+		for (shard = 0; shard < shards; shard++) {
+			if (chunk.failed[shard]) {
+				printf("Error: cannot write file %s\n", file_name);
+				exit(1);
+			}
+		}
+	}
+
+	if (trace_writer_close(&writer) != 0) {
+		printf("Error: cannot write file %s\n", file_name);
+		exit(1);
 	}
 
-	fclose ( fp );
+	for (i = 0; i < num_shards; i++)
+		free(chunk.bytes[i]);
+	free(chunk.bytes);
+	free(chunk.len);
+	free(chunk.at);
+	free(chunk.failed);
+	free(chunk.pages);
+	free(chunk.writes);
+	free(cost);
 	
 	return 0;
 
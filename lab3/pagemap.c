@@ -0,0 +1,225 @@
+#include <stdlib.h>
+#include "pagemap.h"
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * pagemap maps a 64-bit page number to an int value. The page replacement
+ * algorithms use it as a residency index (page -> frame slot), so checking whether
+ * a page is in memory costs O(1) instead of a scan over every frame, however large
+ * the page numbers are. When the page numbers are dense (a small range, or one not
+ * much bigger than the number of pages stored), the low pages are indexed directly
+ * by a plain array. Every other page goes to an open-addressing hash table:
+ * collisions are resolved with linear probing, and removals use backward-shift
+ * deletion so no tombstones build up over a long simulation. The table doubles in
+ * size whenever it becomes more than half full.
+ *
+ * Usage:
+ *   Compile with another file; there is no main function
+ */
+
+//======================================================//
+
+/*
+ * Function to compute the home bucket of a page (Fibonacci hashing).
+ *		:param map: the map the page belongs to
+ *		:param page: the page to hash
+ * **Returns**: the index of the bucket the page would ideally be stored in
+ */
+static size_t home_bucket(struct pagemap *map, page_t page) {
+	return (size_t) ((page * 0x9e3779b97f4a7c15ull) >> map->shift);
+}
+
+/*
+ * Function to allocate an empty set of hash buckets.
+ *		:param map: the map to set up
+ *		:param capacity: the expected maximum number of pages stored in the buckets
+ * **Returns**: 0 on success, -1 if memory could not be allocated
+ */
+static int init_buckets(struct pagemap *map, size_t capacity) {
+
+	/* keep the load factor at or below 1/2 so probe sequences stay short */
+	size_t buckets = 2, i;
+	int bits = 1;
+	while (buckets < 2 * capacity) {
+		buckets <<= 1;
+		bits++;
+	}
+
+	map->keys = malloc(buckets * sizeof(page_t));
+	map->values = malloc(buckets * sizeof(int));
+	if (!map->keys || !map->values) {
+		free(map->keys);
+		free(map->values);
+		map->keys = NULL;
+		map->values = NULL;
+		return -1;
+	}
+
+	for (i = 0; i < buckets; i++)
+		map->keys[i] = PAGEMAP_EMPTY;
+	map->mask = buckets - 1;
+	map->shift = 64 - bits;
+	map->size = 0;
+	return 0;
+}
+
+/*
+ * Function to set up an empty map. Pages below span are indexed directly if the
+ * span is small, or small compared to the number of pages stored (the id range is
+ * dense); that makes a lookup a single array read. Any other page is hashed.
+ *		:param map: the map to initialize
+ *		:param capacity: the expected maximum number of pages stored at once (the
+ *						 map grows past it if needed)
+ *		:param span: one more than the largest page expected (0 if unknown)
+ * **Returns**: 0 on success, -1 if memory could not be allocated
+ */
+int pagemap_init(struct pagemap *map, int capacity, page_t span) {
+	page_t i;
+
+	map->direct = NULL;
+	map->direct_len = 0;
+	map->keys = NULL;
+	map->values = NULL;
+	if (span > 0 && span <= PAGEMAP_DIRECT_MAX &&
+		(span <= PAGEMAP_DIRECT_MIN || span <= 16 * (page_t) capacity)) {
+		map->direct = malloc(span * sizeof(int));
+		if (!map->direct)
+			return -1;
+		for (i = 0; i < span; i++)
+			map->direct[i] = -1;
+		map->direct_len = span;
+		capacity = 1;
+	}
+
+	if (init_buckets(map, capacity > 0 ? capacity : 1) != 0) {
+		free(map->direct);
+		map->direct = NULL;
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * Function to release the memory held by a map.
+ *		:param map: the map to destroy
+ */
+void pagemap_destroy(struct pagemap *map) {
+	free(map->direct);
+	free(map->keys);
+	free(map->values);
+	map->direct = NULL;
+	map->keys = NULL;
+	map->values = NULL;
+	map->direct_len = 0;
+	map->size = 0;
+}
+
+/*
+ * Function to look up the value stored for a page.
+ *		:param map: the map to search
+ *		:param page: the page to look for
+ * **Returns**: the value stored for page if it's in the map, -1 otherwise.
+ */
+int pagemap_get(struct pagemap *map, page_t page) {
+	if (page < map->direct_len)
+		return map->direct[page];
+
+	size_t i = home_bucket(map, page);
+	while (map->keys[i] != PAGEMAP_EMPTY) {
+		if (map->keys[i] == page)
+			return map->values[i];
+		i = (i + 1) & map->mask;
+	}
+	return -1;
+}
+
+/*
+ * Function to double the number of buckets in a map and rehash its contents.
+ *		:param map: the map to grow
+ * **Returns**: 0 on success, -1 if memory could not be allocated (the map is
+ * left unchanged in that case)
+ */
+static int grow(struct pagemap *map) {
+	struct pagemap bigger = *map;
+	size_t i;
+	if (init_buckets(&bigger, map->mask + 1) != 0)
+		return -1;
+
+	for (i = 0; i <= map->mask; i++) {
+		if (map->keys[i] != PAGEMAP_EMPTY)
+			pagemap_put(&bigger, map->keys[i], map->values[i]);
+	}
+	free(map->keys);
+	free(map->values);
+	*map = bigger;
+	return 0;
+}
+
+/*
+ * Function to store (or overwrite) the value for a page.
+ *		:param map: the map to insert into
+ *		:param page: the page to insert (anything but PAGE_NONE)
+ *		:param value: the value to associate with page (not -1)
+ * **Returns**: 0 on success, -1 if the map had to grow and memory could not be
+ * allocated
+ */
+int pagemap_put(struct pagemap *map, page_t page, int value) {
+	if (page < map->direct_len) {
+		map->direct[page] = value;
+		return 0;
+	}
+	if (map->size + 1 > (map->mask + 1) / 2 && grow(map) != 0)
+		return -1;
+
+	size_t i = home_bucket(map, page);
+	while (map->keys[i] != PAGEMAP_EMPTY) {
+		if (map->keys[i] == page) {
+			map->values[i] = value;
+			return 0;
+		}
+		i = (i + 1) & map->mask;
+	}
+	map->keys[i] = page;
+	map->values[i] = value;
+	map->size++;
+	return 0;
+}
+
+/*
+ * Function to remove a page from the map. Entries after the removed one in the
+ * same probe run are shifted back so that later lookups never stop early.
+ *		:param map: the map to remove from
+ *		:param page: the page to remove (nothing happens if it isn't stored)
+ */
+void pagemap_remove(struct pagemap *map, page_t page) {
+	if (page < map->direct_len) {
+		map->direct[page] = -1;
+		return;
+	}
+
+	size_t i = home_bucket(map, page);
+	while (map->keys[i] != page) {
+		if (map->keys[i] == PAGEMAP_EMPTY)
+			return;
+		i = (i + 1) & map->mask;
+	}
+
+	/* i is now the hole; pull back any later entry whose home is at or before it */
+	size_t j = i;
+	for (;;) {
+		j = (j + 1) & map->mask;
+		if (map->keys[j] == PAGEMAP_EMPTY)
+			break;
+		size_t home = home_bucket(map, map->keys[j]);
+		if (((j - home) & map->mask) >= ((j - i) & map->mask)) {
+			map->keys[i] = map->keys[j];
+			map->values[i] = map->values[j];
+			i = j;
+		}
+	}
+	map->keys[i] = PAGEMAP_EMPTY;
+	map->size--;
+}
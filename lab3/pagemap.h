@@ -0,0 +1,30 @@
+#ifndef PAGEMAP_H
+#define PAGEMAP_H
+
+#include <stddef.h>
+#include "page.h"
+
+#define PAGEMAP_EMPTY PAGE_NONE
+#define PAGEMAP_DIRECT_MIN 4096			/* a span this small is always indexed directly */
+#define PAGEMAP_DIRECT_MAX (1 << 26)	/* a span larger than this is never indexed directly */
+
+/* index from a page number to an int value (e.g., a frame slot): pages below
+ * direct_len are looked up in a plain array, all others in an open-addressing
+ * hash table */
+struct pagemap {
+	int *direct;		/* value of each page below direct_len (-1 if absent), or NULL */
+	page_t direct_len;	/* number of pages indexed directly */
+	page_t *keys;		/* page stored in each bucket, or PAGEMAP_EMPTY */
+	int *values;		/* value associated with the page in the same bucket */
+	size_t mask;		/* number of buckets minus one (buckets is a power of two) */
+	int shift;			/* right shift applied to the multiplicative hash */
+	size_t size;		/* number of pages currently stored in the buckets */
+};
+
+int pagemap_init(struct pagemap *map, int capacity, page_t span);
+void pagemap_destroy(struct pagemap *map);
+int pagemap_get(struct pagemap *map, page_t page);
+int pagemap_put(struct pagemap *map, page_t page, int value);
+void pagemap_remove(struct pagemap *map, page_t page);
+
+#endif
@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "policy.h"
+#include "tenants.h"
+#include "trace.h"
+
+#define MIN_MEMORY_FRAMES 0
+#define MULTI_QUANTUM 100	/* references each tenant runs for in its turn by default */
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * pagemulti simulates several processes (tenants) sharing one pool of physical
+ * memory frames, under any registered policy (see policy.c). Each input file is
+ * the reference string of one tenant or, with -T, a text trace of several, where
+ * every reference is tagged with the id of its process ("pid:page", e.g.,
+ * "3:4096 7:12 3:4100"), and each process id is a tenant. Tenants never share
+ * pages, even when their page numbers are the same.
+ *
+ * The scheduler runs the tenants round robin, each for a quantum of references in
+ * turn (-q, 100 by default); with -q 0 the references run in the order they were
+ * given (a tagged trace's own order, or each file after the other). The frames are
+ * replaced either globally (-r global, the default), where one policy manages the
+ * whole pool and a fault may take a frame from any tenant, or locally (-r local),
+ * where each tenant gets an equal share of the frames (the first ones one more, if
+ * they don't divide evenly) and a policy of its own over it.
+ *
+ * For each tenant, pagemulti prints its miss rate (counted, as in pagesim, once
+ * its memory has filled up) and how many frames held its pages, on average and at
+ * the end; a tenant whose miss rate climbs under global replacement while another
+ * holds most of the frames is being thrashed by a noisy neighbour. The last line
+ * is the miss rate of every tenant together.
+ *
+ * Usage:
+ *   pagemulti [-q quantum] [-r global|local] [-T] num_memory_frames algo file [file ...]
+ *
+ * pagemulti accepts at least three command line arguments, plus optional settings
+ * -q - (optional) the number of references each tenant runs for in its turn, or 0
+ *      to run them in the order given (default: 100)
+ * -r - (optional) global or local replacement (default: global)
+ * -T - (optional) the files are text traces of "pid:page" pairs, with a tenant per
+ *      process id
+ * num_memory_frames  - the total number of physical memory frames shared by the
+ *                      tenants (maximum 100 for lru and extra)
+ * algo - the chosen algorithm (any registered policy, as in pagesim)
+ * file - the name of an input file that contains a list of page references (any
+ *        length, text or binary; "-" reads them from stdin)
+ */
+
+//======================================================//
+const char * usage = "Usage:"
+"  pagemulti [-q quantum] [-r global|local] [-T] num_memory_frames algo file [file ...] \n"
+"\n"
+"pagemulti accepts at least three command line arguments, plus optional settings \n"
+"-q - (optional) the number of references each tenant runs for in its turn, or 0 \n"
+"     to run them in the order given (default: 100) \n"
+"-r - (optional) global or local replacement (default: global) \n"
+"-T - (optional) the files are text traces of \"pid:page\" pairs, with a tenant per \n"
+"     process id \n"
+"num_memory_frames  - the total number of physical memory frames shared by the \n"
+"                     tenants (maximum 100 for lru and extra) \n"
+"algo - the chosen algorithm (any registered policy, as in pagesim) \n"
+"file - the name of an input file that contains a list of page references (any \n"
+"       length, text or binary; \"-\" reads them from stdin) \n"
+"\n"
+"\n";
+//======================================================//
+
+/*
+ * This function prints the start of a line of results: its label, and a miss rate.
+ *		:param label: what the line is about
+ *		:param width: the width to pad the label to
+ *		:param faults: the number of page faults counted
+ *		:param refs: the number of references counted
+ */
+void print_miss_rate(const char *label, int width, int faults, int refs) {
+	double miss_rate = (refs == 0) ? NAN : ((double) faults / refs) * 100;
+	printf("%-*s  Miss Rate = %d / %d = %3.2f%%", width, label, faults, refs, miss_rate);
+}
+
+/*
+ * Main function for the pagemulti application. This function takes in the command
+ * line arguments specified above in the file comments, loads the tenants,
+ * schedules and simulates them, and prints out every tenant's miss rate along with
+ * the miss rate of all of them together.
+ */
+int main(int argc, char *argv[]) {
+
+	int quantum = MULTI_QUANTUM;	/* references per turn (-q) */
+	int scope = TENANT_GLOBAL;		/* replacement scope (-r) */
+	int tagged = 0;					/* whether the files are pid-tagged (-T) */
+	int num_memory_frames, opt, i, k;
+	char *end;
+
+	/* checking the options, then the rest of the input from the command line */
+	while ((opt = getopt(argc, argv, "q:r:T")) != -1) {
+		if (opt == 'q') {
+			quantum = (int) strtol(optarg, &end, 10);
+			if (quantum < 0 || *end != '\0' || end == optarg) {
+				printf("Error: quantum must be a non-negative integer; received %s\n", optarg);
+				exit(1);
+			}
+		}
+		else if (opt == 'r') {
+			if (strcmp(optarg, "global") == 0)
+				scope = TENANT_GLOBAL;
+			else if (strcmp(optarg, "local") == 0)
+				scope = TENANT_LOCAL;
+			else {
+				printf("Error: replacement must be global or local; received %s\n", optarg);
+				exit(1);
+			}
+		}
+		else if (opt == 'T') {
+			tagged = 1;
+		}
+		else {
+			printf("Error: Invalid option.\n\n%s", usage);
+			exit(1);
+		}
+	}
+	argv += optind - 1;
+	argc -= optind - 1;
+
+	if (argc < 4) {
+		printf("Error: Invalid number of parameters.\n\n%s", usage);
+		exit(1);
+	}
+
+	/* verify the algorithm, and the number of frames it can manage */
+	num_memory_frames = atoi(argv[1]);
+	const struct policy * policy = find_policy(argv[2]);
+	if (!policy) {
+		printf("Error: algorithm usage (");
+		print_policy_names();
+		printf("); received %s.\n", argv[2]);
+		exit(1);
+	}
+	if (num_memory_frames < MIN_MEMORY_FRAMES || num_memory_frames > policy->max_frames) {
+		printf("Error: range of number of memory frames is [%d, %d], received %d.\n",
+			   MIN_MEMORY_FRAMES, policy->max_frames, num_memory_frames);
+		exit(1);
+	}
+
+	/* load the tenants, a file (or a process id) at a time */
+	struct mix mix;
+	mix_init(&mix);
+	for (i = 3; i < argc; i++) {
+		int err;
+		if (tagged) {
+			err = mix_add_tagged(&mix, argv[i]);
+		}
+		else {
+			struct trace trace;
+			err = trace_load(&trace, argv[i]);
+			if (err == 0) {
+				err = mix_add_trace(&mix, argv[i], trace.pages, trace.num_pages);
+				trace_free(&trace);
+			}
+		}
+
+		if (err == TRACE_ERR_OPEN) {
+			printf("Error: cannot open file %s for reading.\n", argv[i]);
+			exit(1);
+		}
+		else if (err == TRACE_ERR_MEMORY) {
+			printf("Error: cannot allocate memory for the page references in %s.\n", argv[i]);
+			exit(1);
+		}
+		else if (err == TRACE_ERR_FORMAT) {
+			printf("Error: %s is not a valid %s file.\n", argv[i],
+				   tagged ? "tagged trace (of pid:page pairs)" : "trace");
+			exit(1);
+		}
+	}
+	if (mix.num_refs == 0) {
+		printf("Error: the files hold no page references.\n");
+		exit(1);
+	}
+
+	int stats[2];
+	if (mix_schedule(&mix, quantum) != 0) {
+		printf("Error: cannot allocate memory to schedule %d references.\n", mix.num_refs);
+		exit(1);
+	}
+	mix_simulate(policy, &mix, num_memory_frames, scope, stats);
+
+	/* a line per tenant, then every tenant together */
+	int width = (int) strlen("all tenants");
+	for (k = 0; k < mix.num_tenants; k++) {
+		if ((int) strlen(mix.tenants[k].label) > width)
+			width = (int) strlen(mix.tenants[k].label);
+	}
+	for (k = 0; k < mix.num_tenants; k++) {
+		struct tenant *t = &mix.tenants[k];
+		print_miss_rate(t->label, width, t->faults, t->refs);
+		if (scope == TENANT_LOCAL)
+			printf("  (frames: %d of %d held at the end, %.2f on average)\n", t->held,
+				   t->frames, t->mean_held);
+		else
+			printf("  (frames: %d held at the end, %.2f on average)\n", t->held, t->mean_held);
+	}
+	print_miss_rate("all tenants", width, stats[0], stats[1]);
+	printf("  (%s replacement of %d frames, quantum %d)\n",
+		   (scope == TENANT_GLOBAL) ? "global" : "local", num_memory_frames, quantum);
+
+	mix_free(&mix);
+	return 0;
+}
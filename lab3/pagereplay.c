@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "display.h"
+#include "policy.h"
+#include "trace.h"
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * pagereplay reads an event log written by pagesim -l (see display.c), and prints
+ * exactly what pagesim would have printed for that run: a row of the frames'
+ * contents for every reference, then the miss rate. The frames are rebuilt from
+ * the slot each fault was loaded into (and each frame emptied, for the policies
+ * whose resident sets shrink), so the policy itself isn't needed.
+ *
+ * Usage:
+ *   pagereplay eventlog
+ *
+ * pagereplay accepts one command-line argument
+ * eventlog - the name of the event log to read ("-" reads stdin)
+ */
+
+//======================================================//
+const char * usage = "Usage:"
+"   pagereplay eventlog\n"
+"\n"
+"pagereplay accepts one command-line argument\n"
+"eventlog - the name of the event log to read (\"-\" reads stdin)\n"
+"\n";
+//======================================================//
+
+/*
+ * Main function for the pagereplay application. This function replays every
+ * event of the log into a set of frames, counting the references and faults the
+ * way the engines do, and displays each one.
+ */
+int main(int argc, char *argv[]) {
+
+	struct event_log log;	/* the log being read */
+	struct engine frames;	/* the frames and counts being rebuilt */
+	page_t page;
+	int slot, err, stats[2];
+
+	/* checking the input from the command line */
+	if (argc != 2) {
+		printf("Error: Invalid number of parameters.\n\n%s", usage);
+		exit(1);
+	}
+
+	err = event_log_read(&log, argv[1]);
+	if (err == TRACE_ERR_OPEN) {
+		printf("Error: cannot open file %s for reading.\n", argv[1]);
+		exit(1);
+	}
+	else if (err == TRACE_ERR_FORMAT) {
+		printf("Error: %s is not a valid event log.\n", argv[1]);
+		exit(1);
+	}
+
+	/* replay each reference: a fault loads the page into its slot */
+	if (engine_init(&frames, log.frame_num) != 0) {
+		printf("Error: cannot allocate memory for %d frames.\n", log.frame_num);
+		exit(1);
+	}
+	while ((err = event_log_next(&log, &page, &slot)) == 1) {
+		if (page == PAGE_NONE) {
+			if (slot >= 0)
+				frames.frames[slot] = PAGE_NONE;
+			continue;
+		}
+		if (slot >= 0)
+			frames.frames[slot] = page;
+		engine_count(&frames, slot != EVENT_HIT);
+		display(frames.frames, frames.frame_num, page, (slot != EVENT_HIT && frames.is_filled));
+	}
+	display_flush();
+	if (err != 0) {
+		printf("Error: %s is not a valid event log.\n", argv[1]);
+		exit(1);
+	}
+
+	/* calculate and display miss rate to user */
+	engine_stats(&frames, stats);
+	engine_free(&frames);
+
+	double miss_rate;
+	if (stats[1] == 0)
+		miss_rate = NAN;
+	else
+		miss_rate = (((double) stats[0]) / stats[1]) * 100;
+
+	printf("\nMiss Rate = %d / %d = %3.2f%%\n", stats[0], stats[1], miss_rate);
+
+	return 0;
+}
@@ -2,11 +2,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <unistd.h>
 #include "algorithms.h"
+#include "display.h"
+#include "instrument.h"
+#include "latency.h"
+#include "policy.h"
+#include "trace.h"
 
 #define MIN_MEMORY_FRAMES 0
-#define MAX_MEMORY_FRAMES 100
-#define MAX_PAGE_REFERENCES 10000
 
 /* 
  * Author: Peter Mountanos
@@ -16,28 +20,95 @@
  * pagesim reads a sequence of pages from the provided input file, and simulates
  * a page replacement algorithm, based on the inputted algorithm and frame size.
  * The input file has to contain the numbers only separated by spaces, and the
- * numbers should be from 0 to 99. Also, the algorithm input can either be 'lru'
- * or 'fifo' or 'extra', and the total number of physical memory frames must be
- * [0, 100].
+ * numbers can be any 64-bit page number (0 to 2^64 - 2). Also, the algorithm input
+ * can be any registered policy (see policy.c): 'lru' or 'fifo' or 'extra' or 'fastlru'
+ * or 'fastextra', or the scan-resistant 'arc' or '2q' or 'lirs', or the kernel-style
+ * 'clock' or 'gclock' or 'clockpro' or 'wsclock', or the variable-allocation 'ws'
+ * or 'pff', whose resident sets grow and shrink within the frames, or the
+ * clean-first 'cflru', which would rather evict a clean page than a dirty one.
+ * A page number followed by w (e.g., 12w) is a write. The total number
+ * of physical memory frames must be [0, 100] for lru and extra, which scan every
+ * frame, and [0, 16777216] for the others.
+ * 
+ * Each reference is displayed as a row of the frames' contents. With -l, the
+ * references are instead recorded in a binary event log (see display.c), which is
+ * much faster to write, and which pagereplay turns into the same rows later.
+ *
+ * When the trace has writes, the displayed and priced (-c) runs also count the
+ * write-backs: dirty pages that have to be written to swap as they are replaced
+ * (or let go), and print the swap I/O they add to the page faults. Logged (-l) and
+ * instrumented (-i) runs treat every reference as a read, so they refuse the
+ * policies that act on writes (cflru, wsclock) on such a trace.
+ *
+ * With -t or -w, pagesim runs on the references as they arrive instead (from a
+ * pipe, a FIFO, or stdin), so it can watch a trace that is still being produced:
+ * each read hands over whatever references have come in, the policy's state is
+ * kept from one read to the next, and only one block of input is held at a time.
+ * Rather than a row per reference, it prints the miss rate of each tumbling window
+ * of -t references as it ends, and, every step references, the miss rate of the
+ * last -w references (a sliding window, whose faults are kept in a ring). Windows
+ * are made of counted references, i.e., those after memory has filled up. The
+ * offline policies (extra and fastextra) read ahead, so they can't be streamed,
+ * and the input must be a text trace. Its writes (e.g., 12w) are followed as they
+ * arrive, as in a displayed run: the policy is told of each one, and the
+ * write-backs and swap I/O are printed after the miss rate.
+ *
+ * When built with make INSTRUMENT=1, -i runs the policy without displaying the
+ * references and writes what it recorded about the run (see instrument.c) to the
+ * given file, as JSON, or as CSV if the name ends in ".csv".
+ *
+ * With -c, pagesim prices the run instead of displaying the references: each
+ * reference goes through a TLB in front of the frames, a page table walk if it
+ * misses there, and the swap device behind the frames if it faults (see
+ * latency.c). It prints the time spent in each layer, the effective access time
+ * and the stall time. The model is a list of settings, any of which may be left
+ * out (or "default" for all of them): tlb=entries[:ways] (default 64:4), and the
+ * latencies in ns lookup=1, walk=30, mem=100 and swap=100000.
  * 
  * Usage:
- *   pagesim num_memory_frames file algo
+ *   pagesim [-l eventlog | -i file | -c model] [-t size] [-w size[:step]] num_memory_frames file algo
  * 
- * pagesim accepts three command line arguments
- * num_memory_frames  - the total number of physical memory frames (maximum 100)
+ * pagesim accepts three command line arguments, plus an optional event log or windows
+ * -l - (optional) record the references in this event log instead of displaying them
+ * -i - (optional; INSTRUMENT builds only) write the counters and histograms of the
+ *      run to this file instead of displaying the references
+ * -c - (optional) report what the references cost under this model of a TLB,
+ *      memory and swap (i.e., "tlb=64:4,swap=8000000") instead of displaying them
+ * -t - (optional) stream the references, printing the miss rate of every window of
+ *      this many references
+ * -w - (optional) stream the references, printing the miss rate of the last size
+ *      references every step references (default step: size)
+ * num_memory_frames  - the total number of physical memory frames (maximum 100 for lru and extra)
  * file - the name of the input file that contains a list of page references
- * algo - the chosen algorithm (either lru or fifo or extra)
+ *        (any length, text or binary; "-" reads them from stdin)
+ * algo - the chosen algorithm (either lru or fifo or extra or fastlru or fastextra,
+ *        or one of the scan-resistant arc, 2q or lirs, or one of the kernel-style
+ *        clock, gclock, clockpro or wsclock, or the variable-allocation ws or pff,
+ *        or the clean-first cflru)
  */
 
 
 //======================================================//
 const char * usage = "Usage:"
-"  pagesim file \n"
+"  pagesim [-l eventlog | -i file | -c model] [-t size] [-w size[:step]] num_memory_frames file algo \n"
 "\n"
-"pagesim accepts three command line arguments     \n"
-"num_memory_frames  - the total number of physical memory frames (maximum 100) \n"
+"pagesim accepts three command line arguments, plus an optional event log or windows \n"
+"-l - (optional) record the references in this event log instead of displaying them \n"
+"-i - (optional; INSTRUMENT builds only) write the counters and histograms of the \n"
+"     run to this file instead of displaying the references \n"
+"-c - (optional) report what the references cost under this model of a TLB, \n"
+"     memory and swap (i.e., \"tlb=64:4,swap=8000000\") instead of displaying them \n"
+"-t - (optional) stream the references, printing the miss rate of every window of \n"
+"     this many references \n"
+"-w - (optional) stream the references, printing the miss rate of the last size \n"
+"     references every step references (default step: size) \n"
+"num_memory_frames  - the total number of physical memory frames (maximum 100 for lru and extra) \n"
 "file - the name of the input file that contains a list of page references \n"
-"algo - the chosen algorithm (either lru or fifo or extra) \n"
+"       (any length, text or binary; \"-\" reads them from stdin) \n"
+"algo - the chosen algorithm (either lru or fifo or extra or fastlru or fastextra, \n"
+"       or one of the scan-resistant arc, 2q or lirs, or one of the kernel-style \n"
+"       clock, gclock, clockpro or wsclock, or the variable-allocation ws or pff, \n"
+"       or the clean-first cflru) \n"
 "\n"
 "\n";
 //======================================================//
@@ -52,20 +123,164 @@ const char * usage = "Usage:"
  */
 void verify_input(int num_memory_frames, char * algo) { 
 
-	// total number of physical memory frames must be in set range
+	// verify algorithm name passed in is valid
+	const struct policy * policy = find_policy(algo);
+	if (!policy) {
+		printf("Error: algorithm usage (");
+		print_policy_names();
+		printf("); received %s.\n", algo);
+		exit(1);
+	}
+
+	// total number of physical memory frames must be in set range (the
+	// scanning engines are limited to far fewer than the others)
+	int max_frames = policy->max_frames;
+
 	if (num_memory_frames < MIN_MEMORY_FRAMES || 
-		num_memory_frames > MAX_MEMORY_FRAMES) {
+		num_memory_frames > max_frames) {
 		printf("Error: range of number of memory frames is [%d, %d], received %d.\n",
-		 	   MIN_MEMORY_FRAMES, MAX_MEMORY_FRAMES, num_memory_frames);
+		 	   MIN_MEMORY_FRAMES, max_frames, num_memory_frames);
 		exit(1);
 	}
+}
 
-	// verify algorithm name passed in is valid
-	if (strcmp(algo, "lru") != 0 && strcmp(algo, "fifo") != 0 &&
-		strcmp(algo, "extra") != 0) {
-		printf("Error: algorithm usage (lru, fifo, or extra); received %s.\n", algo);
+/* the windows a streamed simulation reports the miss rate of */
+struct windows {
+	int tumbling;			/* references per tumbling window (0 if none) */
+	int tumbling_faults;	/* faults so far in the current tumbling window */
+	int tumbling_refs;		/* references so far in the current tumbling window */
+	int sliding;			/* references in the sliding window (0 if none) */
+	int step;				/* references between reports of the sliding window */
+	unsigned char * ring;	/* whether each of the last sliding references faulted */
+	int sliding_faults;		/* faults among them */
+	long counted;			/* references counted so far */
+};
+
+/*
+ * This function prints the miss rate of one window, and flushes it out at once,
+ * so that it can be watched as the references arrive.
+ *		:param kind: the kind of window ("tumbling" or "sliding")
+ *		:param first: the number of the window's first counted reference (from 1)
+ *		:param faults: the number of page faults in the window
+ *		:param refs: the number of references in the window
+ */
+void print_window(const char * kind, long first, int faults, int refs) {
+	printf("%s %ld - %ld: Miss Rate = %d / %d = %3.2f%%\n", kind, first, first + refs - 1,
+		   faults, refs, ((double) faults / refs) * 100);
+	fflush(stdout);
+}
+
+/*
+ * This function adds one counted reference to the windows, printing any window
+ * it completes.
+ *		:param win: the windows
+ *		:param faulted: "boolean" indicating whether the reference faulted
+ */
+void window_add(struct windows * win, int faulted) {
+	win->counted++;
+
+	if (win->tumbling > 0) {
+		win->tumbling_faults += faulted;
+		if (++win->tumbling_refs == win->tumbling) {
+			print_window("tumbling", win->counted - win->tumbling + 1, win->tumbling_faults,
+						 win->tumbling);
+			win->tumbling_faults = win->tumbling_refs = 0;
+		}
+	}
+
+	if (win->sliding > 0) {
+		int at = (int) ((win->counted - 1) % win->sliding);
+		if (win->counted > win->sliding)
+			win->sliding_faults -= win->ring[at];
+		win->ring[at] = faulted;
+		win->sliding_faults += faulted;
+		if (win->counted % win->step == 0) {
+			int refs = (win->counted < win->sliding) ? (int) win->counted : win->sliding;
+			print_window("sliding", win->counted - refs + 1, win->sliding_faults, refs);
+		}
+	}
+}
+
+/*
+ * This function runs a policy on references as they arrive, reporting the miss
+ * rate of its windows as they end.
+ *		:param policy: the policy to run
+ *		:param file_name: the file to read the references from ("-" reads stdin)
+ *		:param frame_num: the number of frames
+ *		:param win: the windows to report
+ *		:param stats: an array which will store the number of page faults (index 0),
+ *					  the number of references (index 1), and the number of
+ *					  write-backs (index 2; -1 if no reference was a write)
+ */
+void simulate_stream(const struct policy * policy, char * file_name, int frame_num,
+					 struct windows * win, int stats[]) {
+	struct trace_stream stream;
+	struct dirty_pages dirty;
+	page_t * pages;
+	unsigned char * writes;
+	int num_pages, i, refs = 0, wrote = 0;
+
+	int err = trace_stream_open(&stream, file_name);
+	if (err == TRACE_ERR_OPEN) {
+		printf("Error: cannot open file %s for reading.\n", file_name);
+		exit(1);
+	}
+	else if (err == TRACE_ERR_MEMORY) {
+		printf("Error: cannot allocate memory for reading %s.\n", file_name);
+		exit(1);
+	}
+
+	/* one reference at a time, following the dirty pages, and checking after each
+	 * whether it was counted */
+	struct engine * engine = engine_new(policy, NULL, 0, frame_num);
+	engine->released = malloc((frame_num + 1) * sizeof(int));
+	if (!engine->released || dirty_init(&dirty, engine, 0) != 0) {
+		printf("Error: cannot allocate memory for %d frames.\n", frame_num);
+		exit(1);
+	}
+	while ((num_pages = trace_stream_read(&stream, &pages, &writes)) > 0) {
+		for (i = 0; i < num_pages; i++) {
+			int write = writes && writes[i], faulted;
+			engine->num_released = 0;
+			engine->writing = write;
+			faulted = policy->access(engine, pages[i]);
+			if (dirty_update(&dirty, engine, pages[i], write, faulted) < 0) {
+				printf("Error: cannot allocate memory for the dirty pages.\n");
+				exit(1);
+			}
+			wrote |= write;
+			policy->stats(engine, stats);
+			if (stats[1] > refs) {
+				refs = stats[1];
+				window_add(win, faulted);
+			}
+		}
+	}
+	free(engine->released);
+	engine->released = NULL;
+	policy->stats(engine, stats);
+	stats[2] = wrote ? dirty.num_writebacks : -1;
+	policy->destroy(engine);
+	dirty_free(&dirty);
+	trace_stream_close(&stream);
+
+	if (num_pages == TRACE_ERR_OPEN) {
+		printf("Error: cannot read file %s.\n", file_name);
+		exit(1);
+	}
+	else if (num_pages == TRACE_ERR_MEMORY) {
+		printf("Error: cannot allocate memory for reading %s.\n", file_name);
 		exit(1);
 	}
+	else if (num_pages == TRACE_ERR_FORMAT) {
+		printf("Error: %s is a binary trace; only text traces can be streamed.\n", file_name);
+		exit(1);
+	}
+
+	/* the window the trace ended partway through */
+	if (win->tumbling_refs > 0)
+		print_window("tumbling", win->counted - win->tumbling_refs + 1, win->tumbling_faults,
+					 win->tumbling_refs);
 }
 
 /*
@@ -79,14 +294,61 @@ void verify_input(int num_memory_frames, char * algo) {
 int main(int argc, char *argv[]) {
 
 	int num_memory_frames; /* number of physical memory frames */
-	FILE *fp; 			   /* input file */
 	char * algo; 		   /* chosen algorithm */
-	char file_name[256];
+	char * log_name = NULL; /* event log to record the references in, if any */
+	char * instr_name = NULL; /* file to write the instrumentation to, if any */
+	char * model_spec = NULL; /* cost model to price the references under, if any */
+	struct latency_model model;
+	struct windows win = { 0 };	/* windows to report when streaming (-t, -w) */
+	char * end;
+	int opt;
 
-	/* initialize page references to max size for now */
-	int* page_references = malloc(MAX_PAGE_REFERENCES*sizeof(int));
+	/* checking the options, then the rest of the input from the command line */
+	while ((opt = getopt(argc, argv, "l:i:c:t:w:")) != -1) {
+		if (opt == 'l') {
+			log_name = optarg;
+		}
+		else if (opt == 'i') {
+#ifdef INSTRUMENT
+			instr_name = optarg;
+#else
+			printf("Error: pagesim was built without instrumentation (make INSTRUMENT=1).\n");
+			exit(1);
+#endif
+		}
+		else if (opt == 'c') {
+			model_spec = optarg;
+			if (latency_parse(model_spec, &model) != 0) {
+				printf("Error: cost model must be settings tlb=entries[:ways] (entries/ways a "
+					   "power of two, ways at most %d), lookup, walk, mem or swap=ns, "
+					   "separated by commas; received %s\n", LATENCY_MAX_WAYS, optarg);
+				exit(1);
+			}
+		}
+		else if (opt == 't') {
+			win.tumbling = atoi(optarg);
+			if (win.tumbling < 1) {
+				printf("Error: window size must be a positive integer; received %s\n", optarg);
+				exit(1);
+			}
+		}
+		else if (opt == 'w') {
+			win.sliding = (int) strtol(optarg, &end, 10);
+			win.step = (*end == ':') ? atoi(end + 1) : win.sliding;
+			if (win.sliding < 1 || win.step < 1 || (*end != ':' && *end != '\0')) {
+				printf("Error: window must be a positive size, optionally followed by :step; "
+					   "received %s\n", optarg);
+				exit(1);
+			}
+		}
+		else {
+			printf("Error: Invalid option.\n\n%s", usage);
+			exit(1);
+		}
+	}
+	argv += optind - 1;
+	argc -= optind - 1;
 
-	/* checking the input from the command line */
 	if (argc != 4) {
 		printf("Error: Invalid number of parameters.\n\n%s", usage);
 		exit(1);
@@ -98,35 +360,126 @@ int main(int argc, char *argv[]) {
 
 	/* verify arguments match preconditions */
 	verify_input(num_memory_frames, algo);
-
-	/* create the input file pointer*/
-	strncpy (file_name, argv[2], 256);
-	fp = fopen(file_name, "r");
-	if(!fp) {
-		printf("Error: cannot open file %s for reading.\n", file_name);
+	if (instr_name && log_name) {
+		printf("Error: an event log cannot be recorded while instrumenting.\n\n%s", usage);
+		exit(1);
+	}
+	if (model_spec && (log_name || instr_name)) {
+		printf("Error: a priced run cannot also be logged or instrumented.\n\n%s", usage);
 		exit(1);
 	}
 
+	/* streaming: report the windows as the references arrive, then the miss rate */
+	int stats[3];
+	if (win.tumbling > 0 || win.sliding > 0) {
+		if (log_name) {
+			printf("Error: an event log cannot be recorded while streaming.\n\n%s", usage);
+			exit(1);
+		}
+		if (instr_name) {
+			printf("Error: a streamed run cannot be instrumented.\n\n%s", usage);
+			exit(1);
+		}
+		if (model_spec) {
+			printf("Error: a streamed run cannot be priced.\n\n%s", usage);
+			exit(1);
+		}
+		if (find_policy(algo)->lookahead) {
+			printf("Error: %s reads ahead in the references, so it cannot be streamed.\n", algo);
+			exit(1);
+		}
+		if (win.sliding > 0 && !(win.ring = calloc(win.sliding, 1))) {
+			printf("Error: cannot allocate memory for a window of %d references.\n", win.sliding);
+			exit(1);
+		}
+		simulate_stream(find_policy(algo), argv[2], num_memory_frames, &win, stats);
+		free(win.ring);
+		printf("\nMiss Rate = %d / %d = %3.2f%%\n", stats[0], stats[1],
+			   (stats[1] == 0) ? NAN : (((double) stats[0]) / stats[1]) * 100);
+		if (stats[2] >= 0) {
+			printf("Write-backs = %d / %d = %3.2f%%\n", stats[2], stats[1],
+				   (stats[1] == 0) ? NAN : (((double) stats[2]) / stats[1]) * 100);
+			printf("Swap I/O = %d page-ins + %d write-backs = %d pages\n", stats[0], stats[2],
+				   stats[0] + stats[2]);
+		}
+		return 0;
+	}
 
-	/* read the values from the input file and accumulate them into array.  */
-	int i = 0;
-	while (fscanf( fp, "%d", &page_references[i++]) == 1);
-	fclose(fp);
-
-	/* reallocate memory store for array to correct size */
-	int num_pages = (i-1);
-	page_references = realloc(page_references, num_pages * sizeof(int));
+	/* read the page references from the input file ("-" reads stdin), in the
+	 * text or binary format (a fixed-width binary trace is mapped, not copied) */
+	struct trace trace;
+	int err = trace_load(&trace, argv[2]);
+	if (err == TRACE_ERR_OPEN) {
+		printf("Error: cannot open file %s for reading.\n", argv[2]);
+		exit(1);
+	}
+	else if (err == TRACE_ERR_MEMORY) {
+		printf("Error: cannot allocate memory for the page references in %s.\n", argv[2]);
+		exit(1);
+	}
+	else if (err == TRACE_ERR_FORMAT) {
+		printf("Error: %s is not a valid trace file.\n", argv[2]);
+		exit(1);
+	}
+	page_t * page_references = trace.pages;
+	int num_pages = trace.num_pages;
+	if ((log_name || instr_name) && trace.writes && find_policy(algo)->writes) {
+		printf("Error: %s acts on writes, which a logged or instrumented run treats as "
+			   "reads.\n", algo);
+		exit(1);
+	}
 
-	/* determine which page replacement algorithm to run (in verbose mode) */
-	int stats[2];
-	if (strcmp(algo, "lru") == 0) { 
-		lru(page_references, num_pages, num_memory_frames, stats, 1);
+	/* run the chosen page replacement algorithm (in verbose mode), displaying each
+	 * reference or recording it in the event log */
+	if (log_name) {
+		struct event_log log;
+		err = event_log_open(&log, log_name, num_memory_frames);
+		if (err == TRACE_ERR_MEMORY) {
+			printf("Error: cannot allocate memory for event log %s.\n", log_name);
+			exit(1);
+		}
+		if (err == 0) {
+			err = simulate_logged(find_policy(algo), page_references, num_pages,
+								  num_memory_frames, stats, &log);
+			if (event_log_close(&log) != 0)
+				err = TRACE_ERR_OPEN;
+		}
+		if (err != 0) {
+			printf("Error: cannot write event log %s.\n", log_name);
+			exit(1);
+		}
+	}
+#ifdef INSTRUMENT
+	else if (instr_name) {
+		struct page_ids ids;
+		struct instrument * instr = instrument_new(1);
+		if (!instr || page_ids_init(&ids, page_references, num_pages) != 0) {
+			printf("Error: cannot allocate memory for instrumenting %s.\n", algo);
+			exit(1);
+		}
+		simulate_instrumented(find_policy(algo), page_references, num_pages, num_memory_frames,
+							  &ids, stats, instr);
+		if (instrument_write(instr_name, instr, 1) != 0) {
+			printf("Error: cannot write file %s.\n", instr_name);
+			exit(1);
+		}
+		page_ids_free(&ids);
+		free(instr);
 	}
-	else if (strcmp(algo, "fifo") == 0) {
-		fifo(page_references, num_pages, num_memory_frames, stats, 1);
+#endif
+	else if (model_spec) {
+		struct latency_report report;
+		simulate_latency(find_policy(algo), page_references, trace.writes, num_pages,
+						 num_memory_frames, &model, stats, &report);
+		latency_print(&model, &report);
+		stats[2] = (int) report.writebacks;
+	}
+	else if (trace.writes) {
+		simulate_writes(find_policy(algo), page_references, trace.writes, num_pages,
+						num_memory_frames, stats, 1);
 	}
 	else {
-		extra(page_references, num_pages, num_memory_frames, stats, 1);
+		simulate(find_policy(algo), page_references, num_pages, num_memory_frames, stats, 1);
 	}
 
 	/* calculate and display miss rate to user */
@@ -138,5 +491,13 @@ int main(int argc, char *argv[]) {
 
 	printf("\nMiss Rate = %d / %d = %3.2f%%\n", stats[0], stats[1], miss_rate);
 
+	/* with writes, the pages swap has to move: faults in, dirty pages out */
+	if (trace.writes && !log_name && !instr_name) {
+		printf("Write-backs = %d / %d = %3.2f%%\n", stats[2], stats[1],
+			   (stats[1] == 0) ? NAN : (((double) stats[2]) / stats[1]) * 100);
+		printf("Swap I/O = %d page-ins + %d write-backs = %d pages\n", stats[0], stats[2],
+			   stats[0] + stats[2]);
+	}
+
 	return 0;
 }
\ No newline at end of file
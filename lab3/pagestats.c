@@ -1,12 +1,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <math.h>
+#include <unistd.h>
 #include "algorithms.h"
+#include "instrument.h"
+#include "lockstep.h"
+#include "policy.h"
+#include "trace.h"
+#include "stackdist.h"
+#include "workpool.h"
 
 #define MIN_MEMORY_FRAMES 2
-#define MAX_MEMORY_FRAMES 100
-#define MAX_PAGE_REFERENCES 10000
 
 /* 
  * Author: Peter Mountanos
@@ -20,30 +26,126 @@
  * 15, 25, 35, in the example pagestats 5 40 10 page_refs.txt). For each method/number
  * of frames combinations, the program calculates the page fault rate using the 
  * reference file given as input, and prints out a message containing this rate.
+ * By default the LRU, FIFO and extra algorithms are run; a different list of
+ * registered policies (see policy.c) can be given after the file name (e.g., only
+ * fastlru and fastextra, which support far more frames).
+ *
+ * With -s, the LRU and extra (optimal) rows come from a single pass over the
+ * references instead of one simulation per number of frames: both are stack
+ * algorithms, so the stack distance of every reference (see stackdist.c) gives the
+ * miss rate for all frame counts at once.
+ *
+ * With -r, the LRU rows (lru and fastlru) are approximated from a sample of the
+ * pages instead (see lru_sampled_profile in stackdist.c), for traces too long for
+ * an exact pass: pages are picked by a hash of their number at the given rate, a
+ * stack distance pass runs over their references alone, and the results are scaled
+ * back up. At most -b pages are tracked at once (the rate is lowered as needed),
+ * so the pass takes a fixed amount of memory however long the trace is. Each miss
+ * rate is followed by a bound on its error (about two standard errors), or a note
+ * that the sample is too coarse for it (below SHARDS_RESOLUTION / rate frames,
+ * i.e., 3200 frames at -r 0.01). When every row is sampled, the trace is never
+ * loaded whole: a text trace is read a block at a time as it arrives, and a
+ * fixed (64-bit) binary trace is mapped and read in place, so only the sample is
+ * held in memory (the other binary encodings are decoded in full first).
+ *
+ * If the trace marks some references as writes, every simulated row is run with
+ * them, as in pagesim (the policies that act on them, cflru and wsclock, pick
+ * their victims by which pages are dirty), and each miss rate is followed by the
+ * write-backs: dirty pages written to swap as they are replaced or let go, which
+ * the page faults have to be added to for the swap I/O. pagerates.txt then gets
+ * a second block of rows after the miss rates, with the write-back rates in the
+ * same order (nan for a row computed by a stack pass with -s or -r, which can't
+ * follow dirty pages). FIFO doesn't run in lockstep on such a trace.
+ *
+ * When every page is below LOCKSTEP_MAX_PAGE, a FIFO row is run in lockstep (see
+ * lockstep.c): up to LOCKSTEP_LANES of its frame counts go through the references
+ * together, in one pass. Those passes also count every fault from empty memory,
+ * and pagestats points out any case of Belady's anomaly, where FIFO faults more
+ * often with more frames, below the row.
+ *
+ * With -j N, the (algorithm, number of frames) simulations are spread across N
+ * threads (see workpool.c). They all read the same page references, and the
+ * results are printed in the usual order once every simulation has finished.
+ *
+ * When built with make INSTRUMENT=1, -i writes what every simulation recorded (see
+ * instrument.c) to the given file, as JSON, or as CSV if the name ends in ".csv".
+ * Each (algorithm, number of frames) is then simulated on its own, so -s and -r
+ * can't be given with it, and FIFO doesn't run in lockstep. The instrumented
+ * simulation treats every reference as a read, so the policies that act on writes
+ * (cflru, wsclock) can't be instrumented on a trace with writes.
  * 
  * Usage:
- *   pagestats min_frames max_frames frame_inc file
+ *   pagestats [-s] [-r rate [-b budget]] [-j threads] [-i file] min_frames max_frames
+ *             frame_inc file [algo ...]
  * 
- * pagesim accepts four command line arguments
+ * pagestats accepts four command line arguments, plus optional algorithm names
+ * -s - (optional) compute the LRU and extra rows (lru, fastlru, extra, fastextra)
+ *      in a single stack distance pass each
+ * -r - (optional) approximate the LRU rows (lru, fastlru) from a sample of this
+ *      fraction of the pages (e.g., 0.01)
+ * -b - (optional) the most sampled pages to track at once with -r (default 8192)
+ * -j - (optional) number of threads to run the simulations on (0 = one per CPU)
+ * -i - (optional; INSTRUMENT builds only) write the counters and histograms of
+ *      every simulation to this file
  * min_frames - the minimum number of frames (no less than 2)
- * max_frames - the maximum number of frames (no more than 100)
+ * max_frames - the maximum number of frames (no more than 100 if lru or extra
+ *              is simulated, otherwise 16777216)
  * frame_inc  - the frame number increment (positive integer)
  * file - the name of the input file that contains a list of page references
+ *        (any length, text or binary; "-" reads them from stdin)
+ * algo - (optional) algorithms to run, in order (lru, fifo, extra, fastlru,
+ *        fastextra, arc, 2q, lirs, clock, gclock, clockpro, wsclock, ws, pff, or cflru);
+ *        defaults to lru fifo extra
  */
 
 //======================================================//
 const char * usage = "Usage:"
-"  pagestats file \n"
+"  pagestats [-s] [-r rate [-b budget]] [-j threads] [-i file] min_frames max_frames \n"
+"            frame_inc file [algo ...] \n"
 "\n"
-"pagestats accepts four command line arguments     \n"
+"pagestats accepts four command line arguments, plus optional algorithm names \n"
+"-s - (optional) compute the LRU and extra rows (lru, fastlru, extra, fastextra) \n"
+"     in a single stack distance pass each \n"
+"-r - (optional) approximate the LRU rows (lru, fastlru) from a sample of this \n"
+"     fraction of the pages (e.g., 0.01) \n"
+"-b - (optional) the most sampled pages to track at once with -r (default 8192) \n"
+"-j - (optional) number of threads to run the simulations on (0 = one per CPU) \n"
+"-i - (optional; INSTRUMENT builds only) write the counters and histograms of \n"
+"     every simulation to this file \n"
 "min_frames - the minimum number of frames (no less than 2) \n"
-"max_frames - the maximum number of frames (no more than 100) \n"
+"max_frames - the maximum number of frames (no more than 100 if lru or extra \n"
+"             is simulated, otherwise 16777216) \n"
 "frame_inc  - the frame number increment (positive integer) \n"
 "file - the name of the input file that contains a list of page references \n"
+"       (any length, text or binary; \"-\" reads them from stdin) \n"
+"algo - (optional) algorithms to run, in order (lru, fifo, extra, fastlru, \n"
+"       fastextra, arc, 2q, lirs, clock, gclock, clockpro, wsclock, ws, pff, or cflru); \n"
+"       defaults to lru fifo extra \n"
 "\n"
 "\n";
 //======================================================//
 
+/*
+ * This function determines whether an algorithm's row is approximated from a
+ * sample of the pages.
+ * 		:param policy: the algorithm
+ *		:param sample_rate: the sampling rate given with -r (0 if none)
+ */
+int uses_sampled_pass(const struct policy * policy, double sample_rate) {
+	return sample_rate > 0 && policy->profile == lru_stack_profile;
+}
+
+/*
+ * This function determines whether an algorithm's row is computed from a single
+ * stack distance pass rather than one simulation per number of frames.
+ * 		:param policy: the algorithm
+ *		:param stack_mode: "boolean" indicating whether -s was given
+ *		:param sample_rate: the sampling rate given with -r (0 if none)
+ */
+int uses_stack_pass(const struct policy * policy, int stack_mode, double sample_rate) {
+	return (stack_mode && policy->profile != NULL) || uses_sampled_pass(policy, sample_rate);
+}
+
 /*
  * This function verifies the command line arguments to ensure that they
  * meet their preconditions. If these arguments don't, an error message is
@@ -52,15 +154,33 @@ const char * usage = "Usage:"
  								  frames (maximum 100)
  		:param algo: the chosen algorithm (either lru or fifo) 
  */
-void verify_input(int min_frames, int max_frames, int frame_inc) { 
+void verify_input(int min_frames, int max_frames, int frame_inc, char * names[],
+				  const struct policy * algos[], int num_algos, int stack_mode,
+				  double sample_rate) { 
 
-	if (min_frames < 2) {
-		printf("Error: minimum number of frames can be no less than 2; received %d\n", min_frames);
+	/* every algorithm name must be valid, and the number of frames must be
+	 * within every simulated engine's limit (stack distance passes have none
+	 * beyond the heap-based engines') */
+	int i, frame_limit = MAX_FAST_MEMORY_FRAMES;
+	for (i = 0; i < num_algos; i++) {
+		algos[i] = find_policy(names[i]);
+		if (!algos[i]) {
+			printf("Error: algorithm usage (");
+			print_policy_names();
+			printf("); received %s.\n", names[i]);
+			exit(1);
+		}
+		if (!uses_stack_pass(algos[i], stack_mode, sample_rate) && algos[i]->max_frames < frame_limit)
+			frame_limit = algos[i]->max_frames;
+	}
+
+	if (min_frames < MIN_MEMORY_FRAMES) {
+		printf("Error: minimum number of frames can be no less than %d; received %d\n", MIN_MEMORY_FRAMES, min_frames);
 		exit(1);
 	}
 	
-	if (max_frames > 100) {
-		printf("Error: maximum number of frames can be no more than 100; received %d\n", max_frames);
+	if (max_frames > frame_limit) {
+		printf("Error: maximum number of frames can be no more than %d; received %d\n", frame_limit, max_frames);
 		exit(1);
 	}
 	 
@@ -85,8 +205,14 @@ void verify_input(int min_frames, int max_frames, int frame_inc) {
  					  the second index holds the number of number of
  					  references for the run of the algorithm
  		:param tf: pointer to the target file to write results to
+ 		:param error: bound on the error of an estimated number of page faults,
+ 					  -1 if the faults were counted exactly, or INFINITY if there
+ 					  were too few frames for the sampling rate to estimate them
+ 		:param writebacks: the number of write-backs for the run, or -1 if they
+ 						   weren't counted
  */
-void print_results(char * algo, int frame_num, int stats[], FILE * tf) {
+void print_results(const char * algo, int frame_num, int stats[], FILE * tf, double error,
+				   int writebacks) {
 
 	/* if there were no page references, miss rate is NaN */
 	double miss_rate;
@@ -96,10 +222,232 @@ void print_results(char * algo, int frame_num, int stats[], FILE * tf) {
 		miss_rate = ((double) stats[0] / stats[1]) * 100;
 
 	/* print to stdout first, and then to target file (tf) */
-	printf("%s, %3d frames: Miss Rate = %3d / %3d = %3.2f%%\n", algo, frame_num, stats[0], stats[1], miss_rate);
+	printf("%s, %3d frames: Miss Rate = %3d / %3d = %3.2f%%", algo, frame_num, stats[0], stats[1], miss_rate);
+	if (isinf(error))
+		printf(" (too few frames for the sampling rate)");
+	else if (error >= 0)
+		printf(" (+/- %3.2f%%)", (stats[1] == 0) ? NAN : error / stats[1] * 100);
+	if (writebacks >= 0)
+		printf(", Write-backs = %3d / %3d = %3.2f%%", writebacks, stats[1],
+			   (stats[1] == 0) ? NAN : ((double) writebacks / stats[1]) * 100);
+	printf("\n");
 	fprintf(tf, "%3.2f ", miss_rate);
 }
 
+/* the whole series of simulations, shared (read-only except for results) by every job */
+struct sweep {
+	const struct policy ** algos;	/* algorithms to run, one output row each */
+	int num_algos;
+	page_t * arr;		/* the page references */
+	const unsigned char * writes;	/* which of them write their page (NULL if none do) */
+	int arr_size;
+	int min_frames;		/* frame counts run: min_frames, +frame_inc, ..., <= max_frames */
+	int max_frames;
+	int frame_inc;
+	int num_counts;		/* number of frame counts in a row */
+	int stack_mode;		/* "boolean" indicating whether -s was given */
+	double sample_rate;	/* sampling rate of the LRU rows (-r), or 0 */
+	int sample_budget;	/* most sampled pages tracked at once (-b) */
+	int * job_row;		/* row (algorithm) of each job */
+	int * job_col;		/* column (frame count) of each job, or -1 for a whole stack row */
+	int * job_len;		/* columns a job covers from there (more than one when FIFO runs
+						   them in lockstep) */
+	int * results;		/* faults and references of each row/column, two ints each */
+	double * errors;	/* error bound on the faults of each row/column (-1 if exact) */
+	long * totals;		/* faults of each row/column from empty memory, when run in
+						   lockstep (else -1) */
+	int * writebacks;	/* write-backs of each row/column, when the trace has writes
+						   (else -1) */
+	struct stack_profile * sampled;	/* the sampled profile, if the trace was streamed
+									   into it rather than loaded (else NULL) */
+	struct page_ids * ids;			/* numbering of the pages, when instrumenting (-i) */
+	struct instrument * instr;		/* record of each row/column when instrumenting, or NULL */
+};
+
+/*
+ * This function runs one job of a sweep: a single simulation, several FIFO
+ * simulations run in lockstep, or a whole row computed by a stack distance pass.
+ * 		:param ctx: the struct sweep the job belongs to
+ * 		:param job: the index of the job
+ */
+void run_sweep_job(void *ctx, int job) {
+	struct sweep * sw = ctx;
+	int row = sw->job_row[job], col = sw->job_col[job];
+	int * out = &sw->results[row * sw->num_counts * 2];
+	double * errors = &sw->errors[row * sw->num_counts];
+	long * totals = &sw->totals[row * sw->num_counts];
+	int * writebacks = &sw->writebacks[row * sw->num_counts];
+	int i;
+
+	for (i = 0; i < sw->job_len[job]; i++)
+		writebacks[((col >= 0) ? col : 0) + i] = -1;
+
+	if (col >= 0 && sw->job_len[job] > 1) {
+		int frame_nums[LOCKSTEP_LANES];
+		for (i = 0; i < sw->job_len[job]; i++) {
+			frame_nums[i] = sw->min_frames + (col + i) * sw->frame_inc;
+			errors[col + i] = -1;
+		}
+		if (fifo_lockstep(sw->arr, sw->arr_size, frame_nums, sw->job_len[job],
+						  &out[col * 2], &totals[col]) != 0) {
+			printf("Error: cannot allocate memory for the lockstep simulation.\n");
+			exit(1);
+		}
+		return;
+	}
+
+#ifdef INSTRUMENT
+	if (col >= 0 && sw->instr) {
+		simulate_instrumented(sw->algos[row], sw->arr, sw->arr_size,
+							  sw->min_frames + col * sw->frame_inc, sw->ids, &out[col * 2],
+							  &sw->instr[row * sw->num_counts + col]);
+		errors[col] = -1;
+		totals[col] = -1;
+		return;
+	}
+#endif
+	if (col >= 0 && sw->writes) {
+		int stats[3];
+		simulate_writes(sw->algos[row], sw->arr, sw->writes, sw->arr_size,
+						sw->min_frames + col * sw->frame_inc, stats, 0);
+		out[col * 2] = stats[0];
+		out[col * 2 + 1] = stats[1];
+		writebacks[col] = stats[2];
+		errors[col] = -1;
+		totals[col] = -1;
+		return;
+	}
+	if (col >= 0) {
+		simulate(sw->algos[row], sw->arr, sw->arr_size,
+				 sw->min_frames + col * sw->frame_inc, &out[col * 2], 0);
+		errors[col] = -1;
+		totals[col] = -1;
+		return;
+	}
+
+	/* stack algorithms in -s mode (or sampled with -r): one pass (unless the trace
+	 * was already streamed into a sampled one), then read off every frame count */
+	struct stack_profile own, * profile = &own;
+	int sampled = uses_sampled_pass(sw->algos[row], sw->sample_rate), err = 0;
+	if (sampled && sw->sampled)
+		profile = sw->sampled;
+	else if (sampled)
+		err = lru_sampled_profile(sw->arr, sw->arr_size, sw->max_frames, sw->sample_rate,
+								  sw->sample_budget, &own);
+	else
+		err = sw->algos[row]->profile(sw->arr, sw->arr_size, sw->max_frames, &own);
+	if (err != 0) {
+		printf("Error: cannot allocate memory for the stack distance pass.\n");
+		exit(1);
+	}
+	for (col = 0; col < sw->num_counts; col++) {
+		stack_stats(profile, sw->min_frames + col * sw->frame_inc, &out[col * 2]);
+		errors[col] = sampled ? stack_error(profile, sw->min_frames + col * sw->frame_inc) : -1;
+		totals[col] = -1;
+	}
+	if (profile == &own)
+		stack_profile_free(&own);
+}
+
+/*
+ * This function prints an error message and quits if a trace could not be read.
+ *		:param err: what reading it returned (0, or one of the TRACE_ERR_* codes)
+ *		:param file_name: the name of the trace
+ */
+void check_trace(int err, const char * file_name) {
+	if (err == TRACE_ERR_OPEN) {
+		printf("Error: cannot open file %s for reading.\n", file_name);
+		exit(1);
+	}
+	else if (err == TRACE_ERR_MEMORY) {
+		printf("Error: cannot allocate memory for the page references in %s.\n", file_name);
+		exit(1);
+	}
+	else if (err == TRACE_ERR_FORMAT) {
+		printf("Error: %s is not a valid trace file.\n", file_name);
+		exit(1);
+	}
+}
+
+/*
+ * This function runs the sampled LRU pass over a trace without loading it into
+ * memory: a text trace is fed to the pass a block at a time as it is read, and a
+ * binary trace (which can't be read that way) is mapped, and fed in place if its
+ * pages are 64-bit.
+ *		:param file_name: the name of the trace ("-" reads stdin)
+ *		:param max_frames: the largest number of frames the profile is asked about
+ *		:param sample_rate: the sampling rate (-r)
+ *		:param sample_budget: the most sampled pages tracked at once (-b)
+ *		:param profile: receives the profile
+ */
+void sample_trace(const char * file_name, int max_frames, double sample_rate, int sample_budget,
+				  struct stack_profile * profile) {
+	struct lru_sampler sampler;
+	struct trace_stream stream;
+	struct trace trace;
+	page_t * pages;
+	long total = 0;
+	int got;
+
+	if (lru_sampler_init(&sampler, max_frames, sample_rate, sample_budget, profile) != 0) {
+		printf("Error: cannot allocate memory for the stack distance pass.\n");
+		exit(1);
+	}
+	check_trace(trace_stream_open(&stream, file_name), file_name);
+	while ((got = trace_stream_read(&stream, &pages, NULL)) > 0) {
+		if (total + got > INT_MAX) {
+			printf("Error: %s holds more than %d page references.\n", file_name, INT_MAX);
+			exit(1);
+		}
+		total += got;
+		if (lru_sampler_feed(&sampler, pages, got) != 0) {
+			printf("Error: cannot allocate memory for the stack distance pass.\n");
+			exit(1);
+		}
+	}
+	trace_stream_close(&stream);
+
+	if (got == TRACE_ERR_FORMAT) {
+		/* a binary trace: mapped instead, from its name (stdin can't be reread) */
+		if (strcmp(file_name, "-") == 0) {
+			printf("Error: a binary trace can't be sampled from stdin; give its file name.\n");
+			exit(1);
+		}
+		check_trace(trace_load(&trace, file_name), file_name);
+		if (lru_sampler_feed(&sampler, trace.pages, trace.num_pages) != 0) {
+			printf("Error: cannot allocate memory for the stack distance pass.\n");
+			exit(1);
+		}
+		trace_free(&trace);
+	}
+	else {
+		check_trace(got, file_name);
+	}
+	if (lru_sampler_finish(&sampler) != 0) {
+		printf("Error: cannot allocate memory for the stack distance pass.\n");
+		exit(1);
+	}
+}
+
+/*
+ * This function estimates how long a job takes, relative to the other jobs, so
+ * the most expensive ones can be started first.
+ * 		:param policy: the algorithm the job runs
+ * 		:param frame_num: the number of frames (or the largest, for a stack row)
+ * 		:param stack_row: "boolean" indicating whether the job is a whole stack row
+ * **Returns**: the estimated cost
+ */
+long job_cost(const struct policy * policy, int frame_num, int stack_row) {
+	if (stack_row)
+		return (policy->profile == opt_stack_profile) ? frame_num : 1;
+
+	long cost = 1;
+	int i;
+	for (i = 0; i < policy->cost_exp; i++)
+		cost *= frame_num;
+	return cost;
+}
+
 /*
  * Main function for the pagestats application. This function takes in the
  * four command line arguments specified above in the file comments. After
@@ -111,16 +459,65 @@ void print_results(char * algo, int frame_num, int stats[], FILE * tf) {
 int main(int argc, char *argv[]) {
 
 	int min_frames; 		/* min number of frames (no less than 2) */
-	int max_frames;			/* max number of frames (no more than 100) */
+	int max_frames;			/* max number of frames (see verify_input) */
 	int frame_inc;			/* frame number increment (positive integer) */
-	FILE *fp; 			    /* input file */
-	char file_name[256];
+	int stack_mode = 0;		/* compute stack algorithms in a single pass (-s) */
+	int num_threads = 1;	/* threads to run the simulations on (-j) */
+	double sample_rate = 0;	/* sampling rate of the LRU rows (-r) */
+	int sample_budget = SHARDS_DEFAULT_BUDGET;	/* most sampled pages tracked (-b) */
+	char * instr_name = NULL;	/* file to write the instrumentation to (-i), if any */
+	int opt;
+
+	/* algorithms to run if none are given on the command line */
+	char * default_algos[] = { "lru", "fifo", "extra" };
+	char ** names = default_algos;
+	int num_algos = 3;
 
-	/* initialize page references to max size for now */
-	int* page_references = malloc(MAX_PAGE_REFERENCES*sizeof(int));
+	/* checking the options, then the rest of the input from the command line */
+	while ((opt = getopt(argc, argv, "sr:b:j:i:")) != -1) {
+		if (opt == 's') {
+			stack_mode = 1;
+		}
+		else if (opt == 'r') {
+			sample_rate = atof(optarg);
+			if (!(sample_rate > 0 && sample_rate <= 1)) {
+				printf("Error: sampling rate must be above 0 and at most 1; received %s\n", optarg);
+				exit(1);
+			}
+		}
+		else if (opt == 'b') {
+			sample_budget = atoi(optarg);
+			if (sample_budget < 1) {
+				printf("Error: sampling budget must be a positive integer; received %s\n", optarg);
+				exit(1);
+			}
+		}
+		else if (opt == 'j') {
+			num_threads = atoi(optarg);
+			if (num_threads == 0)
+				num_threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+			if (num_threads < 1) {
+				printf("Error: number of threads must be a positive integer; received %s\n", optarg);
+				exit(1);
+			}
+		}
+		else if (opt == 'i') {
+#ifdef INSTRUMENT
+			instr_name = optarg;
+#else
+			printf("Error: pagestats was built without instrumentation (make INSTRUMENT=1).\n");
+			exit(1);
+#endif
+		}
+		else {
+			printf("Error: Invalid option.\n\n%s", usage);
+			exit(1);
+		}
+	}
+	argv += optind - 1;
+	argc -= optind - 1;
 
-	/* checking the input from the command line */
-	if(argc != 5 ) {
+	if(argc < 5 ) {
 		printf("Error: Invalid number of parameters.\n\n%s", usage);
 		exit(1);
 	}
@@ -129,17 +526,51 @@ int main(int argc, char *argv[]) {
 	min_frames = atoi(argv[1]);
 	max_frames = atoi(argv[2]);
 	frame_inc  = atoi(argv[3]);
+	if (argc > 5) {
+		names = &argv[5];
+		num_algos = argc - 5;
+	}
 
-	/* verify arguments match preconditions */
-	verify_input(min_frames, max_frames, frame_inc);
-
-	/* create the input file pointer*/
-	strncpy (file_name, argv[4], 256);
-	fp = fopen(file_name, "r");
-	if(!fp) {
-		printf("Error: cannot open file %s for reading.\n", file_name);
+	/* verify arguments match preconditions, looking up each algorithm by name */
+	const struct policy ** algos = malloc(num_algos * sizeof(struct policy *));
+	if (!algos) {
+		printf("Error: cannot allocate memory for %d algorithms.\n", num_algos);
 		exit(1);
 	}
+	verify_input(min_frames, max_frames, frame_inc, names, algos, num_algos, stack_mode,
+				 sample_rate);
+	if (instr_name && (stack_mode || sample_rate > 0)) {
+		printf("Error: -s and -r cannot be given when instrumenting.\n");
+		exit(1);
+	}
+
+	/* read the page references from the input file ("-" reads stdin), in the
+	 * text or binary format (a fixed-width binary trace is mapped, not copied);
+	 * if every row is sampled, they are only streamed through the sampled pass */
+	struct trace trace = { NULL, NULL, 0, 0, NULL, 0 };
+	struct stack_profile sampled_profile, * sampled = NULL;
+	int a, streamed = (sample_rate > 0);
+	for (a = 0; a < num_algos; a++) {
+		if (!uses_sampled_pass(algos[a], sample_rate))
+			streamed = 0;
+	}
+	if (streamed) {
+		sample_trace(argv[4], max_frames, sample_rate, sample_budget, &sampled_profile);
+		sampled = &sampled_profile;
+		trace.num_pages = sampled_profile.num_pages;
+	}
+	else {
+		check_trace(trace_load(&trace, argv[4]), argv[4]);
+	}
+	for (a = 0; a < num_algos && instr_name && trace.writes; a++) {
+		if (algos[a]->writes) {
+			printf("Error: %s acts on writes, which an instrumented run treats as reads.\n",
+				   algos[a]->name);
+			exit(1);
+		}
+	}
+	page_t * page_references = trace.pages;
+	int num_pages = trace.num_pages;
 
 	/* set up for writing to output file*/
 	char * output_file = "pagerates.txt";
@@ -148,47 +579,125 @@ int main(int argc, char *argv[]) {
 		printf("Error: cannot open file %s for writing.\n", output_file);
 	}
 
-	/* read the values from the input file and accumulate them into array.  */
-	int i = 0;
-	while (fscanf( fp, "%d", &page_references[i++]) == 1);
-	fclose(fp);
-
-	/* reallocate memory store for array to correct size */
-	int num_pages = (i-1);
-	page_references = realloc(page_references, num_pages * sizeof(int));
-
 	/* first line of output file should be sequence of frames */
+	int i;
 	for (i = min_frames; i <= max_frames; i += frame_inc)
 		fprintf(tf, "%d ", i);
 	fprintf(tf, "\n");
 
-	/* run series of page replacement simulations and print out results */
-	int stats[2];
+	/* set up the series of page replacement simulations: one job per algorithm and
+	 * number of frames, or one per algorithm for rows computed by a stack pass */
+	struct sweep sw = { algos, num_algos, page_references, trace.writes, num_pages,
+						min_frames, max_frames, frame_inc, 0, stack_mode, sample_rate, sample_budget,
+						NULL, NULL, NULL, NULL, NULL, NULL, NULL, sampled, NULL, NULL };
+	for (i = min_frames; i <= max_frames; i += frame_inc)
+		sw.num_counts++;
 
-	/* start with LRU algo */
-	for (i = min_frames; i <= max_frames; i += frame_inc) {
-		lru(page_references, num_pages, i, stats, 0);
-		print_results("LRU", i, stats, tf);
+	int c, num_jobs = 0;
+	sw.job_row = malloc(num_algos * sw.num_counts * sizeof(int));
+	sw.job_col = malloc(num_algos * sw.num_counts * sizeof(int));
+	sw.job_len = malloc(num_algos * sw.num_counts * sizeof(int));
+	sw.results = malloc(num_algos * sw.num_counts * 2 * sizeof(int));
+	sw.errors = malloc(num_algos * sw.num_counts * sizeof(double));
+	sw.totals = malloc(num_algos * sw.num_counts * sizeof(long));
+	sw.writebacks = malloc(num_algos * sw.num_counts * sizeof(int));
+	long * cost = malloc(num_algos * sw.num_counts * sizeof(long));
+	if (!sw.job_row || !sw.job_col || !sw.job_len || !sw.results || !sw.errors || !sw.totals ||
+		!sw.writebacks || !cost) {
+		printf("Error: cannot allocate memory for %d simulations.\n", num_algos * sw.num_counts);
+		exit(1);
 	}
 
-	printf("\n");
-	fprintf(tf, "\n");
+	/* FIFO rows run in lockstep if the pages are small enough (and they aren't
+	 * instrumented or run with writes, which need a simulation of their own) */
+	int lockstep = !instr_name && !streamed && !trace.writes &&
+				   page_span(page_references, num_pages) <= LOCKSTEP_MAX_PAGE;
 
-	/* then execute FIFO algo */
-	for (i = min_frames; i <= max_frames; i += frame_inc) {
-		fifo(page_references, num_pages, i, stats, 0);
-		print_results("FIFO", i, stats, tf);
+#ifdef INSTRUMENT
+	struct page_ids ids;
+	if (instr_name) {
+		sw.ids = &ids;
+		sw.instr = instrument_new(num_algos * sw.num_counts);
+		if (!sw.instr || page_ids_init(&ids, page_references, num_pages) != 0) {
+			printf("Error: cannot allocate memory for instrumenting %d simulations.\n",
+				   num_algos * sw.num_counts);
+			exit(1);
+		}
 	}
-	printf("\n");
-	fprintf(tf, "\n");
+#endif
 
-	/* finally execute extra algo */
-	for (i = min_frames; i <= max_frames; i += frame_inc) {
-		extra(page_references, num_pages, i, stats, 0);
-		print_results("EXTRA", i, stats, tf);
+	for (a = 0; a < num_algos; a++) {
+		if (uses_stack_pass(algos[a], stack_mode, sample_rate)) {
+			sw.job_row[num_jobs] = a;
+			sw.job_col[num_jobs] = -1;
+			sw.job_len[num_jobs] = sw.num_counts;
+			cost[num_jobs++] = job_cost(algos[a], max_frames, 1);
+			continue;
+		}
+		if (lockstep && algos[a] == &fifo_policy) {
+			for (c = 0; c < sw.num_counts; c += LOCKSTEP_LANES) {
+				sw.job_row[num_jobs] = a;
+				sw.job_col[num_jobs] = c;
+				sw.job_len[num_jobs] = (sw.num_counts - c < LOCKSTEP_LANES) ?
+									   sw.num_counts - c : LOCKSTEP_LANES;
+				cost[num_jobs++] = 1;
+			}
+			continue;
+		}
+		for (c = 0; c < sw.num_counts; c++) {
+			sw.job_row[num_jobs] = a;
+			sw.job_col[num_jobs] = c;
+			sw.job_len[num_jobs] = 1;
+			cost[num_jobs++] = job_cost(algos[a], min_frames + c * frame_inc, 0);
+		}
 	}
-	printf("\n");
-	fprintf(tf, "\n");
+
+	/* run them (possibly in parallel), then print out results in order,
+	 * one line per algorithm (labelled as its policy says) */
+	if (run_jobs(num_jobs, cost, num_threads, run_sweep_job, &sw) != 0) {
+		printf("Error: cannot allocate memory for %d threads.\n", num_threads);
+		exit(1);
+	}
+
+	for (a = 0; a < num_algos; a++) {
+		long * totals = &sw.totals[a * sw.num_counts];
+		for (c = 0; c < sw.num_counts; c++)
+			print_results(algos[a]->label, min_frames + c * frame_inc,
+						  &sw.results[(a * sw.num_counts + c) * 2], tf,
+						  sw.errors[a * sw.num_counts + c], sw.writebacks[a * sw.num_counts + c]);
+
+		/* Belady's anomaly: more frames, yet more faults from empty memory */
+		for (c = 1; c < sw.num_counts; c++) {
+			if (totals[c - 1] >= 0 && totals[c] > totals[c - 1])
+				printf("Belady's anomaly: %s faults %ld times with %d frames, but %ld times with %d\n",
+					   algos[a]->label, totals[c], min_frames + c * frame_inc, totals[c - 1],
+					   min_frames + (c - 1) * frame_inc);
+		}
+		printf("\n");
+		fprintf(tf, "\n");
+	}
+
+	/* with writes, the write-back rates follow, a row per algorithm in the same order */
+	for (a = 0; a < num_algos && trace.writes; a++) {
+		for (c = 0; c < sw.num_counts; c++) {
+			int * stats = &sw.results[(a * sw.num_counts + c) * 2];
+			int writebacks = sw.writebacks[a * sw.num_counts + c];
+			fprintf(tf, "%3.2f ", (writebacks < 0 || stats[1] == 0) ? NAN :
+					((double) writebacks / stats[1]) * 100);
+		}
+		fprintf(tf, "\n");
+	}
+
+#ifdef INSTRUMENT
+	if (instr_name) {
+		if (instrument_write(instr_name, sw.instr, num_algos * sw.num_counts) != 0) {
+			printf("Error: cannot write file %s.\n", instr_name);
+			exit(1);
+		}
+		page_ids_free(&ids);
+		free(sw.instr);
+	}
+#endif
 
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "trace.h"
+#include "workingset.h"
+
+#define WSS_ROWS 50		/* intervals the references are cut into by default */
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * pagewss reads a sequence of pages from the provided input file, and prints how
+ * the size of its working set changes over the course of it, for a range of
+ * working set windows tau (i.e., 100, 200, 300, 400, in the example pagewss 100
+ * 400 100 page_refs.txt). The working set of window tau at a reference is the set
+ * of distinct pages among the last tau references; its size is how much memory the
+ * references need at that point to fault only when they move on to new pages.
+ *
+ * Every window is computed in the same single pass over the references (see
+ * wss_timeline in workingset.c). The references are cut into intervals (-i, or 50
+ * of them by default), and each row gives the mean working set size of each window
+ * over one interval; the last rows give the mean and largest size over the whole
+ * run.
+ *
+ * Usage:
+ *   pagewss [-i interval] min_tau max_tau tau_inc file
+ *
+ * pagewss accepts four command line arguments, plus an optional interval
+ * -i - (optional) the number of references per row (default: a 50th of them)
+ * min_tau - the smallest window (positive integer)
+ * max_tau - the largest window
+ * tau_inc - the window increment (positive integer)
+ * file - the name of the input file that contains a list of page references
+ *        (any length, text or binary; "-" reads them from stdin)
+ */
+
+//======================================================//
+const char * usage = "Usage:"
+"  pagewss [-i interval] min_tau max_tau tau_inc file \n"
+"\n"
+"pagewss accepts four command line arguments, plus an optional interval \n"
+"-i - (optional) the number of references per row (default: a 50th of them) \n"
+"min_tau - the smallest window (positive integer) \n"
+"max_tau - the largest window \n"
+"tau_inc - the window increment (positive integer) \n"
+"file - the name of the input file that contains a list of page references \n"
+"       (any length, text or binary; \"-\" reads them from stdin) \n"
+"\n"
+"\n";
+//======================================================//
+
+/*
+ * Main function for the pagewss application. This function takes in the four
+ * command line arguments specified above in the file comments, computes the
+ * working set size of every window over the references, and prints it out as a
+ * table with a column per window.
+ */
+int main(int argc, char *argv[]) {
+
+	int min_tau, max_tau, tau_inc;	/* the windows: min_tau, +tau_inc, ..., <= max_tau */
+	int interval = 0;				/* references per row (-i) */
+	int opt, i, k;
+
+	/* checking the options, then the rest of the input from the command line */
+	while ((opt = getopt(argc, argv, "i:")) != -1) {
+		if (opt == 'i') {
+			interval = atoi(optarg);
+			if (interval < 1) {
+				printf("Error: interval must be a positive integer; received %s\n", optarg);
+				exit(1);
+			}
+		}
+		else {
+			printf("Error: Invalid option.\n\n%s", usage);
+			exit(1);
+		}
+	}
+	argv += optind - 1;
+	argc -= optind - 1;
+
+	if (argc != 5) {
+		printf("Error: Invalid number of parameters.\n\n%s", usage);
+		exit(1);
+	}
+
+	min_tau = atoi(argv[1]);
+	max_tau = atoi(argv[2]);
+	tau_inc = atoi(argv[3]);
+	if (min_tau < 1) {
+		printf("Error: smallest window must be a positive integer; received %s\n", argv[1]);
+		exit(1);
+	}
+	if (min_tau > max_tau) {
+		printf("Error: smallest window cannot be larger than the largest window\n");
+		exit(1);
+	}
+	if (tau_inc < 1) {
+		printf("Error: window increment must be a positive integer; received %s\n", argv[3]);
+		exit(1);
+	}
+
+	/* read the page references from the input file ("-" reads stdin) */
+	struct trace trace;
+	int err = trace_load(&trace, argv[4]);
+	if (err == TRACE_ERR_OPEN) {
+		printf("Error: cannot open file %s for reading.\n", argv[4]);
+		exit(1);
+	}
+	else if (err == TRACE_ERR_MEMORY) {
+		printf("Error: cannot allocate memory for the page references in %s.\n", argv[4]);
+		exit(1);
+	}
+	else if (err == TRACE_ERR_FORMAT) {
+		printf("Error: %s is not a valid trace file.\n", argv[4]);
+		exit(1);
+	}
+	if (trace.num_pages == 0) {
+		printf("Error: %s holds no page references.\n", argv[4]);
+		exit(1);
+	}
+	if (interval == 0)
+		interval = (trace.num_pages + WSS_ROWS - 1) / WSS_ROWS;
+
+	/* the windows, and room for a row of means per interval */
+	int num_taus = (max_tau - min_tau) / tau_inc + 1;
+	int num_rows = (trace.num_pages + interval - 1) / interval;
+	int * taus = malloc(num_taus * sizeof(int));
+	int * peaks = malloc(num_taus * sizeof(int));
+	double * means = malloc((size_t) num_rows * num_taus * sizeof(double));
+	if (!taus || !peaks || !means) {
+		printf("Error: cannot allocate memory for %d windows.\n", num_taus);
+		exit(1);
+	}
+	for (k = 0; k < num_taus; k++)
+		taus[k] = min_tau + k * tau_inc;
+
+	if (wss_timeline(trace.pages, trace.num_pages, taus, num_taus, interval, means,
+					 peaks) != 0) {
+		printf("Error: cannot allocate memory for the working set pass.\n");
+		exit(1);
+	}
+
+	/* a row per interval (labelled by its last reference), then the whole run */
+	char label[32];
+	printf("%10s", "reference");
+	for (k = 0; k < num_taus; k++) {
+		snprintf(label, sizeof(label), "tau=%d", taus[k]);
+		printf("  %11s", label);
+	}
+	printf("\n");
+	for (i = 0; i < num_rows; i++) {
+		long end = (i == num_rows - 1) ? trace.num_pages : (long) (i + 1) * interval;
+		printf("%10ld", end);
+		for (k = 0; k < num_taus; k++)
+			printf("  %11.2f", means[(size_t) i * num_taus + k]);
+		printf("\n");
+	}
+
+	printf("\n%10s", "mean");
+	for (k = 0; k < num_taus; k++) {
+		double sum = 0;
+		for (i = 0; i < num_rows; i++) {
+			int refs = (i == num_rows - 1) ? trace.num_pages - i * interval : interval;
+			sum += means[(size_t) i * num_taus + k] * refs;
+		}
+		printf("  %11.2f", sum / trace.num_pages);
+	}
+	printf("\n%10s", "max");
+	for (k = 0; k < num_taus; k++)
+		printf("  %11d", peaks[k]);
+	printf("\n");
+
+	free(taus);
+	free(peaks);
+	free(means);
+	return 0;
+}
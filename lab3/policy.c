@@ -0,0 +1,364 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "algorithms.h"
+#include "adaptive.h"
+#include "clock.h"
+#include "display.h"
+#include "workingset.h"
+#include "policy.h"
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * policy holds the table of page replacement policies, and the driver that runs
+ * one of them over a reference string. Each policy is described by a struct
+ * policy (see policy.h): its name, and the entry points of the engine that
+ * simulates it. pagesim and pagestats only go through this table, so a new
+ * policy is added by writing its engine and listing it in policies below.
+ *
+ * The driver hands a whole reference string to the engine's access_batch entry
+ * point, so the engine's own loop runs it with no call per reference and no
+ * verbose check per reference; only verbose runs go one reference at a time,
+ * either displaying each one or recording it in an event log (see display.c).
+ *
+ * References that write their page go one at a time as well (simulate_writes): the
+ * engine is told each one is a write (engine->writing), which the engines that keep
+ * dirty bits of their own act on (cflru and wsclock), and a struct dirty_pages
+ * follows which of the pages the engine holds are dirty, counting a write-back
+ * whenever one of those is replaced or let go, or cleaned ahead of time by the
+ * engine (wsclock). It only needs what every engine reports anyway, so write-backs
+ * are counted the same way for every policy, in O(1) per reference.
+ *
+ * Usage:
+ *   Compile with another file; there is no main function
+ */
+
+//======================================================//
+
+/* every registered policy, in the order they are listed */
+const struct policy *policies[] = {
+	&lru_policy,
+	&fifo_policy,
+	&extra_policy,
+	&fastlru_policy,
+	&fastextra_policy,
+	&arc_policy,
+	&twoq_policy,
+	&lirs_policy,
+	&clock_policy,
+	&gclock_policy,
+	&clockpro_policy,
+	&wsclock_policy,
+	&ws_policy,
+	&pff_policy,
+	&cflru_policy,
+	NULL
+};
+
+/*
+ * Function to look up a policy by name.
+ *		:param name: the name of the policy (e.g., "fastlru")
+ * **Returns**: the policy, or NULL if no policy has that name
+ */
+const struct policy * find_policy(const char *name) {
+	int i;
+	for (i = 0; policies[i]; i++) {
+		if (strcmp(policies[i]->name, name) == 0)
+			return policies[i];
+	}
+	return NULL;
+}
+
+/*
+ * Function to print the names of every policy to stdout, as a list for an error
+ * message (e.g., "lru, fifo, or extra").
+ */
+void print_policy_names(void) {
+	int i;
+	for (i = 0; policies[i]; i++) {
+		if (i > 0)
+			printf(policies[i + 1] ? ", " : (i > 1 ? ", or " : " or "));
+		printf("%s", policies[i]->name);
+	}
+}
+
+/*
+ * Function to set up an engine for a tool, which can't go on without one.
+ *		:param policy: the policy to set up
+ *		:param arr: the whole reference string (see struct policy's init)
+ *		:param arr_size: the number of references
+ *		:param frame_num: the number of frames in physical memory
+ * **Returns**: the engine (exits with an error message if memory runs out)
+ */
+struct engine * engine_new(const struct policy *policy, page_t arr[], int arr_size,
+						   int frame_num) {
+	struct engine *engine = policy->init(arr, arr_size, frame_num);
+	if (!engine) {
+		printf("Error: cannot allocate memory for %d frames.\n", frame_num);
+		exit(1);
+	}
+	return engine;
+}
+
+/*
+ * Function to run a policy over a whole reference string.
+ *		:param policy: the policy to run
+ *		:param arr: an array of pages to be allocated
+ *		:param arr_size: the number of pages to be allocated
+ *		:param frame_num: the number of frames in physical memory
+ *		:param stats: an array which will eventually store the number of page faults
+ *					  for this run of the algorithm (at index 0), and the number of
+ *					  references (at index 1). These are then used in by the caller
+ *					  to calculate the miss rate
+ *		:param verbose: "boolean" to indicate whether to run in verbose mode or not;
+ *						if so, then each allocation process is displayed.
+ */
+void simulate(const struct policy *policy, page_t arr[], int arr_size, int frame_num,
+			  int stats[], int verbose) {
+
+	struct engine *engine = engine_new(policy, arr, arr_size, frame_num);
+
+	if (verbose) {
+		int i, faulted;
+		for (i = 0; i < arr_size; i++) {
+			faulted = policy->access(engine, arr[i]);
+			display(engine->frames, frame_num, arr[i], (faulted && engine->is_filled));
+		}
+		display_flush();
+	}
+	else {
+		policy->access_batch(engine, arr, arr_size);
+	}
+
+	policy->stats(engine, stats);
+	policy->destroy(engine);
+}
+
+/*
+ * Function to run a policy over a whole reference string, recording each
+ * reference in an event log instead of displaying it.
+ *		:param policy: the policy to run
+ *		:param arr: an array of pages to be allocated
+ *		:param arr_size: the number of pages to be allocated
+ *		:param frame_num: the number of frames in physical memory
+ *		:param stats: an array which will store the number of page faults (index 0)
+ *					  and the number of references (index 1)
+ *		:param log: the event log (opened with frame_num frames)
+ * **Returns**: 0, or TRACE_ERR_OPEN if writing the log fails
+ */
+int simulate_logged(const struct policy *policy, page_t arr[], int arr_size, int frame_num,
+					int stats[], struct event_log *log) {
+
+	struct engine *engine = engine_new(policy, arr, arr_size, frame_num);
+	int i, j, slot, faulted, err = 0;
+
+	/* frames emptied by a reference are logged (as a PAGE_NONE event) ahead of it */
+	engine->released = malloc((frame_num + 1) * sizeof(int));
+	if (!engine->released) {
+		printf("Error: cannot allocate memory for %d frames.\n", frame_num);
+		exit(1);
+	}
+
+	for (i = 0; i < arr_size && err == 0; i++) {
+		engine->num_released = 0;
+		faulted = policy->access(engine, arr[i]);
+		for (j = 0; j < engine->num_released && err == 0; j++)
+			err = event_log_put(log, PAGE_NONE, engine->released[j]);
+		if (!faulted)
+			slot = EVENT_HIT;
+		else
+			slot = (frame_num > 0) ? engine->slot : EVENT_NO_FRAME;
+		if (err == 0)
+			err = event_log_put(log, arr[i], slot);
+	}
+
+	free(engine->released);
+	engine->released = NULL;
+	policy->stats(engine, stats);
+	policy->destroy(engine);
+	return err;
+}
+
+/*
+ * Function to run a policy over a whole reference string in which some references
+ * write their page, counting the write-backs of dirty pages as well.
+ *		:param policy: the policy to run
+ *		:param arr: an array of pages to be allocated
+ *		:param writes: whether each reference writes its page
+ *		:param arr_size: the number of pages to be allocated
+ *		:param frame_num: the number of frames in physical memory
+ *		:param stats: an array which will store the number of page faults (index 0),
+ *					  the number of references (index 1), and the number of
+ *					  write-backs (index 2)
+ *		:param verbose: "boolean"; display each reference (as simulate does)
+ */
+void simulate_writes(const struct policy *policy, page_t arr[], const unsigned char writes[],
+					 int arr_size, int frame_num, int stats[], int verbose) {
+
+	struct engine *engine = engine_new(policy, arr, arr_size, frame_num);
+	struct dirty_pages dirty;
+	int i, faulted;
+
+	engine->released = malloc((frame_num + 1) * sizeof(int));
+	if (!engine->released || dirty_init(&dirty, engine, page_span(arr, arr_size)) != 0) {
+		printf("Error: cannot allocate memory for %d frames.\n", frame_num);
+		exit(1);
+	}
+
+	for (i = 0; i < arr_size; i++) {
+		engine->num_released = 0;
+		engine->writing = writes[i];
+		faulted = policy->access(engine, arr[i]);
+		if (dirty_update(&dirty, engine, arr[i], writes[i], faulted) < 0) {
+			printf("Error: cannot allocate memory for the dirty pages.\n");
+			exit(1);
+		}
+		if (verbose)
+			display(engine->frames, frame_num, arr[i], (faulted && engine->is_filled));
+	}
+	if (verbose)
+		display_flush();
+
+	free(engine->released);
+	engine->released = NULL;
+	policy->stats(engine, stats);
+	stats[2] = dirty.num_writebacks;
+	policy->destroy(engine);
+	dirty_free(&dirty);
+}
+
+/*
+ * Function to set up the state every engine shares: frame_num empty frames (and
+ * the spare slot), and no references counted yet.
+ *		:param engine: the engine to set up
+ *		:param frame_num: the number of frames in physical memory
+ * **Returns**: 0, or -1 if memory could not be allocated for the frames
+ */
+int engine_init(struct engine *engine, int frame_num) {
+	int i;
+	engine->frame_num = frame_num;
+	engine->frames = malloc((frame_num + 1) * sizeof(page_t));
+	if (!engine->frames)
+		return -1;
+	for (i = 0; i <= frame_num; i++)
+		engine->frames[i] = PAGE_NONE;
+	engine->num_allocated = 0;
+	engine->is_filled = 0;
+	engine->num_faults = 0;
+	engine->num_refs = 0;
+	engine->slot = -1;
+	engine->released = NULL;
+	engine->num_released = 0;
+	engine->cleaned = NULL;
+	engine->num_cleaned = 0;
+	engine->writing = 0;
+	return 0;
+}
+
+/*
+ * Function to read the counts of an engine (the stats entry point every engine
+ * here shares).
+ *		:param engine: the engine
+ *		:param stats: an array which will store the number of page faults (index 0)
+ *					  and the number of references (index 1)
+ */
+void engine_stats(struct engine *engine, int stats[]) {
+	stats[0] = engine->num_faults;
+	stats[1] = engine->num_refs;
+}
+
+/*
+ * Function to release the state every engine shares.
+ *		:param engine: the engine
+ */
+void engine_free(struct engine *engine) {
+	free(engine->frames);
+	free(engine->cleaned);
+	engine->frames = NULL;
+	engine->cleaned = NULL;
+}
+
+/*
+ * Function to start following the dirty pages of an engine, from the pages its
+ * frames hold now (all of them clean).
+ *		:param dirty: the dirty pages to set up
+ *		:param engine: the engine
+ *		:param span: one more than the largest page referenced, if known (else 0)
+ * **Returns**: 0 on success, -1 if memory could not be allocated
+ */
+int dirty_init(struct dirty_pages *dirty, const struct engine *engine, page_t span) {
+	dirty->held = malloc((engine->frame_num + 1) * sizeof(page_t));
+	if (!dirty->held || pagemap_init(&dirty->dirty, engine->frame_num, span) != 0) {
+		free(dirty->held);
+		return -1;
+	}
+	memcpy(dirty->held, engine->frames, (engine->frame_num + 1) * sizeof(page_t));
+	dirty->num_writebacks = 0;
+	return 0;
+}
+
+/*
+ * Function to write a page back if it is dirty, as it leaves memory (or as the
+ * engine cleans it).
+ *		:param dirty: the dirty pages
+ *		:param page: the page leaving (PAGE_NONE if the slot was empty)
+ * **Returns**: 1 if the page had to be written back, else 0
+ */
+static int write_back(struct dirty_pages *dirty, page_t page) {
+	if (page == PAGE_NONE || pagemap_get(&dirty->dirty, page) == -1)
+		return 0;
+	pagemap_remove(&dirty->dirty, page);
+	return 1;
+}
+
+/*
+ * Function to follow one reference an engine has just handled. The engine must
+ * have been given room for the slots it releases (engine->released), emptied before
+ * the reference. Pages the engine cleaned (engine->cleaned) are written back and
+ * stay held.
+ *		:param dirty: the dirty pages
+ *		:param engine: the engine
+ *		:param page: the page referenced
+ *		:param write: "boolean"; the reference writes the page
+ *		:param faulted: "boolean"; the reference faulted
+ * **Returns**: the number of dirty pages written back because of it (counted or not),
+ *				or -1 if memory could not be allocated to mark the page dirty (the
+ *				write-backs are still counted; the page is then followed as clean)
+ */
+int dirty_update(struct dirty_pages *dirty, struct engine *engine, page_t page, int write,
+				 int faulted) {
+	int writebacks = 0, i, slot;
+
+	for (i = 0; i < engine->num_cleaned; i++)
+		writebacks += write_back(dirty, dirty->held[engine->cleaned[i]]);
+	for (i = 0; i < engine->num_released; i++) {
+		slot = engine->released[i];
+		writebacks += write_back(dirty, dirty->held[slot]);
+		dirty->held[slot] = PAGE_NONE;
+	}
+	if (faulted && engine->frame_num > 0) {
+		writebacks += write_back(dirty, dirty->held[engine->slot]);
+		dirty->held[engine->slot] = page;
+	}
+
+	if (engine->is_filled)
+		dirty->num_writebacks += writebacks;
+
+	/* with no frames, the page is never held, so there is nothing to write back */
+	if (write && (!faulted || engine->frame_num > 0) &&
+		pagemap_put(&dirty->dirty, page, 1) != 0)
+		return -1;
+	return writebacks;
+}
+
+/*
+ * Function to release the memory held to follow an engine's dirty pages.
+ *		:param dirty: the dirty pages
+ */
+void dirty_free(struct dirty_pages *dirty) {
+	pagemap_destroy(&dirty->dirty);
+	free(dirty->held);
+}
@@ -0,0 +1,132 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+#include "page.h"
+#include "pagemap.h"
+
+#define MAX_MEMORY_FRAMES 100			/* frame limit of the original (scanning) engines */
+#define MAX_FAST_MEMORY_FRAMES 16777216	/* frame limit of the heap-based engines */
+
+struct stack_profile;
+struct event_log;
+
+/* state every replacement engine shares; each engine's own state struct starts
+ * with one of these, so a pointer to either is a pointer to both */
+struct engine {
+	int frame_num;		/* number of frames in physical memory */
+	page_t *frames;		/* page held by each slot (PAGE_NONE if unallocated), plus one
+						   spare slot so display works when there are no frames */
+	int num_allocated;	/* pages allocated into a frame so far (every fault, counted or not) */
+	int is_filled;		/* "boolean"; memory has filled up, so references and faults count */
+	int num_faults;		/* page faults counted so far */
+	int num_refs;		/* page references counted so far */
+	int slot;			/* frame slot the last page to fault was loaded into (-1 if none) */
+	int *released;		/* slots emptied without a page being loaded into them (by the
+						   engines whose resident sets shrink), since the caller last
+						   looked; NULL unless the caller supplies room for frame_num */
+	int num_released;
+	int *cleaned;		/* slots whose dirty page the latest reference wrote back while
+						   it stays resident (by the engines that clean pages ahead of
+						   evicting them, wsclock); NULL for the others */
+	int num_cleaned;
+	int writing;		/* "boolean"; the page being referenced is written (set by the
+						   caller before access; only engines that keep dirty bits look) */
+};
+
+/* the dirty pages among those an engine holds, followed from what every engine
+ * reports (the slot each fault loaded, and the slots it released), so that any
+ * engine's write-backs can be counted */
+struct dirty_pages {
+	page_t *held;			/* page held by each slot */
+	struct pagemap dirty;	/* held pages written since they were loaded */
+	int num_writebacks;		/* dirty pages replaced or let go, counted once memory has
+							   filled up (as faults are) */
+};
+
+/* a page replacement policy: a name, and the entry points of the engine that runs it */
+struct policy {
+	const char *name;	/* name the policy is chosen by on the command line */
+	const char *label;	/* label of the policy's rows in pagestats' output */
+	int max_frames;		/* largest number of frames the engine supports */
+	int cost_exp;		/* work per reference grows as frame_num to this power (for
+						   scheduling pagestats' jobs, most expensive first) */
+	int lookahead;		/* "boolean"; the engine reads ahead in the reference string (an
+						   offline policy), so it can't run on references as they arrive */
+	int writes;			/* "boolean"; the engine acts on which references write their page
+						   (engine->writing: cflru, wsclock), so wherever some do it has
+						   to be run a reference at a time; its access_batch runs every
+						   reference as a read */
+
+	/* stack distance pass that gives every number of frames at once (see
+	 * stackdist.c), or NULL if the policy is not a stack algorithm */
+	int (*profile)(page_t arr[], int arr_size, int max_depth, struct stack_profile *profile);
+
+	/* set up an engine with frame_num empty frames; arr is the whole reference
+	 * string, which the offline policies read ahead in, and which access must then
+	 * be given in order; without lookahead, arr may be NULL (arr_size 0) when the
+	 * references aren't known yet. Returns NULL if memory runs out (the tools set up
+	 * their engines with engine_new, which exits instead) */
+	struct engine * (*init)(page_t arr[], int arr_size, int frame_num);
+	/* reference one page; returns 1 if it faulted (counted or not), else 0 */
+	int (*access)(struct engine *engine, page_t page);
+	/* reference a block of pages, without reporting on each one (all of them reads) */
+	void (*access_batch)(struct engine *engine, page_t pages[], int count);
+	/* store the faults (index 0) and references (index 1) counted so far */
+	void (*stats)(struct engine *engine, int stats[]);
+	/* release the engine */
+	void (*destroy)(struct engine *engine);
+};
+
+/* every registered policy, in the order they are listed; NULL terminated */
+extern const struct policy *policies[];
+
+const struct policy * find_policy(const char *name);
+void print_policy_names(void);
+struct engine * engine_new(const struct policy *policy, page_t arr[], int arr_size,
+						   int frame_num);
+void simulate(const struct policy *policy, page_t arr[], int arr_size, int frame_num,
+			  int stats[], int verbose);
+int simulate_logged(const struct policy *policy, page_t arr[], int arr_size, int frame_num,
+					int stats[], struct event_log *log);
+void simulate_writes(const struct policy *policy, page_t arr[], const unsigned char writes[],
+					 int arr_size, int frame_num, int stats[], int verbose);
+int engine_init(struct engine *engine, int frame_num);
+void engine_stats(struct engine *engine, int stats[]);
+void engine_free(struct engine *engine);
+int dirty_init(struct dirty_pages *dirty, const struct engine *engine, page_t span);
+int dirty_update(struct dirty_pages *dirty, struct engine *engine, page_t page, int write,
+				 int faulted);
+void dirty_free(struct dirty_pages *dirty);
+
+/*
+ * Function to count one reference the way every engine does: references (and
+ * faults) only count once memory has filled up. Engines call it after handling a
+ * reference, before their num_allocated is bumped (it does that itself).
+ *		:param engine: the engine that handled the reference
+ *		:param faulted: "boolean"; the reference was not in memory
+ */
+static inline void engine_count(struct engine *engine, int faulted) {
+	if (engine->is_filled || engine->num_allocated >= engine->frame_num) {
+		engine->is_filled = 1;
+		engine->num_refs++;
+	}
+	if (faulted) {
+		engine->num_allocated++;
+		if (engine->is_filled)
+			engine->num_faults++;
+	}
+}
+
+/*
+ * Function to empty a frame without loading another page into it (the resident
+ * set shrinks), noting the slot if the caller asked to see such slots.
+ *		:param engine: the engine
+ *		:param slot: the frame slot
+ */
+static inline void engine_release(struct engine *engine, int slot) {
+	engine->frames[slot] = PAGE_NONE;
+	if (engine->released)
+		engine->released[engine->num_released++] = slot;
+}
+
+#endif
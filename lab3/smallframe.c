@@ -0,0 +1,425 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SMALL_X86
+#include <immintrin.h>
+#endif
+#include "algorithms.h"
+#include "smallframe.h"
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * smallframe holds fixed-width versions of the LRU and optimal (extra) engines for
+ * small numbers of frames, which lru and extra switch to when frame_num is at most
+ * SMALL_MAX_FRAMES. The frames are a fixed-size array of lanes (frame_num rounded
+ * up to a multiple of 8), and each width gets its own copy of the engines' loops
+ * (generated by SMALL_ENGINES below), so every loop over the frames has a constant
+ * trip count the compiler can unroll and keep in registers.
+ *
+ * Every width is also built once per instruction set: with AVX2, with SSE2, and in
+ * plain C. small_frames_new picks the best one the CPU supports (with
+ * __builtin_cpu_supports), so the tools use AVX2 without being built with -mavx2,
+ * and still run on CPUs without it. Finding a page compares it against all the
+ * lanes without branching: four lanes per AVX2 compare, or two per SSE2 compare
+ * (SSE2 has no 64-bit compare, so both 32-bit halves have to match), their masks
+ * combined into one whose lowest set bit is the frame. Finding the victim takes
+ * the smallest (or largest) stamp of all the lanes the same way, eight or four at a
+ * time, and then the first lane holding it.
+ *
+ * The LRU engine keeps the time each lane was last used instead of ageing every
+ * frame on every reference, and the victim is the lane used longest ago (empty
+ * lanes have time 0, so they are filled first, in order, as lru fills them). The
+ * optimal engine keeps the time each lane is next used (from next_use) instead of
+ * reading ahead on every fault, and the victim is the lane used latest, or the
+ * first of those never used again, as find_opt picks it. Padding lanes have a
+ * time that can never be chosen. Both give exactly the same results as the
+ * engines in algorithms.c.
+ *
+ * Usage:
+ *   Compile with another file; there is no main function
+ */
+
+//======================================================//
+
+/* the instruction sets each width is built for, best last */
+#define SMALL_PLAIN 0
+#define SMALL_SSE2 1
+#define SMALL_AVX2 2
+
+#define SMALL_WIDTHS (SMALL_MAX_FRAMES / 8)	/* widths built: 8, 16, ..., SMALL_MAX_FRAMES */
+
+/*
+ * Function to find the lane holding a page, in plain C.
+ *		:param lane: the lanes
+ *		:param width: the number of lanes (a multiple of 8)
+ *		:param page: the page to look for
+ * **Returns**: the lane holding the page, or -1 if none does
+ */
+static inline int find_lane_plain(const page_t lane[], int width, page_t page) {
+	int i;
+	for (i = 0; i < width; i++) {
+		if (lane[i] == page)
+			return i;
+	}
+	return -1;
+}
+
+/*
+ * Function to find the first lane with the smallest stamp, in plain C.
+ *		:param stamp: the stamps
+ *		:param width: the number of lanes
+ * **Returns**: the lane
+ */
+static inline int min_lane_plain(const int stamp[], int width) {
+	int i, best = 0;
+	for (i = 1; i < width; i++) {
+		if (stamp[i] < stamp[best])
+			best = i;
+	}
+	return best;
+}
+
+/*
+ * Function to find the first lane with the largest stamp, in plain C.
+ *		:param stamp: the stamps
+ *		:param width: the number of lanes
+ * **Returns**: the lane
+ */
+static inline int max_lane_plain(const int stamp[], int width) {
+	int i, best = 0;
+	for (i = 1; i < width; i++) {
+		if (stamp[i] > stamp[best])
+			best = i;
+	}
+	return best;
+}
+
+#ifdef SMALL_X86
+#define SSE2_TARGET __attribute__((target("sse2")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+/*
+ * Function to find the lane holding a page, two lanes per SSE2 compare.
+ *		:param lane: the lanes
+ *		:param width: the number of lanes (a multiple of 8)
+ *		:param page: the page to look for
+ * **Returns**: the lane holding the page, or -1 if none does
+ */
+static inline SSE2_TARGET int find_lane_sse2(const page_t lane[], int width, page_t page) {
+	__m128i wanted = _mm_set1_epi64x((long long) page);
+	uint64_t mask = 0;
+	int i;
+	#pragma GCC unroll 32
+	for (i = 0; i < width; i += 2) {
+		__m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) &lane[i]), wanted);
+		eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+		mask |= (uint64_t) _mm_movemask_pd(_mm_castsi128_pd(eq)) << i;
+	}
+	return mask ? __builtin_ctzll(mask) : -1;
+}
+
+/*
+ * Function to pick, lane by lane, the smaller or larger of two vectors of stamps
+ * (SSE2 has no 32-bit min or max, so it is a compare and a select).
+ *		:param a: the first stamps
+ *		:param b: the second stamps
+ *		:param larger: "boolean"; pick the larger stamps, not the smaller
+ * **Returns**: the stamps picked
+ */
+static inline SSE2_TARGET __m128i pick_sse2(__m128i a, __m128i b, int larger) {
+	__m128i take_b = larger ? _mm_cmpgt_epi32(b, a) : _mm_cmpgt_epi32(a, b);
+	return _mm_or_si128(_mm_and_si128(take_b, b), _mm_andnot_si128(take_b, a));
+}
+
+/*
+ * Function to find the first lane with the smallest or largest stamp, four lanes
+ * per SSE2 instruction.
+ *		:param stamp: the stamps
+ *		:param width: the number of lanes (a multiple of 8)
+ *		:param larger: "boolean"; find the largest stamp, not the smallest
+ * **Returns**: the lane
+ */
+static inline SSE2_TARGET int pick_lane_sse2(const int stamp[], int width, int larger) {
+	__m128i best = _mm_loadu_si128((const __m128i *) stamp);
+	int i, mask;
+	#pragma GCC unroll 32
+	for (i = 4; i < width; i += 4)
+		best = pick_sse2(best, _mm_loadu_si128((const __m128i *) &stamp[i]), larger);
+	best = pick_sse2(best, _mm_shuffle_epi32(best, _MM_SHUFFLE(1, 0, 3, 2)), larger);
+	best = pick_sse2(best, _mm_shuffle_epi32(best, _MM_SHUFFLE(2, 3, 0, 1)), larger);
+	for (i = 0; i < width; i += 4) {
+		__m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) &stamp[i]), best);
+		mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+		if (mask)
+			return i + __builtin_ctz(mask);
+	}
+	return 0;
+}
+
+static inline SSE2_TARGET int min_lane_sse2(const int stamp[], int width) {
+	return pick_lane_sse2(stamp, width, 0);
+}
+
+static inline SSE2_TARGET int max_lane_sse2(const int stamp[], int width) {
+	return pick_lane_sse2(stamp, width, 1);
+}
+
+/*
+ * Function to find the lane holding a page, four lanes per AVX2 compare.
+ *		:param lane: the lanes
+ *		:param width: the number of lanes (a multiple of 8)
+ *		:param page: the page to look for
+ * **Returns**: the lane holding the page, or -1 if none does
+ */
+static inline AVX2_TARGET int find_lane_avx2(const page_t lane[], int width, page_t page) {
+	__m256i wanted = _mm256_set1_epi64x((long long) page);
+	uint64_t mask = 0;
+	int i;
+	#pragma GCC unroll 32
+	for (i = 0; i < width; i += 4) {
+		__m256i eq = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *) &lane[i]), wanted);
+		mask |= (uint64_t) _mm256_movemask_pd(_mm256_castsi256_pd(eq)) << i;
+	}
+	return mask ? __builtin_ctzll(mask) : -1;
+}
+
+/*
+ * Function to pick, lane by lane, the smaller or larger of two vectors of stamps.
+ *		:param a: the first stamps
+ *		:param b: the second stamps
+ *		:param larger: "boolean"; pick the larger stamps, not the smaller
+ * **Returns**: the stamps picked
+ */
+static inline AVX2_TARGET __m256i pick_avx2(__m256i a, __m256i b, int larger) {
+	return larger ? _mm256_max_epi32(a, b) : _mm256_min_epi32(a, b);
+}
+
+/*
+ * Function to find the first lane with the smallest or largest stamp, eight lanes
+ * per AVX2 instruction.
+ *		:param stamp: the stamps
+ *		:param width: the number of lanes (a multiple of 8)
+ *		:param larger: "boolean"; find the largest stamp, not the smallest
+ * **Returns**: the lane
+ */
+static inline AVX2_TARGET int pick_lane_avx2(const int stamp[], int width, int larger) {
+	__m256i best = _mm256_loadu_si256((const __m256i *) stamp);
+	int i, mask;
+	#pragma GCC unroll 32
+	for (i = 8; i < width; i += 8)
+		best = pick_avx2(best, _mm256_loadu_si256((const __m256i *) &stamp[i]), larger);
+	best = pick_avx2(best, _mm256_permute2x128_si256(best, best, 1), larger);
+	best = pick_avx2(best, _mm256_shuffle_epi32(best, _MM_SHUFFLE(1, 0, 3, 2)), larger);
+	best = pick_avx2(best, _mm256_shuffle_epi32(best, _MM_SHUFFLE(2, 3, 0, 1)), larger);
+	for (i = 0; i < width; i += 8) {
+		__m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) &stamp[i]), best);
+		mask = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+		if (mask)
+			return i + __builtin_ctz(mask);
+	}
+	return 0;
+}
+
+static inline AVX2_TARGET int min_lane_avx2(const int stamp[], int width) {
+	return pick_lane_avx2(stamp, width, 0);
+}
+
+static inline AVX2_TARGET int max_lane_avx2(const int stamp[], int width) {
+	return pick_lane_avx2(stamp, width, 1);
+}
+#endif
+
+/*
+ * Function to load a page into a lane, replacing whatever it held.
+ *		:param engine: the engine the frames belong to
+ *		:param s: the frames
+ *		:param at: the lane
+ *		:param page: the page
+ */
+static inline void load_lane(struct engine *engine, struct small_frames *s, int at, page_t page) {
+	s->lane[at] = page;
+	engine->frames[at] = page;
+	engine->slot = at;
+}
+
+/*
+ * The engines' steps for one instruction set (ISA, with the target attribute
+ * TARGET), on top of its find_lane, min_lane and max_lane:
+ *	- lru_step_ISA: handles one reference under LRU, returning 1 if it faulted
+ *	- opt_step_ISA: handles the next reference under the optimal policy, the same
+ * width is the number of lanes, a constant in each copy of the loops.
+ */
+#define SMALL_STEPS(ISA, TARGET) \
+static inline TARGET int lru_step_##ISA(struct engine *engine, struct small_frames *s, \
+										page_t page, int width) { \
+	int at = find_lane_##ISA(s->lane, width, page), faulted = (at == -1); \
+	s->now++; \
+	if (faulted) { \
+		at = min_lane_##ISA(s->stamp, width); \
+		load_lane(engine, s, at, page); \
+	} \
+	s->stamp[at] = s->now; \
+	engine_count(engine, faulted); \
+	return faulted; \
+} \
+static inline TARGET int opt_step_##ISA(struct engine *engine, struct small_frames *s, \
+										page_t page, int width) { \
+	int at = find_lane_##ISA(s->lane, width, page), faulted = (at == -1); \
+	if (faulted) { \
+		/* fill the frames in order, then replace the page used latest */ \
+		if (engine->num_allocated < engine->frame_num) \
+			at = engine->num_allocated; \
+		else \
+			at = max_lane_##ISA(s->stamp, width); \
+		load_lane(engine, s, at, page); \
+	} \
+	s->stamp[at] = s->next[s->now++]; \
+	engine_count(engine, faulted); \
+	return faulted; \
+}
+
+/* one copy of the engines' loops for width W under one instruction set */
+#define SMALL_ENGINES(W, ISA, TARGET) \
+static TARGET int lru_access_##ISA##_##W(struct engine *engine, struct small_frames *s, \
+										 page_t page) { \
+	return lru_step_##ISA(engine, s, page, W); \
+} \
+static TARGET void lru_batch_##ISA##_##W(struct engine *engine, struct small_frames *s, \
+										 page_t pages[], int count) { \
+	int i; \
+	for (i = 0; i < count; i++) \
+		lru_step_##ISA(engine, s, pages[i], W); \
+} \
+static TARGET int opt_access_##ISA##_##W(struct engine *engine, struct small_frames *s, \
+										 page_t page) { \
+	return opt_step_##ISA(engine, s, page, W); \
+} \
+static TARGET void opt_batch_##ISA##_##W(struct engine *engine, struct small_frames *s, \
+										 page_t pages[], int count) { \
+	int i; \
+	for (i = 0; i < count; i++) \
+		opt_step_##ISA(engine, s, pages[i], W); \
+}
+
+/* every width under one instruction set, and the table of their entry points (lru's
+ * for each width, then extra's) */
+#define SMALL_ISA(ISA, TARGET) \
+SMALL_STEPS(ISA, TARGET) \
+SMALL_ENGINES(8, ISA, TARGET) \
+SMALL_ENGINES(16, ISA, TARGET) \
+SMALL_ENGINES(24, ISA, TARGET) \
+SMALL_ENGINES(32, ISA, TARGET) \
+SMALL_ENGINES(40, ISA, TARGET) \
+SMALL_ENGINES(48, ISA, TARGET) \
+SMALL_ENGINES(56, ISA, TARGET) \
+SMALL_ENGINES(64, ISA, TARGET) \
+static const struct small_entry ISA##_entries[2][SMALL_WIDTHS] = { \
+	{ { lru_access_##ISA##_8, lru_batch_##ISA##_8 }, { lru_access_##ISA##_16, lru_batch_##ISA##_16 }, \
+	  { lru_access_##ISA##_24, lru_batch_##ISA##_24 }, { lru_access_##ISA##_32, lru_batch_##ISA##_32 }, \
+	  { lru_access_##ISA##_40, lru_batch_##ISA##_40 }, { lru_access_##ISA##_48, lru_batch_##ISA##_48 }, \
+	  { lru_access_##ISA##_56, lru_batch_##ISA##_56 }, { lru_access_##ISA##_64, lru_batch_##ISA##_64 } }, \
+	{ { opt_access_##ISA##_8, opt_batch_##ISA##_8 }, { opt_access_##ISA##_16, opt_batch_##ISA##_16 }, \
+	  { opt_access_##ISA##_24, opt_batch_##ISA##_24 }, { opt_access_##ISA##_32, opt_batch_##ISA##_32 }, \
+	  { opt_access_##ISA##_40, opt_batch_##ISA##_40 }, { opt_access_##ISA##_48, opt_batch_##ISA##_48 }, \
+	  { opt_access_##ISA##_56, opt_batch_##ISA##_56 }, { opt_access_##ISA##_64, opt_batch_##ISA##_64 } } \
+};
+
+SMALL_ISA(plain, )
+#ifdef SMALL_X86
+SMALL_ISA(sse2, SSE2_TARGET)
+SMALL_ISA(avx2, AVX2_TARGET)
+#endif
+
+/*
+ * Function to find the best instruction set the CPU supports.
+ * **Returns**: SMALL_AVX2, SMALL_SSE2 or SMALL_PLAIN
+ */
+static int small_isa(void) {
+#ifdef SMALL_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return SMALL_AVX2;
+	if (__builtin_cpu_supports("sse2"))
+		return SMALL_SSE2;
+#endif
+	return SMALL_PLAIN;
+}
+
+/*
+ * Function to set up the frames of a fixed-width engine.
+ *		:param frame_num: the number of frames (1 to SMALL_MAX_FRAMES)
+ *		:param arr: the whole reference string (read ahead in by the optimal engine)
+ *		:param arr_size: the number of pages in it
+ *		:param opt: "boolean"; the frames are for the optimal engine, not LRU
+ * **Returns**: the frames, or NULL if memory could not be allocated
+ */
+struct small_frames * small_frames_new(int frame_num, page_t arr[], int arr_size, int opt) {
+	struct small_frames *s = malloc(sizeof(struct small_frames));
+	const struct small_entry (*entries)[SMALL_WIDTHS] = plain_entries;
+	int i, isa = small_isa();
+
+	if (!s)
+		return NULL;
+	if (opt && !(s->next = next_use(arr, arr_size))) {
+		free(s);
+		return NULL;
+	}
+	if (!opt)
+		s->next = NULL;
+
+#ifdef SMALL_X86
+	if (isa == SMALL_AVX2)
+		entries = avx2_entries;
+	else if (isa == SMALL_SSE2)
+		entries = sse2_entries;
+#endif
+	s->width = (frame_num + 7) / 8 * 8;
+	s->entry = entries[opt][s->width / 8 - 1];
+	s->now = 0;
+	for (i = 0; i < SMALL_MAX_FRAMES; i++) {
+		s->lane[i] = PAGE_NONE;
+		if (i >= frame_num)
+			s->stamp[i] = opt ? INT_MIN : INT_MAX;
+		else
+			s->stamp[i] = opt ? INT_MIN : 0;
+	}
+	return s;
+}
+
+/*
+ * Function to release the frames of a fixed-width engine.
+ *		:param s: the frames
+ */
+void small_frames_free(struct small_frames *s) {
+	free(s->next);
+	free(s);
+}
+
+/*
+ * Function to reference one page, with the copy of the loop made for the frames'
+ * width and the CPU.
+ *		:param engine: the engine the frames belong to
+ *		:param s: the frames
+ *		:param page: the page referenced (under the optimal policy, the next one in
+ *					 the reference string)
+ * **Returns**: 1 if the page faulted, 0 otherwise
+ */
+int small_access(struct engine *engine, struct small_frames *s, page_t page) {
+	return s->entry.access(engine, s, page);
+}
+
+/*
+ * Function to reference a block of pages.
+ *		:param engine: the engine the frames belong to
+ *		:param s: the frames
+ *		:param pages: the pages referenced
+ *		:param count: the number of pages
+ */
+void small_batch(struct engine *engine, struct small_frames *s, page_t pages[], int count) {
+	s->entry.batch(engine, s, pages, count);
+}
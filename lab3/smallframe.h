@@ -0,0 +1,34 @@
+#ifndef SMALLFRAME_H
+#define SMALLFRAME_H
+
+#include "page.h"
+#include "policy.h"
+
+#define SMALL_MAX_FRAMES 64		/* most frames the fixed-width engines handle */
+
+struct small_frames;
+
+/* the entry points of one copy of the engines' loops (see smallframe.c) */
+struct small_entry {
+	int (*access)(struct engine *engine, struct small_frames *s, page_t page);
+	void (*batch)(struct engine *engine, struct small_frames *s, page_t pages[], int count);
+};
+
+/* the frames of a fixed-width engine: frame_num rounded up to a multiple of 8 lanes,
+ * the lanes past frame_num padded so they never match or get chosen */
+struct small_frames {
+	int width;		/* number of lanes */
+	struct small_entry entry;	/* the loops for this width, policy and CPU */
+	int now;		/* references handled so far */
+	int *next;		/* OPT: position of the next reference to the page at each position */
+	page_t lane[SMALL_MAX_FRAMES];	/* page held by each lane (PAGE_NONE if none) */
+	int stamp[SMALL_MAX_FRAMES];	/* LRU: when each lane's page was last used;
+									   OPT: when it is next used */
+};
+
+struct small_frames * small_frames_new(int frame_num, page_t arr[], int arr_size, int opt);
+void small_frames_free(struct small_frames *s);
+int small_access(struct engine *engine, struct small_frames *s, page_t page);
+void small_batch(struct engine *engine, struct small_frames *s, page_t pages[], int count);
+
+#endif
@@ -0,0 +1,722 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#include "algorithms.h"
+#include "pagemap.h"
+#include "stackdist.h"
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * stackdist computes stack distance profiles (Mattson et al.) of a reference
+ * string. LRU is a stack algorithm: the pages held by k frames are always the top
+ * k entries of a single recency stack, so a reference faults with k frames exactly
+ * when its page is deeper than k in that stack (or has never been seen). One pass
+ * over the references that records the depth of each one therefore gives the
+ * faults for every number of frames at once.
+ *
+ * The depth of a reference is the number of distinct pages referenced since the
+ * previous reference to the same page. It is found with a Fenwick tree over the
+ * positions of the trace that marks only the latest reference to each page, so a
+ * whole profile costs O(n log n).
+ *
+ * For traces too long for that (the Fenwick tree has a position per reference),
+ * lru_sampled_profile approximates the LRU profile the way SHARDS (Waldspurger et
+ * al.) does. Pages are sampled by hashing their number: a page is tracked if its
+ * hash falls below a threshold, which makes the sampling rate R the fraction of
+ * hashes below it. Every reference to a tracked page is seen, so the distance
+ * between two of them counts the tracked pages in between, and each of those
+ * stands for 1 / R pages of the whole trace; each sampled reference is likewise
+ * counted 1 / R times. The memory used is fixed: once more pages are tracked than
+ * the budget allows, the one with the largest hash is dropped and the threshold
+ * lowered to its hash (so R falls, and references sampled from then on count for
+ * more). The tracked pages' latest references live in a Fenwick tree of twice the
+ * budget's size, which is compacted whenever its positions run out.
+ *
+ * The sampled pages are also split by their hash into SHARDS_GROUPS subsamples,
+ * each with distances of its own (counting only its own pages in between), so each
+ * of them, scaled up, is an estimate of the whole profile from a smaller sample.
+ *
+ * How many references a sample holds is itself left to chance: it should stand
+ * for all N references of the trace, but a hash that happens to pick a few pages
+ * too many or too few (or one very hot page) leaves it off, and every estimate
+ * with it, the same way at every frame count. SHARDS_adj (Waldspurger et al.)
+ * counts the difference as hits; here it is split between hits and faults by how
+ * the subsamples' faults move with their number of references (the slope of one
+ * against the other, from 0, as in SHARDS_adj, to 1, as if each of the missing
+ * references faulted). Each subsample is corrected in the same way, and how far
+ * they then spread around their mean gives stack_error's bound on the faults
+ * (about two standard errors; the spread is scaled down by how much of the pages
+ * the whole sample covers, so sampling every page gives a bound of 0). Distances
+ * come in steps of about 1 / R, so frame counts below SHARDS_RESOLUTION / R are
+ * too fine for the sample, and stack_error flags them.
+ *
+ * The optimal policy (see extra) is a stack algorithm too, with a stack ordered by
+ * priority rather than recency: on each reference the page moves to the top, and
+ * the page pushed down from each level is whichever of the two candidates is used
+ * later, while the one used sooner stays. The next use of every reference is
+ * precomputed (next_use), and the stack is cut off below max_depth, so a whole
+ * profile costs O(n * max_depth) instead of one full simulation per frame count.
+ *
+ * Usage:
+ *   Compile with another file; there is no main function
+ */
+
+//======================================================//
+
+/*
+ * Function to add a value at one position of a Fenwick tree.
+ *		:param tree: the tree (1-based, positions 1..size)
+ *		:param size: number of positions in the tree
+ *		:param at: position to update
+ *		:param delta: value to add at that position
+ */
+static void fenwick_add(int tree[], int size, int at, int delta) {
+	for (; at <= size; at += at & -at)
+		tree[at] += delta;
+}
+
+/*
+ * Function to sum the first positions of a Fenwick tree.
+ *		:param tree: the tree (1-based)
+ *		:param at: last position to include in the sum
+ * **Returns**: the sum of positions 1..at
+ */
+static int fenwick_sum(int tree[], int at) {
+	int sum = 0;
+	for (; at > 0; at -= at & -at)
+		sum += tree[at];
+	return sum;
+}
+
+/*
+ * Function to allocate the histogram arrays of an empty profile.
+ *		:param profile: the profile to set up
+ *		:param arr_size: the length of the reference string
+ *		:param max_depth: the largest distance to track individually
+ * **Returns**: 0 on success, -1 if memory could not be allocated
+ */
+static int profile_init(struct stack_profile *profile, int arr_size, int max_depth) {
+	profile->max_depth = max_depth;
+	profile->num_pages = arr_size;
+	profile->num_distinct = 0;
+	profile->num_groups = 0;
+	profile->group_deeper = NULL;
+	profile->deeper = calloc(max_depth + 2, sizeof(long));
+	profile->first_ref = calloc(max_depth + 1, sizeof(int));
+	if (!profile->deeper || !profile->first_ref) {
+		stack_profile_free(profile);
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * Function to turn the distance histogram collected in a profile's deeper array
+ * (count of distance d at index d, every distance beyond max_depth at index
+ * max_depth + 1) into the suffix sums the profile stores.
+ *		:param profile: the profile to finish
+ */
+static void profile_finish(struct stack_profile *profile) {
+	long running = 0, count;
+	int d;
+	for (d = profile->max_depth + 1; d >= 1; d--) {
+		count = profile->deeper[d];
+		profile->deeper[d] = running;
+		running += count;
+	}
+	profile->deeper[0] = running;
+}
+
+/*
+ * Function to compute the LRU stack distance profile of a reference string in a
+ * single pass.
+ *		:param arr: an array of pages to be allocated
+ *		:param arr_size: the number of pages to be allocated
+ *		:param max_depth: the largest number of frames the profile will be asked about
+ *		:param profile: receives the profile (free it with stack_profile_free)
+ * **Returns**: 0 on success, -1 if memory could not be allocated
+ */
+int lru_stack_profile(page_t arr[], int arr_size, int max_depth, struct stack_profile *profile) {
+
+	/* latest[pos + 1] is 1 if the reference at pos is the latest one to its page */
+	int *latest = calloc(arr_size + 1, sizeof(int));
+	struct pagemap last_ref;
+	if (!latest || pagemap_init(&last_ref, 1024, page_span(arr, arr_size)) != 0) {
+		free(latest);
+		return -1;
+	}
+	if (profile_init(profile, arr_size, max_depth) != 0) {
+		free(latest);
+		pagemap_destroy(&last_ref);
+		return -1;
+	}
+
+	int i;
+	for (i = 0; i < arr_size; i++) {
+		int prev = pagemap_get(&last_ref, arr[i]);
+
+		if (prev == -1) {
+			/* first reference to this page: infinite distance (cold miss) */
+			profile->num_distinct++;
+			if (profile->num_distinct <= max_depth)
+				profile->first_ref[profile->num_distinct] = i;
+		}
+		else {
+			/* distance = pages whose latest reference falls after prev, plus itself */
+			int dist = fenwick_sum(latest, i) - fenwick_sum(latest, prev + 1) + 1;
+			profile->deeper[dist <= max_depth ? dist : max_depth + 1]++;
+			fenwick_add(latest, arr_size, prev + 1, -1);
+		}
+
+		fenwick_add(latest, arr_size, i + 1, 1);
+		if (pagemap_put(&last_ref, arr[i], i) != 0) {
+			free(latest);
+			pagemap_destroy(&last_ref);
+			stack_profile_free(profile);
+			return -1;
+		}
+	}
+
+	free(latest);
+	pagemap_destroy(&last_ref);
+	profile_finish(profile);
+	return 0;
+}
+
+/*
+ * Function to hash a page number for sampling (the MurmurHash3 finalizer), so
+ * that whether a page is sampled looks random but is the same every time.
+ *		:param page: the page
+ * **Returns**: the page's hash
+ */
+static uint64_t sample_hash(page_t page) {
+	page ^= page >> 33;
+	page *= 0xff51afd7ed558ccdull;
+	page ^= page >> 33;
+	page *= 0xc4ceb9fe1a85ec53ull;
+	page ^= page >> 33;
+	return page;
+}
+
+/*
+ * Function to move a tracked page up a max-heap of tracked pages ordered by hash.
+ *		:param heap: the slots of the tracked pages, in heap order
+ *		:param hash: the hash of the page in each slot
+ *		:param at: position of the page that may be out of order
+ */
+static void hash_heap_up(int heap[], uint64_t hash[], int at) {
+	int slot = heap[at];
+	while (at > 0 && hash[heap[(at - 1) / 2]] < hash[slot]) {
+		heap[at] = heap[(at - 1) / 2];
+		at = (at - 1) / 2;
+	}
+	heap[at] = slot;
+}
+
+/*
+ * Function to move a tracked page down a max-heap of tracked pages ordered by hash.
+ *		:param heap: the slots of the tracked pages, in heap order
+ *		:param size: the number of pages in the heap
+ *		:param hash: the hash of the page in each slot
+ *		:param at: position of the page that may be out of order
+ */
+static void hash_heap_down(int heap[], int size, uint64_t hash[], int at) {
+	int slot = heap[at], child;
+	while ((child = 2 * at + 1) < size) {
+		if (child + 1 < size && hash[heap[child + 1]] > hash[heap[child]])
+			child++;
+		if (hash[heap[child]] <= hash[slot])
+			break;
+		heap[at] = heap[child];
+		at = child;
+	}
+	heap[at] = slot;
+}
+
+/*
+ * Function to release the arrays of a sampled pass.
+ *		:param sampler: the pass
+ */
+static void sampler_free_arrays(struct lru_sampler *sampler) {
+	free(sampler->slot_page);
+	free(sampler->slot_hash);
+	free(sampler->slot_pos);
+	free(sampler->free_slots);
+	free(sampler->heap);
+	free(sampler->latest);
+	free(sampler->owner);
+	free(sampler->group_latest);
+	free(sampler->hist);
+}
+
+/*
+ * Function to release the state of a sampled pass (but not its profile).
+ *		:param sampler: the pass
+ */
+static void sampler_release(struct lru_sampler *sampler) {
+	sampler_free_arrays(sampler);
+	pagemap_destroy(&sampler->tracked);
+}
+
+/*
+ * Function to start approximating the LRU stack distance profile of a reference
+ * string from a spatially hashed sample of its pages, in a fixed amount of memory
+ * (see the description above). The references are then fed to it a block at a
+ * time (lru_sampler_feed), so they never have to be held all at once, and the
+ * profile is ready once it is finished (lru_sampler_finish).
+ *		:param sampler: the pass to set up
+ *		:param max_depth: the largest number of frames the profile will be asked about
+ *		:param rate: the fraction of pages to sample to begin with (0 to 1)
+ *		:param budget: the most pages to track at once (the rate is lowered to keep
+ *					   to it)
+ *		:param profile: receives the profile (free it with stack_profile_free)
+ * **Returns**: 0 on success, -1 if memory could not be allocated
+ */
+int lru_sampler_init(struct lru_sampler *sampler, int max_depth, double rate, int budget,
+					 struct stack_profile *profile) {
+	int i, g, size = 2 * (budget + 1);
+
+	sampler->profile = profile;
+	sampler->budget = budget;
+	sampler->threshold = (rate >= 1) ? UINT64_MAX : (uint64_t) (rate * 18446744073709551616.0);
+	sampler->scale = 18446744073709551616.0 / (double) sampler->threshold;
+	sampler->num_slots = budget + 1;
+	sampler->size = size;
+	sampler->slot_page = malloc(sampler->num_slots * sizeof(page_t));
+	sampler->slot_hash = malloc(sampler->num_slots * sizeof(uint64_t));
+	sampler->slot_pos = malloc(sampler->num_slots * sizeof(int));
+	sampler->free_slots = malloc(sampler->num_slots * sizeof(int));
+	sampler->heap = malloc(sampler->num_slots * sizeof(int));
+	sampler->latest = calloc(size + 1, sizeof(int));
+	sampler->owner = malloc((size + 1) * sizeof(int));
+	sampler->group_latest = calloc((long) SHARDS_GROUPS * (size + 1), sizeof(int));
+	sampler->hist = calloc(max_depth + 2, sizeof(double));
+	if (!sampler->slot_page || !sampler->slot_hash || !sampler->slot_pos ||
+		!sampler->free_slots || !sampler->heap || !sampler->latest || !sampler->owner ||
+		!sampler->group_latest || !sampler->hist ||
+		pagemap_init(&sampler->tracked, sampler->num_slots, 0) != 0) {
+		sampler_free_arrays(sampler);
+		return -1;
+	}
+	if (profile_init(profile, 0, max_depth) != 0) {
+		sampler_release(sampler);
+		return -1;
+	}
+
+	/* the subsamples' histograms, in buckets of group_width distances */
+	profile->num_groups = SHARDS_GROUPS;
+	profile->group_width = 1 + (max_depth + 1) / SHARDS_BUCKETS;
+	profile->num_buckets = (max_depth + 1) / profile->group_width + 2;
+	profile->group_deeper = calloc((long) SHARDS_GROUPS * profile->num_buckets, sizeof(double));
+	if (!profile->group_deeper) {
+		sampler_release(sampler);
+		stack_profile_free(profile);
+		return -1;
+	}
+
+	for (i = 0; i < sampler->num_slots; i++)
+		sampler->free_slots[i] = sampler->num_slots - 1 - i;
+	for (g = 0; g < SHARDS_GROUPS; g++)
+		sampler->group_weight[g] = 0;
+	sampler->num_free = sampler->num_slots;
+	sampler->num_tracked = 0;
+	sampler->pos = 0;
+	sampler->num_refs = 0;
+	sampler->filled = 0;
+	sampler->distinct = 0;
+	sampler->weight = 0;
+	return 0;
+}
+
+/*
+ * Function to feed the next references of the string to a sampled pass.
+ *		:param sampler: the pass
+ *		:param pages: the references
+ *		:param count: the number of references
+ * **Returns**: 0 on success, -1 if memory could not be allocated (the pass and its
+ *				profile are then released)
+ */
+int lru_sampler_feed(struct lru_sampler *sampler, const page_t pages[], int count) {
+
+	/* local state (see struct lru_sampler):
+	 *	- threshold/scale: pages hashing below threshold are sampled, each standing
+	 *					   for scale = 1 / R pages
+	 *	- slot_*: the page, hash and latest position of each tracked page, with the
+	 *			  unused slots on a free stack, and the tracked pages in a max-heap
+	 *			  by hash; tracked maps a tracked page to its slot
+	 *	- latest/owner: the Fenwick tree marking each tracked page's latest position,
+	 *					and the slot whose reference is at each position
+	 *	- group_latest: the same tree for each subsample's own pages
+	 *	- hist: the estimated number of re-references at each distance (and beyond
+	 *			max_depth at max_depth + 1)
+	 */
+	struct stack_profile *profile = sampler->profile;
+	int *slot_pos = sampler->slot_pos, *latest = sampler->latest, *owner = sampler->owner;
+	int *heap = sampler->heap;
+	uint64_t *slot_hash = sampler->slot_hash;
+	int size = sampler->size, max_depth = profile->max_depth;
+	int last_bucket = profile->num_buckets - 1;
+	int i, j, g, slot, dist;
+	long scaled;
+
+	for (i = 0; i < count; i++, sampler->num_refs++) {
+		uint64_t hash = sample_hash(pages[i]);
+		if (hash >= sampler->threshold)
+			continue;
+		g = (int) (hash & (SHARDS_GROUPS - 1));
+		double *group = &profile->group_deeper[g * profile->num_buckets];
+		int *own = &sampler->group_latest[g * (size + 1)];
+		sampler->weight += sampler->scale;
+		sampler->group_weight[g] += sampler->scale;
+
+		/* out of positions: renumber the tracked pages' latest references 1, 2, ... */
+		if (sampler->pos == size) {
+			int kept = 0;
+			for (j = 1; j <= size; j++) {
+				latest[j] = 0;
+				if (slot_pos[owner[j]] == j) {
+					owner[++kept] = owner[j];
+					slot_pos[owner[kept]] = kept;
+				}
+			}
+			memset(sampler->group_latest, 0, (long) SHARDS_GROUPS * (size + 1) * sizeof(int));
+			for (j = 1; j <= kept; j++) {
+				fenwick_add(latest, size, j, 1);
+				fenwick_add(&sampler->group_latest[(slot_hash[owner[j]] & (SHARDS_GROUPS - 1)) *
+												   (size + 1)], size, j, 1);
+			}
+			sampler->pos = kept;
+		}
+		int pos = ++sampler->pos;
+
+		slot = pagemap_get(&sampler->tracked, pages[i]);
+		if (slot == -1) {
+			/* first reference to this page: infinite distance (cold miss) */
+			sampler->distinct += sampler->scale;
+			group[last_bucket] += sampler->scale;
+			while (sampler->filled < max_depth && sampler->filled + 1 <= sampler->distinct + 0.5)
+				profile->first_ref[++sampler->filled] = (int) sampler->num_refs;
+
+			slot = sampler->free_slots[--sampler->num_free];
+			sampler->slot_page[slot] = pages[i];
+			slot_hash[slot] = hash;
+			heap[sampler->num_tracked] = slot;
+			hash_heap_up(heap, slot_hash, sampler->num_tracked++);
+			if (pagemap_put(&sampler->tracked, pages[i], slot) != 0) {
+				sampler_release(sampler);
+				stack_profile_free(profile);
+				return -1;
+			}
+		}
+		else {
+			/* distance = tracked pages whose latest reference falls after this page's,
+			 * each standing for scale pages, plus the page itself */
+			dist = fenwick_sum(latest, pos - 1) - fenwick_sum(latest, slot_pos[slot]);
+			scaled = 1 + lround(dist * sampler->scale);
+			sampler->hist[scaled <= max_depth ? scaled : max_depth + 1] += sampler->scale;
+			fenwick_add(latest, size, slot_pos[slot], -1);
+
+			/* and within the subsample, each of its pages standing for
+			 * SHARDS_GROUPS * scale pages */
+			dist = fenwick_sum(own, pos - 1) - fenwick_sum(own, slot_pos[slot]);
+			scaled = 1 + lround(dist * SHARDS_GROUPS * sampler->scale);
+			group[scaled <= max_depth ? scaled / profile->group_width : last_bucket] +=
+				sampler->scale;
+			fenwick_add(own, size, slot_pos[slot], -1);
+		}
+		slot_pos[slot] = pos;
+		owner[pos] = slot;
+		fenwick_add(latest, size, pos, 1);
+		fenwick_add(own, size, pos, 1);
+
+		/* over budget: drop the pages with the largest hash, and sample less */
+		while (sampler->num_tracked > sampler->budget ||
+			   (sampler->num_tracked > 0 && slot_hash[heap[0]] >= sampler->threshold)) {
+			slot = heap[0];
+			heap[0] = heap[--sampler->num_tracked];
+			hash_heap_down(heap, sampler->num_tracked, slot_hash, 0);
+			sampler->threshold = slot_hash[slot];
+			fenwick_add(latest, size, slot_pos[slot], -1);
+			fenwick_add(&sampler->group_latest[(slot_hash[slot] & (SHARDS_GROUPS - 1)) * (size + 1)],
+						size, slot_pos[slot], -1);
+			pagemap_remove(&sampler->tracked, sampler->slot_page[slot]);
+			slot_pos[slot] = 0;
+			sampler->free_slots[sampler->num_free++] = slot;
+		}
+		sampler->scale = 18446744073709551616.0 / (double) sampler->threshold;
+	}
+	return 0;
+}
+
+/*
+ * Function to finish a sampled pass, once every reference has been fed to it, and
+ * release its state.
+ *		:param sampler: the pass
+ * **Returns**: 0 on success (the profile is ready), -1 if memory could not be
+ *				allocated (the profile is then released)
+ */
+int lru_sampler_finish(struct lru_sampler *sampler) {
+	struct stack_profile *profile = sampler->profile;
+	double *groups = profile->group_deeper, *hist = sampler->hist;
+	int max_depth = profile->max_depth, last_bucket = profile->num_buckets - 1;
+	long num_refs = sampler->num_refs;
+	double running;
+	int d, g, b;
+
+	/* the subsamples' estimated faults beyond each bucket, as suffix sums */
+	for (g = 0; g < SHARDS_GROUPS; g++) {
+		double *group = &groups[g * profile->num_buckets];
+		running = 0;
+		for (b = last_bucket; b >= 0; b--) {
+			double count = group[b];
+			group[b] = running;
+			running += count;
+		}
+	}
+
+	/* how the faults beyond each bucket move with the references a sample holds,
+	 * then every estimate moved to a sample of exactly num_refs references */
+	double shortfall = num_refs - sampler->weight;
+	double *slope_at = malloc(profile->num_buckets * sizeof(double));
+	if (!slope_at) {
+		sampler_release(sampler);
+		stack_profile_free(profile);
+		return -1;
+	}
+	for (b = last_bucket; b >= 0; b--) {
+		double x_mean = 0, y_mean = 0, sxy = 0, sxx = 0, x, y;
+		for (g = 0; g < SHARDS_GROUPS; g++) {
+			x_mean += sampler->group_weight[g];
+			y_mean += groups[g * profile->num_buckets + b];
+		}
+		x_mean /= SHARDS_GROUPS;
+		y_mean /= SHARDS_GROUPS;
+		for (g = 0; g < SHARDS_GROUPS; g++) {
+			x = sampler->group_weight[g] - x_mean;
+			y = groups[g * profile->num_buckets + b] - y_mean;
+			sxy += x * y;
+			sxx += x * x;
+		}
+		slope_at[b] = (sxx > 0) ? fmin(fmax(sxy / sxx, 0), 1) : 0;
+		for (g = 0; g < SHARDS_GROUPS; g++)
+			groups[g * profile->num_buckets + b] +=
+				slope_at[b] * ((double) num_refs / SHARDS_GROUPS - sampler->group_weight[g]);
+	}
+
+	/* the estimated counts, as the suffix sums an exact profile holds */
+	profile->num_pages = (int) num_refs;
+	profile->num_distinct = (int) lround(sampler->distinct);
+	profile->rate = 1 / sampler->scale;
+	running = 0;
+	for (d = max_depth + 1; d >= 1; d--) {
+		b = (d <= max_depth) ? d / profile->group_width : last_bucket;
+		profile->deeper[d] = lround(running + slope_at[b] * shortfall);
+		running += hist[d];
+	}
+	profile->deeper[0] = lround(running + shortfall);
+	free(slope_at);
+	sampler_release(sampler);
+	return 0;
+}
+
+/*
+ * Function to approximate the LRU stack distance profile of a reference string
+ * from a spatially hashed sample of its pages, in a fixed amount of memory (see
+ * the description above). The profile is used like an exact one, and stack_error
+ * gives a bound on its estimates.
+ *		:param arr: an array of pages to be allocated
+ *		:param arr_size: the number of pages to be allocated
+ *		:param max_depth: the largest number of frames the profile will be asked about
+ *		:param rate: the fraction of pages to sample to begin with (0 to 1)
+ *		:param budget: the most pages to track at once (the rate is lowered to keep
+ *					   to it)
+ *		:param profile: receives the profile (free it with stack_profile_free)
+ * **Returns**: 0 on success, -1 if memory could not be allocated
+ */
+int lru_sampled_profile(page_t arr[], int arr_size, int max_depth, double rate, int budget,
+						struct stack_profile *profile) {
+	struct lru_sampler sampler;
+	if (lru_sampler_init(&sampler, max_depth, rate, budget, profile) != 0 ||
+		lru_sampler_feed(&sampler, arr, arr_size) != 0)
+		return -1;
+	return lru_sampler_finish(&sampler);
+}
+
+/*
+ * Function to compute the optimal policy's stack distance profile of a reference
+ * string in a single pass.
+ *		:param arr: an array of pages to be allocated
+ *		:param arr_size: the number of pages to be allocated
+ *		:param max_depth: the largest number of frames the profile will be asked about
+ *		:param profile: receives the profile (free it with stack_profile_free)
+ * **Returns**: 0 on success, -1 if memory could not be allocated
+ */
+int opt_stack_profile(page_t arr[], int arr_size, int max_depth, struct stack_profile *profile) {
+
+	/* initialize local state:
+	 *	- next: position of the next reference to the page at each position
+	 *	- seen: 1 at positions that re-reference an earlier page
+	 *	- stack/when: the top max_depth pages of the priority stack, and when each
+	 *				  one is next used
+	 */
+	int *next = next_use(arr, arr_size);
+	char *seen = calloc(arr_size + 1, sizeof(char));
+	page_t *stack = calloc(max_depth + 1, sizeof(page_t));
+	int *when = calloc(max_depth + 1, sizeof(int));
+	if (!next || !seen || !stack || !when || profile_init(profile, arr_size, max_depth) != 0) {
+		free(next);
+		free(seen);
+		free(stack);
+		free(when);
+		return -1;
+	}
+
+	int i, j, depth = 0;
+	for (i = 0; i < arr_size; i++) {
+		if (next[i] != INT_MAX)
+			seen[next[i]] = 1;
+	}
+
+	for (i = 0; i < arr_size; i++) {
+		page_t page = arr[i];
+		int dist = -1;
+
+		if (depth > 0 && stack[0] == page) {
+			/* already on top: only its next use changes */
+			when[0] = next[i];
+			dist = 1;
+		}
+		else {
+			/* put the page on top, and carry the old top down level by level,
+			 * swapping it for any page that is used later than it is */
+			page_t carry = stack[0];
+			int carry_when = when[0];
+			stack[0] = page;
+			when[0] = next[i];
+
+			for (j = 1; j < depth; j++) {
+				if (stack[j] == page) {
+					/* the carried page fills the hole the referenced page left */
+					stack[j] = carry;
+					when[j] = carry_when;
+					dist = j + 1;
+					break;
+				}
+				if (when[j] > carry_when) {
+					page_t tmp = stack[j];
+					int tmp_when = when[j];
+					stack[j] = carry;
+					when[j] = carry_when;
+					carry = tmp;
+					carry_when = tmp_when;
+				}
+			}
+
+			/* not found: the stack grows, or its bottom page falls off */
+			if (dist == -1 && depth > 0 && depth < max_depth) {
+				stack[depth] = carry;
+				when[depth] = carry_when;
+			}
+			if (dist == -1 && depth < max_depth)
+				depth++;
+		}
+
+		if (!seen[i]) {
+			/* first reference to this page: infinite distance (cold miss) */
+			profile->num_distinct++;
+			if (profile->num_distinct <= max_depth)
+				profile->first_ref[profile->num_distinct] = i;
+		}
+		else {
+			profile->deeper[dist != -1 ? dist : max_depth + 1]++;
+		}
+	}
+
+	free(next);
+	free(seen);
+	free(stack);
+	free(when);
+	profile_finish(profile);
+	return 0;
+}
+
+/*
+ * Function to read the result of a simulation with a given number of frames off a
+ * stack distance profile. The counts follow the same rules as the simulators in
+ * algorithms.c: references (and faults) are only counted once memory has filled up,
+ * which for a stack algorithm happens right after the frame_num-th distinct page is
+ * first referenced.
+ *		:param profile: the profile of the reference string
+ *		:param frame_num: the number of frames (no more than the profile's max_depth)
+ *		:param stats: an array which will store the number of page faults (index 0)
+ *					  and the number of references (index 1)
+ */
+void stack_stats(struct stack_profile *profile, int frame_num, int stats[]) {
+
+	/* memory never fills up if there are fewer distinct pages than frames */
+	if (profile->num_distinct < frame_num || frame_num < 1) {
+		stats[0] = stats[1] = 0;
+		return;
+	}
+
+	/* every reference deeper than frame_num faults, as does every first reference
+	 * except the frame_num that filled memory (those came before counting started);
+	 * a reference before that point is never deeper than frame_num - 1 */
+	stats[0] = (int) (profile->num_distinct - frame_num + profile->deeper[frame_num]);
+	stats[1] = profile->num_pages - (profile->first_ref[frame_num] + 1);
+
+	/* a sampled profile's estimates can stray past what is possible */
+	if (stats[0] < 0)
+		stats[0] = 0;
+	if (stats[0] > stats[1])
+		stats[0] = stats[1];
+}
+
+/*
+ * Function to bound the error of the faults a sampled profile estimates for a given
+ * number of frames: about two standard errors, from how far the estimates of its
+ * subsamples spread once each is corrected for the references it holds.
+ *		:param profile: the profile of the reference string
+ *		:param frame_num: the number of frames (no more than the profile's max_depth)
+ * **Returns**: the bound, in faults (0 for an exact profile), or INFINITY if there
+ *				are too few frames for the sampling rate (fewer than
+ *				SHARDS_RESOLUTION / R) for the estimate to be relied on
+ */
+double stack_error(struct stack_profile *profile, int frame_num) {
+	int g, b = frame_num / (profile->group_width > 0 ? profile->group_width : 1);
+	double mean = 0, spread = 0, est;
+
+	if (profile->num_groups < 3 || profile->num_distinct < frame_num || frame_num < 1)
+		return 0;
+	if (profile->rate < 1 && frame_num * profile->rate < SHARDS_RESOLUTION)
+		return INFINITY;
+
+	/* each subsample, scaled up by the number of subsamples, estimates the faults */
+	for (g = 0; g < profile->num_groups; g++)
+		mean += profile->group_deeper[g * profile->num_buckets + b];
+	for (g = 0; g < profile->num_groups; g++) {
+		est = profile->num_groups * profile->group_deeper[g * profile->num_buckets + b] - mean;
+		spread += est * est;
+	}
+	/* a subsample covers rate / num_groups of the pages, the whole sample rate */
+	spread *= (1 - profile->rate) / (profile->num_groups - profile->rate);
+	return 2 * sqrt(spread / (profile->num_groups - 2.0));
+}
+
+/*
+ * Function to release the memory held by a profile.
+ *		:param profile: the profile to free
+ */
+void stack_profile_free(struct stack_profile *profile) {
+	free(profile->deeper);
+	free(profile->first_ref);
+	free(profile->group_deeper);
+	profile->deeper = NULL;
+	profile->first_ref = NULL;
+	profile->group_deeper = NULL;
+}
@@ -0,0 +1,74 @@
+#ifndef STACKDIST_H
+#define STACKDIST_H
+
+#include <stdint.h>
+#include "page.h"
+#include "pagemap.h"
+
+#define SHARDS_DEFAULT_BUDGET 8192	/* sampled pages tracked at once, unless told otherwise */
+#define SHARDS_GROUPS 8				/* subsamples whose spread gives the error bound */
+#define SHARDS_BUCKETS 4096			/* most distance buckets in each subsample's histogram */
+#define SHARDS_RESOLUTION 32		/* fewest frames, times the sampling rate, estimated reliably */
+
+/* stack distance profile of a reference string under a stack algorithm (LRU or OPT) */
+struct stack_profile {
+	int max_depth;		/* largest distance tracked individually */
+	int num_pages;		/* length of the reference string */
+	int num_distinct;	/* number of distinct pages (i.e., cold misses) */
+	long *deeper;		/* deeper[d] = number of re-references (i.e., not first references)
+						   at a distance greater than d (d = 0..max_depth) */
+	int *first_ref;		/* first_ref[k] = position of the k-th distinct page's first
+						   reference (k = 1..max_depth) */
+
+	/* sampled profiles only (see lru_sampled_profile); num_groups is 0 otherwise */
+	int num_groups;		/* subsamples the sampled pages are split into */
+	double rate;		/* fraction of the pages sampled by the end of the pass */
+	int group_width;	/* distances per bucket of each subsample's histogram */
+	int num_buckets;	/* buckets per subsample (the last holds cold misses too) */
+	double *group_deeper;	/* group_deeper[g * num_buckets + b] = estimated faults of subsample
+							   g at a distance beyond bucket b, cold misses included */
+};
+
+/* a sampled LRU profile being estimated from references fed a block at a time
+ * (see lru_sampled_profile) */
+struct lru_sampler {
+	struct stack_profile *profile;	/* the profile being estimated */
+	int budget;			/* most pages tracked at once */
+	uint64_t threshold;	/* pages hashing below it are sampled */
+	double scale;		/* pages each sampled page stands for (1 / R) */
+	int num_slots;		/* slots for tracked pages (budget + 1) */
+	int size;			/* positions in the Fenwick trees */
+	page_t *slot_page;	/* page, hash and latest position of the tracked page in each slot */
+	uint64_t *slot_hash;
+	int *slot_pos;
+	int *free_slots;	/* unused slots, as a stack */
+	int num_free;
+	int *heap;			/* tracked pages' slots, in a max-heap by hash */
+	int num_tracked;
+	struct pagemap tracked;	/* tracked page -> its slot */
+	int *latest;		/* Fenwick tree marking each tracked page's latest position */
+	int *owner;			/* slot whose reference is at each position */
+	int *group_latest;	/* the same tree for each subsample's own pages */
+	int pos;			/* latest position used */
+	long num_refs;		/* references fed so far */
+	int filled;			/* entries of the profile's first_ref filled so far */
+	double distinct;	/* estimated distinct pages so far */
+	double weight;		/* sampled references, each counted scale times */
+	double group_weight[SHARDS_GROUPS];	/* the same in each subsample */
+	double *hist;		/* estimated re-references at each distance (beyond max_depth at
+						   max_depth + 1) */
+};
+
+int lru_stack_profile(page_t arr[], int arr_size, int max_depth, struct stack_profile *profile);
+int lru_sampled_profile(page_t arr[], int arr_size, int max_depth, double rate, int budget,
+						struct stack_profile *profile);
+int lru_sampler_init(struct lru_sampler *sampler, int max_depth, double rate, int budget,
+					 struct stack_profile *profile);
+int lru_sampler_feed(struct lru_sampler *sampler, const page_t pages[], int count);
+int lru_sampler_finish(struct lru_sampler *sampler);
+int opt_stack_profile(page_t arr[], int arr_size, int max_depth, struct stack_profile *profile);
+void stack_stats(struct stack_profile *profile, int frame_num, int stats[]);
+double stack_error(struct stack_profile *profile, int frame_num);
+void stack_profile_free(struct stack_profile *profile);
+
+#endif
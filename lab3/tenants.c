@@ -0,0 +1,370 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "tenants.h"
+#include "trace.h"
+
+#define TENANT_MIN_CAPACITY 1024	/* references room is first made for */
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * tenants simulates several processes sharing one pool of frames. Each process (a
+ * tenant) has its own reference string: a trace of its own, or the references
+ * tagged with its process id in a trace of several ("pid:page" text). Two tenants
+ * may use the same page numbers without sharing pages, so as they are loaded,
+ * every tenant's pages are renumbered densely into numbers unique across all of
+ * them (through a pagemap per tenant); the engines then see ordinary page numbers,
+ * small enough to be indexed directly, and each reference costs them the usual
+ * O(1) lookup however many tenants there are.
+ *
+ * A scheduler interleaves the tenants into one stream: round robin, each running
+ * for a quantum of references in turn (a tenant that has run out is skipped), or,
+ * with a quantum of 0, in the order the references were given. The stream then
+ * runs under one of two replacement scopes:
+ *
+ * - global: a single engine over all of the frames; a fault may take a frame from
+ *   any tenant, so a tenant that sweeps through many pages can push the others'
+ *   working sets out (a noisy neighbour).
+ * - local: an engine per tenant over its own equal share of the frames; a tenant
+ *   only ever replaces its own pages.
+ *
+ * Each tenant's faults and references are counted the way its engine counts them
+ * (only once that engine's memory has filled up), along with how many frames hold
+ * its pages, on average and at the end. The owner of every frame is recorded as it
+ * is loaded (and cleared as it is released, for the policies whose resident sets
+ * shrink), so this costs O(1) per reference too.
+ *
+ * Usage:
+ *   Compile with another file; there is no main function
+ */
+
+//======================================================//
+
+/*
+ * Function to set up an empty mix of tenants.
+ *		:param mix: the mix
+ */
+void mix_init(struct mix *mix) {
+	mix->tenants = NULL;
+	mix->num_tenants = 0;
+	mix->arrival = NULL;
+	mix->num_refs = 0;
+	mix->capacity = 0;
+	mix->num_ids = 0;
+	mix->stream = NULL;
+	mix->stream_tenant = NULL;
+}
+
+/*
+ * Function to release a mix of tenants.
+ *		:param mix: the mix
+ */
+void mix_free(struct mix *mix) {
+	int k;
+	for (k = 0; k < mix->num_tenants; k++) {
+		free(mix->tenants[k].label);
+		free(mix->tenants[k].pages);
+		pagemap_destroy(&mix->tenants[k].ids);
+	}
+	free(mix->tenants);
+	free(mix->arrival);
+	free(mix->stream);
+	free(mix->stream_tenant);
+	mix_init(mix);
+}
+
+/*
+ * Function to add a tenant with no references yet.
+ *		:param mix: the mix
+ *		:param label: what the tenant is called in the results
+ * **Returns**: the index of the tenant, or -1 if memory could not be allocated
+ */
+static int add_tenant(struct mix *mix, const char *label) {
+	struct tenant *grown = realloc(mix->tenants, (mix->num_tenants + 1) * sizeof(struct tenant));
+	if (!grown)
+		return -1;
+	mix->tenants = grown;
+
+	struct tenant *t = &mix->tenants[mix->num_tenants];
+	t->label = malloc(strlen(label) + 1);
+	t->pages = malloc(TENANT_MIN_CAPACITY * sizeof(page_t));
+	if (!t->label || !t->pages || pagemap_init(&t->ids, TENANT_MIN_CAPACITY, 0) != 0) {
+		free(t->label);
+		free(t->pages);
+		return -1;
+	}
+	strcpy(t->label, label);
+	t->num_pages = 0;
+	t->capacity = TENANT_MIN_CAPACITY;
+	return mix->num_tenants++;
+}
+
+/*
+ * Function to append a reference to a tenant's reference string.
+ *		:param mix: the mix
+ *		:param k: the index of the tenant
+ *		:param page: the page referenced (the tenant's own number for it)
+ * **Returns**: 0 on success, -1 if memory could not be allocated
+ */
+static int add_reference(struct mix *mix, int k, page_t page) {
+	struct tenant *t = &mix->tenants[k];
+	int id = pagemap_get(&t->ids, page);
+	if (id == -1) {
+		id = mix->num_ids;
+		if (pagemap_put(&t->ids, page, id) != 0)
+			return -1;
+		mix->num_ids++;
+	}
+
+	if (t->num_pages == t->capacity) {
+		page_t *grown = realloc(t->pages, 2 * (size_t) t->capacity * sizeof(page_t));
+		if (!grown)
+			return -1;
+		t->pages = grown;
+		t->capacity *= 2;
+	}
+	if (mix->num_refs == mix->capacity) {
+		int capacity = (mix->capacity > 0) ? 2 * mix->capacity : TENANT_MIN_CAPACITY;
+		int *grown = realloc(mix->arrival, capacity * sizeof(int));
+		if (!grown)
+			return -1;
+		mix->arrival = grown;
+		mix->capacity = capacity;
+	}
+	t->pages[t->num_pages++] = (page_t) id;
+	mix->arrival[mix->num_refs++] = k;
+	return 0;
+}
+
+/*
+ * Function to add a tenant whose references are a whole trace.
+ *		:param mix: the mix
+ *		:param label: what the tenant is called in the results
+ *		:param pages: its page references
+ *		:param num_pages: the number of page references
+ * **Returns**: 0 on success, or TRACE_ERR_MEMORY if memory could not be allocated
+ */
+int mix_add_trace(struct mix *mix, const char *label, page_t pages[], int num_pages) {
+	int k = add_tenant(mix, label), i;
+	if (k == -1)
+		return TRACE_ERR_MEMORY;
+	for (i = 0; i < num_pages; i++) {
+		if (add_reference(mix, k, pages[i]) != 0)
+			return TRACE_ERR_MEMORY;
+	}
+	return 0;
+}
+
+/*
+ * Function to add the tenants of a trace whose references are tagged with their
+ * process id: whitespace separated "pid:page" pairs of numbers, in text. Each
+ * process id becomes a tenant (labelled "file:pid"), in order of first appearance.
+ *		:param mix: the mix
+ *		:param file_name: the trace ("-" reads stdin)
+ * **Returns**: 0 on success, TRACE_ERR_OPEN if the file cannot be read,
+ *				TRACE_ERR_FORMAT if anything in it is not a "pid:page" pair, or
+ *				TRACE_ERR_MEMORY if memory could not be allocated
+ */
+int mix_add_tagged(struct mix *mix, const char *file_name) {
+	FILE *fp = (strcmp(file_name, "-") == 0) ? stdin : fopen(file_name, "r");
+	struct pagemap tags;	/* process id -> tenant */
+	uint64_t pid;
+	page_t page;
+	char label[256];
+	int k, got, err = 0;
+
+	if (!fp)
+		return TRACE_ERR_OPEN;
+	if (pagemap_init(&tags, 64, 0) != 0) {
+		if (fp != stdin)
+			fclose(fp);
+		return TRACE_ERR_MEMORY;
+	}
+
+	while (err == 0 && (got = fscanf(fp, " %" SCNu64 ":%" SCNu64, &pid, &page)) != EOF) {
+		if (got != 2 || pid == PAGE_NONE || page == PAGE_NONE) {
+			err = TRACE_ERR_FORMAT;
+			break;
+		}
+		k = pagemap_get(&tags, pid);
+		if (k == -1) {
+			snprintf(label, sizeof(label), "%s:%" PRIu64, file_name, pid);
+			k = add_tenant(mix, label);
+			if (k == -1 || pagemap_put(&tags, pid, k) != 0)
+				err = TRACE_ERR_MEMORY;
+		}
+		if (err == 0 && add_reference(mix, k, page) != 0)
+			err = TRACE_ERR_MEMORY;
+	}
+	if (err == 0 && ferror(fp))
+		err = TRACE_ERR_OPEN;
+
+	pagemap_destroy(&tags);
+	if (fp != stdin)
+		fclose(fp);
+	return err;
+}
+
+/*
+ * Function to interleave the tenants' references into the order the scheduler
+ * runs them in (mix->stream).
+ *		:param mix: the mix (with every tenant added)
+ *		:param quantum: the number of references each tenant runs for in its turn, or
+ *						0 to run them in the order they were given
+ * **Returns**: 0 on success, or -1 if memory could not be allocated
+ */
+int mix_schedule(struct mix *mix, int quantum) {
+	int *next = calloc(mix->num_tenants + 1, sizeof(int));	/* each tenant's next reference */
+	int i = 0, k, end;
+
+	free(mix->stream);
+	free(mix->stream_tenant);
+	mix->stream = malloc((mix->num_refs + 1) * sizeof(page_t));
+	mix->stream_tenant = malloc((mix->num_refs + 1) * sizeof(int));
+	if (!next || !mix->stream || !mix->stream_tenant) {
+		free(next);
+		return -1;
+	}
+
+	if (quantum == 0) {
+		for (i = 0; i < mix->num_refs; i++) {
+			k = mix->arrival[i];
+			mix->stream[i] = mix->tenants[k].pages[next[k]++];
+			mix->stream_tenant[i] = k;
+		}
+	}
+	while (i < mix->num_refs) {
+		for (k = 0; k < mix->num_tenants; k++) {
+			end = next[k] + quantum;
+			if (end > mix->tenants[k].num_pages)
+				end = mix->tenants[k].num_pages;
+			while (next[k] < end) {
+				mix->stream[i] = mix->tenants[k].pages[next[k]++];
+				mix->stream_tenant[i++] = k;
+			}
+		}
+	}
+
+	free(next);
+	return 0;
+}
+
+/*
+ * Function to account for a change in the number of frames holding a tenant's
+ * pages, adding up the frames it held until now.
+ *		:param t: the tenant
+ *		:param since: when the number of frames it holds last changed
+ *		:param delta: the change (1 or -1)
+ *		:param now: the position of the reference that changed it
+ */
+static void hold(struct tenant *t, long *since, int delta, long now) {
+	t->mean_held += (double) t->held * (now - *since);
+	*since = now;
+	t->held += delta;
+}
+
+/*
+ * Function to run the scheduled references of a mix under a policy (exits with an
+ * error message if memory runs out), storing each tenant's results in it.
+ *		:param policy: the policy to run
+ *		:param mix: the mix (scheduled by mix_schedule)
+ *		:param frame_num: the number of frames in the shared pool
+ *		:param scope: TENANT_GLOBAL or TENANT_LOCAL
+ *		:param stats: an array which will store the number of page faults (index 0)
+ *					  and the number of references (index 1) of every tenant together
+ */
+void mix_simulate(const struct policy *policy, struct mix *mix, int frame_num, int scope,
+				  int stats[]) {
+	int n = mix->num_tenants, num_engines = (scope == TENANT_GLOBAL) ? 1 : n;
+	struct engine **engines = malloc((num_engines + 1) * sizeof(struct engine *));
+	int *first = malloc((num_engines + 1) * sizeof(int));	/* each engine's first frame */
+	int *owner = malloc((frame_num + 1) * sizeof(int));	/* tenant holding each frame (-1 if none) */
+	long *since = calloc(n + 1, sizeof(long));
+	int i, j, k, e, slot, faulted;
+
+	if (!engines || !first || !owner || !since) {
+		printf("Error: cannot allocate memory for %d tenants.\n", n);
+		exit(1);
+	}
+	for (i = 0; i < frame_num; i++)
+		owner[i] = -1;
+
+	/* one engine over every frame, or one per tenant over an equal share */
+	for (e = 0, slot = 0; e < num_engines; e++) {
+		struct tenant *t = &mix->tenants[e];
+		if (scope == TENANT_GLOBAL) {
+			engines[e] = engine_new(policy, mix->stream, mix->num_refs, frame_num);
+		}
+		else {
+			t->frames = frame_num / n + (e < frame_num % n);
+			engines[e] = engine_new(policy, t->pages, t->num_pages, t->frames);
+		}
+		engines[e]->released = malloc((engines[e]->frame_num + 1) * sizeof(int));
+		if (!engines[e]->released) {
+			printf("Error: cannot allocate memory for %d tenants.\n", n);
+			exit(1);
+		}
+		first[e] = slot;
+		slot += engines[e]->frame_num;
+	}
+	for (k = 0; k < n; k++) {
+		mix->tenants[k].faults = 0;
+		mix->tenants[k].refs = 0;
+		mix->tenants[k].held = 0;
+		mix->tenants[k].mean_held = 0;
+		if (scope == TENANT_GLOBAL)
+			mix->tenants[k].frames = frame_num;
+	}
+
+	for (i = 0; i < mix->num_refs; i++) {
+		k = mix->stream_tenant[i];
+		e = (scope == TENANT_GLOBAL) ? 0 : k;
+		struct engine *engine = engines[e];
+
+		engine->num_released = 0;
+		faulted = policy->access(engine, mix->stream[i]);
+
+		/* frames let go of, then the frame the page went into */
+		for (j = 0; j < engine->num_released; j++) {
+			slot = first[e] + engine->released[j];
+			hold(&mix->tenants[owner[slot]], &since[owner[slot]], -1, i);
+			owner[slot] = -1;
+		}
+		if (faulted && engine->frame_num > 0) {
+			slot = first[e] + engine->slot;
+			if (owner[slot] != -1)
+				hold(&mix->tenants[owner[slot]], &since[owner[slot]], -1, i);
+			owner[slot] = k;
+			hold(&mix->tenants[k], &since[k], 1, i);
+		}
+
+		/* counted the way the engine counts (see engine_count in policy.h) */
+		if (engine->is_filled) {
+			mix->tenants[k].refs++;
+			mix->tenants[k].faults += faulted;
+		}
+	}
+
+	stats[0] = stats[1] = 0;
+	for (k = 0; k < n; k++) {
+		struct tenant *t = &mix->tenants[k];
+		hold(t, &since[k], 0, mix->num_refs);
+		t->mean_held = (mix->num_refs > 0) ? t->mean_held / mix->num_refs : 0;
+		stats[0] += t->faults;
+		stats[1] += t->refs;
+	}
+
+	for (e = 0; e < num_engines; e++) {
+		free(engines[e]->released);
+		engines[e]->released = NULL;
+		policy->destroy(engines[e]);
+	}
+	free(engines);
+	free(first);
+	free(owner);
+	free(since);
+}
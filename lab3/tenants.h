@@ -0,0 +1,47 @@
+#ifndef TENANTS_H
+#define TENANTS_H
+
+#include "page.h"
+#include "pagemap.h"
+#include "policy.h"
+
+#define TENANT_GLOBAL 0		/* every tenant's pages compete for the whole pool of frames */
+#define TENANT_LOCAL 1		/* each tenant replaces only within its own share of the frames */
+
+/* one process whose references are mixed with the others' */
+struct tenant {
+	char *label;		/* what it is called in the results (its file, and its tag) */
+	page_t *pages;		/* its references, as page numbers unique across the tenants */
+	int num_pages;
+	int capacity;		/* number of pages the array has room for */
+	struct pagemap ids;	/* its own page number -> the unique one */
+
+	/* results of a simulation */
+	int frames;			/* TENANT_LOCAL: its share of the frames */
+	int faults;			/* faults and references counted for it */
+	int refs;
+	int held;			/* frames holding its pages at the end */
+	double mean_held;	/* frames holding its pages, on average over the run */
+};
+
+/* several processes' references, and the order the scheduler runs them in */
+struct mix {
+	struct tenant *tenants;
+	int num_tenants;
+	int *arrival;		/* tenant of each reference, in the order they were given */
+	int num_refs;
+	int capacity;		/* number of references arrival has room for */
+	int num_ids;		/* unique page numbers handed out so far */
+	page_t *stream;		/* every reference, in the order the scheduler runs them */
+	int *stream_tenant;	/* tenant of each reference in stream */
+};
+
+void mix_init(struct mix *mix);
+void mix_free(struct mix *mix);
+int mix_add_trace(struct mix *mix, const char *label, page_t pages[], int num_pages);
+int mix_add_tagged(struct mix *mix, const char *file_name);
+int mix_schedule(struct mix *mix, int quantum);
+void mix_simulate(const struct policy *policy, struct mix *mix, int frame_num, int scope,
+				  int stats[]);
+
+#endif
@@ -0,0 +1,963 @@
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "trace.h"
+
+#define READ_BLOCK_SIZE (1 << 20)
+#define INITIAL_CAPACITY 4096
+#define STREAM_BLOCK_SIZE (1 << 16)	/* most bytes a trace_stream reads at once */
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * trace loads a file of page references (integers separated by whitespace) into
+ * memory. Regular files are memory-mapped and parsed in place; anything else (a
+ * pipe, or stdin when the file name is "-") is read in large blocks. Numbers are
+ * parsed by hand rather than with one fscanf call per reference, and the array of
+ * pages grows as needed, so a trace can be as long as memory allows (up to INT_MAX
+ * references). A page can be any 64-bit number below PAGE_NONE. As with the fscanf
+ * loop this replaces, reading stops quietly at the first thing that isn't a page
+ * number (which now includes a negative number). A page number may be followed
+ * directly by w, marking a reference that writes the page (e.g., "12 7w 12"), or
+ * by r, for a read, which is what a plain number is; the write flags are only
+ * kept (in trace->writes) once a trace has a write.
+ *
+ * Traces can also be stored in a binary format, which is recognized by its magic
+ * number and needs no parsing. All fields are little-endian:
+ *
+ *   offset  size  field
+ *        0     4  magic number "PGTR"
+ *        4     2  format version (1)
+ *        6     2  encoding: 0 = TRACE_FIXED32, 1 = TRACE_VARINT, 2 = TRACE_FIXED64
+ *        8     4  flags: bit 0 = a block index follows the pages,
+ *                       bit 1 = a bitmap of the writes ends the file
+ *       12     4  reserved (0)
+ *       16     8  number of pages
+ *       24     8  byte offset of the block index (0 if there is none)
+ *       32        the pages
+ *
+ * TRACE_FIXED64 stores every page as a 64-bit number, so on a little-endian machine
+ * the mapped file is used as the page array directly, with no copy at all.
+ * TRACE_FIXED32 is the older 32-bit layout; it is still read (by copying), and can
+ * still be written when every page fits. TRACE_VARINT stores the difference from
+ * the previous page (modulo 2^64), zigzag encoded (so small negative steps stay
+ * small) as a LEB128 varint; most steps then take one or two bytes. The
+ * deltas restart from page 0 at every block of TRACE_INDEX_STRIDE pages, and the
+ * index (an 8-byte count followed by one 8-byte file offset per block) lets a
+ * reader start decoding at any block without reading the ones before it. With
+ * flag bit 1, the last (number of pages + 7) / 8 bytes of the file are a bitmap
+ * with bit i % 8 of byte i / 8 set if page i is a write, so a trace with writes
+ * still maps and decodes its pages exactly as one without them.
+ *
+ * trace_stream reads a text trace as it arrives instead, for a producer that is
+ * still writing it (through a pipe or a FIFO): each read returns whatever pages
+ * have come in, parsed from at most STREAM_BLOCK_SIZE bytes, so nothing more than
+ * one block is ever held. A number cut off at the end of a block is finished by
+ * the next one.
+ *
+ * trace_writer writes any of the formats one page at a time, or a run of pages at
+ * a time that trace_encode has already encoded in memory (so runs can be encoded
+ * on several threads and written out in order).
+ *
+ * Usage:
+ *   Compile with another file; there is no main function
+ */
+
+//======================================================//
+
+/*
+ * Function to check whether this machine stores integers little-endian, in which
+ * case TRACE_FIXED64 pages can be used exactly as they are laid out in the file.
+ * **Returns**: nonzero if the machine is little-endian
+ */
+static int little_endian(void) {
+	const page_t one = 1;
+	return *(const char *) &one == 1;
+}
+
+/*
+ * Function to read a little-endian unsigned integer of up to 8 bytes.
+ *		:param bytes: where the integer starts
+ *		:param size: number of bytes in the integer
+ * **Returns**: the integer
+ */
+static unsigned long long get_le(const unsigned char *bytes, int size) {
+	unsigned long long value = 0;
+	int i;
+	for (i = size - 1; i >= 0; i--)
+		value = (value << 8) | bytes[i];
+	return value;
+}
+
+/*
+ * Function to write a little-endian unsigned integer of up to 8 bytes.
+ *		:param bytes: where to write the integer
+ *		:param size: number of bytes in the integer
+ *		:param value: the integer
+ */
+static void put_le(unsigned char *bytes, int size, unsigned long long value) {
+	int i;
+	for (i = 0; i < size; i++) {
+		bytes[i] = value & 0xff;
+		value >>= 8;
+	}
+}
+
+/*
+ * Function to make room for at least one more page in a trace.
+ *		:param trace: the trace to grow
+ * **Returns**: 0 on success, -1 if memory could not be allocated
+ */
+static int reserve(struct trace *trace) {
+	if (trace->num_pages < trace->capacity)
+		return 0;
+	if (trace->capacity == INT_MAX)
+		return -1;
+
+	long bigger = (trace->capacity < INITIAL_CAPACITY) ? INITIAL_CAPACITY : 2L * trace->capacity;
+	if (bigger > INT_MAX)
+		bigger = INT_MAX;
+	page_t *pages = realloc(trace->pages, bigger * sizeof(page_t));
+	if (!pages)
+		return -1;
+	trace->pages = pages;
+	if (trace->writes) {
+		unsigned char *writes = realloc(trace->writes, bigger);
+		if (!writes)
+			return -1;
+		trace->writes = writes;
+	}
+	trace->capacity = (int) bigger;
+	return 0;
+}
+
+/*
+ * Function to reset a parser before the first block of a file.
+ *		:param parser: the parser to initialize
+ */
+void trace_parser_init(struct trace_parser *parser) {
+	parser->value = 0;
+	parser->in_number = 0;
+	parser->sign = 0;
+	parser->stopped = 0;
+}
+
+/*
+ * Function to finish the number a parser is in the middle of, if any.
+ *		:param parser: the parser
+ *		:param trace: the trace the number is appended to
+ *		:param write: "boolean"; the reference writes the page
+ * **Returns**: 0 on success, -1 if memory could not be allocated
+ */
+static int finish_number(struct trace_parser *parser, struct trace *trace, int write) {
+	if (parser->in_number) {
+		if (reserve(trace) != 0)
+			return -1;
+
+		/* the first write gives the trace its flags: every reference before it read */
+		if (write && !trace->writes && !(trace->writes = calloc(trace->capacity, 1)))
+			return -1;
+		if (trace->writes)
+			trace->writes[trace->num_pages] = write;
+		trace->pages[trace->num_pages++] = parser->value;
+	}
+	parser->value = 0;
+	parser->in_number = 0;
+	parser->sign = 0;
+	return 0;
+}
+
+/*
+ * Function to parse one block of text and append the page references in it to a
+ * trace. A number cut off at the end of the block is finished by the next call
+ * (or by trace_parse_end). Numbers are read much the way fscanf's %d reads them:
+ * an optional + sign followed by digits, where a sign also ends any number right
+ * before it. A - sign ends the trace, since no page number is negative. A w right
+ * after a number marks it as a write (and an r as a read).
+ *		:param parser: parser state carried over from the previous block
+ *		:param buf: the block of text
+ *		:param len: the number of bytes in buf
+ *		:param trace: the trace to append pages to
+ * **Returns**: 0 on success, -1 if memory could not be allocated
+ */
+int trace_parse(struct trace_parser *parser, const char *buf, size_t len, struct trace *trace) {
+	size_t i;
+	for (i = 0; i < len && !parser->stopped; i++) {
+		char c = buf[i];
+		unsigned digit = (unsigned char) c - '0';
+
+		if (digit < 10) {
+			/* another digit; a number too large for a page ends the trace */
+			if (parser->value > (PAGE_NONE - 1 - digit) / 10) {
+				parser->in_number = 0;
+				parser->stopped = 1;
+			}
+			else {
+				parser->value = parser->value * 10 + digit;
+				parser->in_number = 1;
+			}
+		}
+		else if (c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f') {
+			/* separator; a sign with no digits after it ends the trace */
+			if (parser->sign != 0 && !parser->in_number)
+				parser->stopped = 1;
+			else if (finish_number(parser, trace, 0) != 0)
+				return -1;
+		}
+		else if (c == '+' && (parser->in_number || parser->sign == 0)) {
+			if (finish_number(parser, trace, 0) != 0)
+				return -1;
+			parser->sign = 1;
+		}
+		else if ((c == 'w' || c == 'r') && parser->in_number) {
+			if (finish_number(parser, trace, c == 'w') != 0)
+				return -1;
+		}
+		else {
+			/* anything else ends the trace (after the number it's glued to, if any) */
+			if (parser->in_number && finish_number(parser, trace, 0) != 0)
+				return -1;
+			parser->stopped = 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Function to finish parsing after the last block of a file.
+ *		:param parser: the parser
+ *		:param trace: the trace to append the final page to
+ * **Returns**: 0 on success, -1 if memory could not be allocated
+ */
+int trace_parse_end(struct trace_parser *parser, struct trace *trace) {
+	if (parser->stopped)
+		return 0;
+	return finish_number(parser, trace, 0);
+}
+
+/*
+ * Function to check whether a block of data starts with a binary trace header.
+ *		:param data: the start of the file
+ *		:param len: the number of bytes available
+ * **Returns**: nonzero if the data is a binary trace
+ */
+static int is_binary(const unsigned char *data, size_t len) {
+	return len >= 4 && memcmp(data, TRACE_MAGIC, 4) == 0;
+}
+
+/*
+ * Function to decode a whole binary trace held in memory.
+ *		:param trace: receives the pages
+ *		:param data: the contents of the file
+ *		:param len: the length of the file
+ *		:param mapped: "boolean"; data is a file mapping that trace may keep, so
+ *					   TRACE_FIXED pages can be used without copying them
+ * **Returns**: 0 on success, TRACE_ERR_FORMAT if the data is not a valid trace,
+ * TRACE_ERR_MEMORY if memory could not be allocated
+ */
+static int decode_binary(struct trace *trace, const unsigned char *data, size_t len, int mapped) {
+	if (len < TRACE_HEADER_SIZE || get_le(data + 4, 2) != TRACE_VERSION)
+		return TRACE_ERR_FORMAT;
+
+	int encoding = (int) get_le(data + 6, 2);
+	unsigned long long count = get_le(data + 16, 8);
+	const unsigned char *at = data + TRACE_HEADER_SIZE, *end = data + len;
+	if (count > INT_MAX ||
+		(encoding != TRACE_FIXED32 && encoding != TRACE_VARINT && encoding != TRACE_FIXED64))
+		return TRACE_ERR_FORMAT;
+
+	int n = (int) count, i;
+
+	/* the bitmap of the writes, at the very end, becomes a flag per reference */
+	if (get_le(data + 8, 4) & TRACE_FLAG_WRITES) {
+		size_t bitmap = ((size_t) n + 7) / 8;
+		if ((size_t) (end - at) < bitmap)
+			return TRACE_ERR_FORMAT;
+		end -= bitmap;
+		if (!(trace->writes = malloc(n > 0 ? n : 1)))
+			return TRACE_ERR_MEMORY;
+		for (i = 0; i < n; i++)
+			trace->writes[i] = (end[i / 8] >> (i % 8)) & 1;
+	}
+
+	if (encoding == TRACE_FIXED32 && (size_t) (end - at) / 4 < count)
+		return TRACE_ERR_FORMAT;
+	if (encoding == TRACE_FIXED64) {
+		if ((size_t) (end - at) / 8 < count)
+			return TRACE_ERR_FORMAT;
+
+		/* the pages are already laid out as a page_t array (the header keeps
+		 * them 8-byte aligned within the mapping); one pass checks that none of
+		 * them is PAGE_NONE, which the engines take for an empty frame */
+		if (mapped && little_endian()) {
+			for (i = 0; i < n; i++) {
+				if (((const page_t *) at)[i] == PAGE_NONE)
+					return TRACE_ERR_FORMAT;
+			}
+			trace->pages = (page_t *) at;
+			trace->num_pages = n;
+			trace->map = (void *) data;
+			trace->map_len = len;
+			return 0;
+		}
+	}
+
+	trace->pages = malloc((n > 0 ? n : 1) * sizeof(page_t));
+	if (!trace->pages)
+		return TRACE_ERR_MEMORY;
+	trace->capacity = n;
+
+	if (encoding == TRACE_FIXED32) {
+		for (i = 0; i < n; i++, at += 4)
+			trace->pages[i] = get_le(at, 4);
+	}
+	else if (encoding == TRACE_FIXED64) {
+		for (i = 0; i < n; i++, at += 8) {
+			trace->pages[i] = get_le(at, 8);
+			if (trace->pages[i] == PAGE_NONE)
+				return TRACE_ERR_FORMAT;
+		}
+	}
+	else {
+		page_t page = 0;
+		for (i = 0; i < n; i++) {
+			/* read one varint, then undo the zigzag encoding of the delta */
+			unsigned long long zigzag = 0;
+			int shift = 0;
+			do {
+				if (at == end || shift > 63)
+					return TRACE_ERR_FORMAT;
+				zigzag |= (unsigned long long) (*at & 0x7f) << shift;
+				shift += 7;
+			} while (*at++ & 0x80);
+
+			if (i % TRACE_INDEX_STRIDE == 0)
+				page = 0;
+			page += (zigzag >> 1) ^ -(zigzag & 1);
+			if (page == PAGE_NONE)
+				return TRACE_ERR_FORMAT;
+			trace->pages[i] = page;
+		}
+	}
+	trace->num_pages = n;
+	return 0;
+}
+
+/*
+ * Function to load every page reference in a file, in either the text or the
+ * binary format.
+ *		:param trace: receives the pages (free them with trace_free)
+ *		:param file_name: the file to read, or "-" for stdin
+ * **Returns**: 0 on success, TRACE_ERR_OPEN if the file could not be opened or
+ * read, TRACE_ERR_MEMORY if memory could not be allocated, TRACE_ERR_FORMAT if a
+ * binary trace is damaged
+ */
+int trace_load(struct trace *trace, const char *file_name) {
+	struct trace_parser parser;
+	struct stat info;
+	int fd, failed = 0;
+
+	trace->pages = NULL;
+	trace->writes = NULL;
+	trace->num_pages = trace->capacity = 0;
+	trace->map = NULL;
+	trace->map_len = 0;
+	trace_parser_init(&parser);
+
+	fd = (strcmp(file_name, "-") == 0) ? STDIN_FILENO : open(file_name, O_RDONLY);
+	if (fd < 0)
+		return TRACE_ERR_OPEN;
+
+	if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+		/* regular file: map it and decode or parse it in one go (a TRACE_FIXED64
+		 * file stays mapped and is used in place) */
+		char *text = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (text == MAP_FAILED) {
+			failed = TRACE_ERR_OPEN;
+		}
+		else if (is_binary((unsigned char *) text, info.st_size)) {
+			failed = decode_binary(trace, (unsigned char *) text, info.st_size, 1);
+			if (trace->map != text)
+				munmap(text, info.st_size);
+		}
+		else {
+			madvise(text, info.st_size, MADV_SEQUENTIAL);
+			if (trace_parse(&parser, text, info.st_size, trace) != 0)
+				failed = TRACE_ERR_MEMORY;
+			munmap(text, info.st_size);
+		}
+	}
+	else {
+		/* pipe, terminal, etc.: read it a block at a time; a binary trace is
+		 * gathered whole, since it can't be mapped */
+		unsigned char *block = malloc(READ_BLOCK_SIZE), *whole = NULL, *bigger;
+		size_t whole_len = 0;
+		ssize_t got;
+		int binary = -1;
+		if (!block)
+			failed = TRACE_ERR_MEMORY;
+		while (!failed && !parser.stopped && (got = read(fd, block, READ_BLOCK_SIZE)) != 0) {
+			if (got < 0) {
+				failed = TRACE_ERR_OPEN;
+				break;
+			}
+
+			if (binary == -1)
+				binary = is_binary(block, got);
+			if (binary) {
+				if (!(bigger = realloc(whole, whole_len + got))) {
+					failed = TRACE_ERR_MEMORY;
+				}
+				else {
+					whole = bigger;
+					memcpy(whole + whole_len, block, got);
+					whole_len += got;
+				}
+			}
+			else if (trace_parse(&parser, (char *) block, got, trace) != 0) {
+				failed = TRACE_ERR_MEMORY;
+			}
+		}
+		if (!failed && binary == 1)
+			failed = decode_binary(trace, whole, whole_len, 0);
+		free(block);
+		free(whole);
+	}
+
+	if (!failed && !trace->map && trace_parse_end(&parser, trace) != 0)
+		failed = TRACE_ERR_MEMORY;
+	if (fd != STDIN_FILENO)
+		close(fd);
+	if (failed) {
+		trace_free(trace);
+		return failed;
+	}
+	return 0;
+}
+
+/*
+ * Function to release the memory (or file mapping) held by a trace.
+ *		:param trace: the trace to free
+ */
+void trace_free(struct trace *trace) {
+	if (trace->map)
+		munmap(trace->map, trace->map_len);
+	else
+		free(trace->pages);
+	free(trace->writes);
+	trace->pages = NULL;
+	trace->writes = NULL;
+	trace->map = NULL;
+	trace->num_pages = trace->capacity = 0;
+	trace->map_len = 0;
+}
+
+/*
+ * Function to open a text trace to be read as it arrives.
+ *		:param stream: the stream to set up
+ *		:param file_name: the name of the file or FIFO to read ("-" reads stdin)
+ * **Returns**: 0, or TRACE_ERR_OPEN if the file can't be opened, or
+ *				TRACE_ERR_MEMORY if memory runs out
+ */
+int trace_stream_open(struct trace_stream *stream, const char *file_name) {
+	stream->pages.pages = NULL;
+	stream->pages.writes = NULL;
+	stream->pages.num_pages = stream->pages.capacity = 0;
+	stream->pages.map = NULL;
+	stream->pages.map_len = 0;
+	stream->started = 0;
+	trace_parser_init(&stream->parser);
+
+	if (!(stream->block = malloc(STREAM_BLOCK_SIZE)))
+		return TRACE_ERR_MEMORY;
+	stream->fd = (strcmp(file_name, "-") == 0) ? STDIN_FILENO : open(file_name, O_RDONLY);
+	if (stream->fd < 0) {
+		free(stream->block);
+		return TRACE_ERR_OPEN;
+	}
+	return 0;
+}
+
+/*
+ * Function to wait for more of a stream's pages. It returns as soon as a read
+ * brings in at least one whole page, however few.
+ *		:param stream: the stream
+ *		:param pages: where to store a pointer to the pages (valid until the next call)
+ *		:param writes: where to store a pointer to whether each of them is a write
+ *					   (valid until the next call; NULL if no page of the stream
+ *					   has been a write yet), or NULL if they aren't wanted
+ * **Returns**: the number of pages, 0 at the end of the trace, or TRACE_ERR_OPEN if
+ *				a read fails, TRACE_ERR_MEMORY if memory runs out, or
+ *				TRACE_ERR_FORMAT if the trace is binary (which can't be streamed)
+ */
+int trace_stream_read(struct trace_stream *stream, page_t **pages, unsigned char **writes) {
+	ssize_t got;
+
+	stream->pages.num_pages = 0;
+	while (stream->pages.num_pages == 0) {
+		if (stream->parser.stopped)
+			return 0;
+		got = read(stream->fd, stream->block, STREAM_BLOCK_SIZE);
+		if (got < 0)
+			return TRACE_ERR_OPEN;
+
+		if (got == 0) {
+			/* the end: only a number cut off by it can be left */
+			if (trace_parse_end(&stream->parser, &stream->pages) != 0)
+				return TRACE_ERR_MEMORY;
+			stream->parser.stopped = 1;
+		}
+		else {
+			if (!stream->started && memcmp(stream->block, TRACE_MAGIC, got < 4 ? got : 4) == 0)
+				return TRACE_ERR_FORMAT;
+			stream->started = 1;
+			if (trace_parse(&stream->parser, stream->block, got, &stream->pages) != 0)
+				return TRACE_ERR_MEMORY;
+		}
+	}
+	*pages = stream->pages.pages;
+	if (writes)
+		*writes = stream->pages.writes;
+	return stream->pages.num_pages;
+}
+
+/*
+ * Function to close a stream, and release the memory it holds.
+ *		:param stream: the stream
+ */
+void trace_stream_close(struct trace_stream *stream) {
+	if (stream->fd != STDIN_FILENO)
+		close(stream->fd);
+	free(stream->block);
+	trace_free(&stream->pages);
+}
+
+/*
+ * Function to look up an encoding by name.
+ *		:param name: "text", "fixed" (64-bit), "fixed32" or "varint"
+ * **Returns**: TRACE_TEXT, TRACE_FIXED64, TRACE_FIXED32 or TRACE_VARINT, or -2 if
+ * the name is unknown
+ */
+int trace_encoding(const char *name) {
+	if (strcmp(name, "text") == 0)
+		return TRACE_TEXT;
+	if (strcmp(name, "fixed") == 0)
+		return TRACE_FIXED64;
+	if (strcmp(name, "fixed32") == 0)
+		return TRACE_FIXED32;
+	if (strcmp(name, "varint") == 0)
+		return TRACE_VARINT;
+	return -2;
+}
+
+/*
+ * Function to write (or rewrite) the header of a binary trace at the start of the file.
+ *		:param writer: the writer
+ *		:param index_offset: byte offset of the block index, or 0 if there is none
+ * **Returns**: 0 on success, -1 if the file could not be written
+ */
+static int write_header(struct trace_writer *writer, long index_offset) {
+	unsigned char header[TRACE_HEADER_SIZE];
+	memset(header, 0, sizeof(header));
+	memcpy(header, TRACE_MAGIC, 4);
+	put_le(header + 4, 2, TRACE_VERSION);
+	put_le(header + 6, 2, writer->encoding);
+	put_le(header + 8, 4, (index_offset ? TRACE_FLAG_INDEX : 0) |
+		   (writer->writes ? TRACE_FLAG_WRITES : 0));
+	put_le(header + 16, 8, writer->num_pages);
+	put_le(header + 24, 8, index_offset);
+
+	if (fseek(writer->fp, 0, SEEK_SET) != 0 ||
+		fwrite(header, 1, sizeof(header), writer->fp) != sizeof(header))
+		return -1;
+	return 0;
+}
+
+/*
+ * Function to create a trace file to be written one page at a time.
+ *		:param writer: the writer to set up
+ *		:param file_name: the file to create
+ *		:param encoding: TRACE_TEXT, TRACE_FIXED32, TRACE_VARINT or TRACE_FIXED64
+ * **Returns**: 0 on success, TRACE_ERR_OPEN if the file could not be created
+ */
+int trace_writer_open(struct trace_writer *writer, const char *file_name, int encoding) {
+	writer->fp = fopen(file_name, (encoding == TRACE_TEXT) ? "w" : "wb");
+	writer->encoding = encoding;
+	writer->num_pages = 0;
+	writer->offset = (encoding == TRACE_TEXT) ? 0 : TRACE_HEADER_SIZE;
+	writer->placed = 0;
+	writer->prev = 0;
+	writer->index = NULL;
+	writer->index_cap = 0;
+	writer->writes = NULL;
+	writer->writes_cap = 0;
+	if (!writer->fp)
+		return TRACE_ERR_OPEN;
+
+	/* the header is written again with the final counts when the writer is closed */
+	if (encoding != TRACE_TEXT && write_header(writer, 0) != 0) {
+		fclose(writer->fp);
+		return TRACE_ERR_OPEN;
+	}
+	return 0;
+}
+
+/*
+ * Function to record where the next TRACE_VARINT block starts in the file.
+ *		:param writer: the writer
+ *		:param offset: byte offset of the block
+ * **Returns**: 0 on success, TRACE_ERR_MEMORY if memory could not be allocated
+ */
+static int index_block(struct trace_writer *writer, long offset) {
+	long block = writer->num_pages / TRACE_INDEX_STRIDE;
+	if (block == writer->index_cap) {
+		long cap = writer->index_cap ? 2 * writer->index_cap : 64;
+		long *index = realloc(writer->index, cap * sizeof(long));
+		if (!index)
+			return TRACE_ERR_MEMORY;
+		writer->index = index;
+		writer->index_cap = cap;
+	}
+	writer->index[block] = offset;
+	return 0;
+}
+
+/*
+ * Function to make the bitmap of a binary trace's writes at least some bytes long
+ * (the new bytes are all reads).
+ *		:param writer: the writer
+ *		:param bytes: the number of bytes
+ * **Returns**: 0 on success, TRACE_ERR_MEMORY if memory could not be allocated
+ */
+static int reserve_writes(struct trace_writer *writer, long bytes) {
+	if (bytes <= writer->writes_cap)
+		return 0;
+	long cap = writer->writes_cap ? 2 * writer->writes_cap : 4096;
+	while (cap < bytes)
+		cap *= 2;
+	unsigned char *writes = realloc(writer->writes, cap);
+	if (!writes)
+		return TRACE_ERR_MEMORY;
+	memset(writes + writer->writes_cap, 0, cap - writer->writes_cap);
+	writer->writes = writes;
+	writer->writes_cap = cap;
+	return 0;
+}
+
+/*
+ * Function to mark a page of a binary trace as a write, in the bitmap written at
+ * the end of the file.
+ *		:param writer: the writer
+ *		:param position: the position of the page in the trace
+ * **Returns**: 0 on success, TRACE_ERR_MEMORY if memory could not be allocated
+ */
+static int mark_write(struct trace_writer *writer, long position) {
+	if (reserve_writes(writer, position / 8 + 1) != 0)
+		return TRACE_ERR_MEMORY;
+	writer->writes[position / 8] |= 1 << (position % 8);
+	return 0;
+}
+
+/*
+ * Function to move the file position back to the end of what has been written,
+ * after runs were written past it with trace_writer_write_at.
+ *		:param writer: the writer
+ * **Returns**: 0 on success, TRACE_ERR_OPEN if the file could not be seeked
+ */
+static int resume_writing(struct trace_writer *writer) {
+	if (!writer->placed)
+		return 0;
+	writer->placed = 0;
+	return (fseek(writer->fp, writer->offset, SEEK_SET) != 0) ? TRACE_ERR_OPEN : 0;
+}
+
+/*
+ * Function to encode one page, as it is stored in a trace file.
+ *		:param encoding: TRACE_TEXT, TRACE_FIXED32, TRACE_VARINT or TRACE_FIXED64
+ *		:param page: the page
+ *		:param write: "boolean"; the reference writes the page (only text marks it
+ *					  here; the binary encodings keep the writes in a bitmap)
+ *		:param prev: the page before it (TRACE_VARINT stores the difference)
+ *		:param bytes: where to store it (room for TRACE_MAX_ENCODED bytes)
+ * **Returns**: the number of bytes stored, or TRACE_ERR_FORMAT if the page does
+ * not fit in the encoding (TRACE_FIXED32)
+ */
+static int encode_page(int encoding, page_t page, int write, page_t prev, unsigned char *bytes) {
+	int len = 0, i;
+
+	if (encoding == TRACE_TEXT) {
+		/* the digits backwards, then reversed, then the write mark and the space */
+		do {
+			bytes[len++] = '0' + page % 10;
+			page /= 10;
+		} while (page);
+		for (i = 0; i < len / 2; i++) {
+			unsigned char digit = bytes[i];
+			bytes[i] = bytes[len - 1 - i];
+			bytes[len - 1 - i] = digit;
+		}
+		if (write)
+			bytes[len++] = 'w';
+		bytes[len++] = ' ';
+	}
+	else if (encoding == TRACE_FIXED32) {
+		if (page > UINT32_MAX)
+			return TRACE_ERR_FORMAT;
+		put_le(bytes, 4, page);
+		len = 4;
+	}
+	else if (encoding == TRACE_FIXED64) {
+		put_le(bytes, 8, page);
+		len = 8;
+	}
+	else {
+		/* the delta wraps modulo 2^64, and is zigzag encoded as if it were signed */
+		page_t delta = page - prev;
+		unsigned long long zigzag = (delta << 1) ^ -(delta >> 63);
+		do {
+			bytes[len++] = (zigzag & 0x7f) | (zigzag > 0x7f ? 0x80 : 0);
+			zigzag >>= 7;
+		} while (zigzag);
+	}
+	return len;
+}
+
+/*
+ * Function to append one page to a trace file.
+ *		:param writer: the writer
+ *		:param page: the page to append
+ *		:param write: "boolean"; the reference writes the page
+ * **Returns**: 0 on success, TRACE_ERR_OPEN if the file could not be written,
+ * TRACE_ERR_MEMORY if memory could not be allocated, TRACE_ERR_FORMAT if the page
+ * does not fit in the encoding (TRACE_FIXED32)
+ */
+int trace_writer_put(struct trace_writer *writer, page_t page, int write) {
+	unsigned char bytes[TRACE_MAX_ENCODED];
+	int len;
+
+	if (resume_writing(writer) != 0)
+		return TRACE_ERR_OPEN;
+	if (writer->encoding == TRACE_TEXT) {
+		if ((len = fprintf(writer->fp, write ? "%" PRIpage "w " : "%" PRIpage " ", page)) < 0)
+			return TRACE_ERR_OPEN;
+		writer->offset += len;
+		writer->num_pages++;
+		return 0;
+	}
+	if (write && mark_write(writer, writer->num_pages) != 0)
+		return TRACE_ERR_MEMORY;
+
+	/* new block: remember where it starts, and restart the deltas */
+	if (writer->encoding == TRACE_VARINT && writer->num_pages % TRACE_INDEX_STRIDE == 0) {
+		if (index_block(writer, writer->offset) != 0)
+			return TRACE_ERR_MEMORY;
+		writer->prev = 0;
+	}
+
+	if ((len = encode_page(writer->encoding, page, write, writer->prev, bytes)) < 0)
+		return len;
+	if (fwrite(bytes, 1, len, writer->fp) != (size_t) len)
+		return TRACE_ERR_OPEN;
+	writer->prev = page;
+	writer->offset += len;
+	writer->num_pages++;
+	return 0;
+}
+
+/*
+ * Function to encode a run of pages in memory exactly as a trace_writer would
+ * write them, so runs can be encoded in parallel and then appended with
+ * trace_writer_put_encoded (or placed with trace_writer_place). For TRACE_VARINT the run has to start a block (its
+ * first page's position in the trace is a multiple of TRACE_INDEX_STRIDE).
+ *		:param encoding: TRACE_TEXT, TRACE_FIXED32, TRACE_VARINT or TRACE_FIXED64
+ *		:param pages: the pages
+ *		:param writes: whether each page is a write (NULL if none is); the binary
+ *					   encodings leave them to trace_writer_put_encoded
+ *		:param num_pages: the number of pages
+ *		:param out: where to store them (room for num_pages * TRACE_MAX_ENCODED bytes)
+ * **Returns**: the number of bytes stored, or TRACE_ERR_FORMAT if a page does not
+ * fit in the encoding (TRACE_FIXED32)
+ */
+long trace_encode(int encoding, const page_t pages[], const unsigned char writes[],
+				  int num_pages, unsigned char *out) {
+	long len = 0;
+	page_t prev = 0;
+	int i, n;
+
+	for (i = 0; i < num_pages; i++) {
+		if (i % TRACE_INDEX_STRIDE == 0)
+			prev = 0;
+		if ((n = encode_page(encoding, pages[i], writes && writes[i], prev, out + len)) < 0)
+			return n;
+		len += n;
+		prev = pages[i];
+	}
+	return len;
+}
+
+/*
+ * Function to count a run of pages encoded by trace_encode as the next part of a
+ * trace file: its pages and writes, and (TRACE_VARINT) the blocks it starts.
+ *		:param writer: the writer
+ *		:param bytes: the encoded pages
+ *		:param len: the number of bytes
+ *		:param num_pages: the number of pages they hold
+ *		:param writes: whether each page is a write (NULL if none is)
+ * **Returns**: 0 on success, TRACE_ERR_MEMORY if memory could not be allocated
+ */
+static int count_run(struct trace_writer *writer, const unsigned char *bytes,
+					 long len, int num_pages, const unsigned char writes[]) {
+	long i;
+
+	/* text marks the writes in the bytes themselves; the binary encodings in a bitmap */
+	if (writer->encoding != TRACE_TEXT && writes) {
+		for (i = 0; i < num_pages; i++) {
+			if (writes[i] && mark_write(writer, writer->num_pages + i) != 0)
+				return TRACE_ERR_MEMORY;
+		}
+	}
+
+	/* a varint page ends at each byte without its high bit set; index each block */
+	if (writer->encoding == TRACE_VARINT && num_pages > 0) {
+		long start = writer->num_pages;
+		if (index_block(writer, writer->offset) != 0)
+			return TRACE_ERR_MEMORY;
+		for (i = 0; i < len; i++) {
+			if (!(bytes[i] & 0x80) && ++writer->num_pages % TRACE_INDEX_STRIDE == 0 &&
+				i + 1 < len && index_block(writer, writer->offset + i + 1) != 0)
+				return TRACE_ERR_MEMORY;
+		}
+		writer->num_pages = start;
+	}
+
+	if (num_pages > 0)
+		writer->prev = 0;
+	writer->offset += len;
+	writer->num_pages += num_pages;
+	return 0;
+}
+
+/*
+ * Function to append a run of pages encoded by trace_encode to a trace file. For
+ * TRACE_VARINT the file has to be at a block boundary (every run appended before
+ * was a whole number of blocks long).
+ *		:param writer: the writer
+ *		:param bytes: the encoded pages
+ *		:param len: the number of bytes
+ *		:param num_pages: the number of pages they hold
+ *		:param writes: whether each page is a write (NULL if none is)
+ * **Returns**: 0 on success, TRACE_ERR_OPEN if the file could not be written,
+ * TRACE_ERR_MEMORY if memory could not be allocated
+ */
+int trace_writer_put_encoded(struct trace_writer *writer, const unsigned char *bytes,
+							 long len, int num_pages, const unsigned char writes[]) {
+	int err;
+
+	if (resume_writing(writer) != 0)
+		return TRACE_ERR_OPEN;
+	if ((err = count_run(writer, bytes, len, num_pages, writes)) != 0)
+		return err;
+	if (fwrite(bytes, 1, len, writer->fp) != (size_t) len)
+		return TRACE_ERR_OPEN;
+	return 0;
+}
+
+/*
+ * Function to reserve the next part of a trace file for a run of pages encoded
+ * by trace_encode, without writing it: the writer counts the run as if it had
+ * been appended, and returns where its bytes go. Several runs can be placed one
+ * after another and then written with trace_writer_write_at, in parallel; they
+ * all have to be written before the writer is used again. For TRACE_VARINT the
+ * run has to start a block, as with trace_writer_put_encoded.
+ *		:param writer: the writer
+ *		:param bytes: the encoded pages
+ *		:param len: the number of bytes
+ *		:param num_pages: the number of pages they hold
+ *		:param writes: whether each page is a write (NULL if none is)
+ * **Returns**: the byte offset in the file the run goes at, TRACE_ERR_OPEN if
+ * the file could not be written, or TRACE_ERR_MEMORY if memory could not be
+ * allocated
+ */
+long trace_writer_place(struct trace_writer *writer, const unsigned char *bytes,
+						long len, int num_pages, const unsigned char writes[]) {
+	long at = writer->offset;
+	int err;
+
+	/* anything still buffered goes out first, so it can't land over the run later */
+	if (fflush(writer->fp) != 0)
+		return TRACE_ERR_OPEN;
+	if ((err = count_run(writer, bytes, len, num_pages, writes)) != 0)
+		return err;
+	writer->placed = 1;
+	return at;
+}
+
+/*
+ * Function to write a run placed by trace_writer_place at its offset in the file.
+ * Different runs can be written from different threads at the same time.
+ *		:param writer: the writer
+ *		:param bytes: the encoded pages
+ *		:param len: the number of bytes
+ *		:param at: the offset trace_writer_place returned for them
+ * **Returns**: 0 on success, TRACE_ERR_OPEN if the file could not be written
+ */
+int trace_writer_write_at(const struct trace_writer *writer, const unsigned char *bytes,
+						  long len, long at) {
+	int fd = fileno(writer->fp);
+	ssize_t n;
+
+	while (len > 0) {
+		if ((n = pwrite(fd, bytes, len, at)) <= 0)
+			return TRACE_ERR_OPEN;
+		bytes += n;
+		len -= n;
+		at += n;
+	}
+	return 0;
+}
+
+/*
+ * Function to finish a trace file: write the block index (TRACE_VARINT) and the
+ * bitmap of the writes (if there were any), patch the header with the final page
+ * count, and close the file.
+ *		:param writer: the writer
+ * **Returns**: 0 on success, TRACE_ERR_OPEN if the file could not be written
+ */
+int trace_writer_close(struct trace_writer *writer) {
+	long index_offset = 0;
+	int failed = 0;
+
+	failed |= resume_writing(writer) != 0;
+	if (writer->encoding == TRACE_VARINT) {
+		long blocks = (writer->num_pages + TRACE_INDEX_STRIDE - 1) / TRACE_INDEX_STRIDE, i;
+		unsigned char entry[8];
+
+		index_offset = writer->offset;
+		put_le(entry, 8, blocks);
+		failed |= fwrite(entry, 1, 8, writer->fp) != 8;
+		for (i = 0; i < blocks; i++) {
+			put_le(entry, 8, writer->index[i]);
+			failed |= fwrite(entry, 1, 8, writer->fp) != 8;
+		}
+	}
+	if (writer->encoding != TRACE_TEXT && writer->writes) {
+		long bytes = (writer->num_pages + 7) / 8;
+		failed |= reserve_writes(writer, bytes) != 0 ||
+				  fwrite(writer->writes, 1, bytes, writer->fp) != (size_t) bytes;
+	}
+	if (writer->encoding != TRACE_TEXT)
+		failed |= write_header(writer, index_offset) != 0;
+
+	failed |= fclose(writer->fp) != 0;
+	free(writer->index);
+	free(writer->writes);
+	writer->index = NULL;
+	writer->writes = NULL;
+	return failed ? TRACE_ERR_OPEN : 0;
+}
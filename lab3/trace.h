@@ -0,0 +1,91 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "page.h"
+
+#define TRACE_ERR_OPEN -1
+#define TRACE_ERR_MEMORY -2
+#define TRACE_ERR_FORMAT -3
+
+/* binary trace format (see trace.c): header fields and page encodings */
+#define TRACE_MAGIC "PGTR"
+#define TRACE_VERSION 1
+#define TRACE_HEADER_SIZE 32
+#define TRACE_FLAG_INDEX 1
+#define TRACE_FLAG_WRITES 2		/* a bitmap of the writes ends the file */
+#define TRACE_INDEX_STRIDE 65536
+
+#define TRACE_TEXT -1		/* not a binary encoding: whitespace separated numbers (w marks a write) */
+#define TRACE_FIXED32 0		/* 32-bit little-endian page numbers */
+#define TRACE_VARINT 1		/* zigzag LEB128 deltas, restarting every TRACE_INDEX_STRIDE pages */
+#define TRACE_FIXED64 2		/* 64-bit little-endian page numbers */
+
+#define TRACE_MAX_ENCODED 22	/* most bytes one page takes in any encoding (text: 20 digits, w and a space) */
+
+/* a sequence of page references loaded from a file */
+struct trace {
+	page_t *pages;		/* the page references */
+	unsigned char *writes;	/* 1 for each reference that writes its page, 0 for a read
+						   (NULL if every reference is a read) */
+	int num_pages;		/* number of page references */
+	int capacity;		/* number of pages the array has room for (0 if mapped) */
+	void *map;			/* file mapping pages points into, if it wasn't copied (else NULL) */
+	size_t map_len;		/* length of that mapping */
+};
+
+/* state carried between blocks while parsing text: a number may span two blocks */
+struct trace_parser {
+	page_t value;		/* value of the number being read so far */
+	int in_number;		/* "boolean"; digits of a number have been read, but not its end */
+	int sign;			/* "boolean"; a + sign was read in front of the number */
+	int stopped;		/* "boolean"; something other than a number was found */
+};
+
+/* a text trace read as it arrives (e.g., from a pipe), a block at a time */
+struct trace_stream {
+	int fd;				/* the file being read */
+	char *block;		/* the bytes of the latest read */
+	struct trace_parser parser;
+	struct trace pages;	/* the pages parsed from the latest read (reused each time) */
+	int started;		/* "boolean"; the first bytes have been read (and checked) */
+};
+
+/* a trace file being written one page at a time */
+struct trace_writer {
+	FILE *fp;			/* the output file */
+	int encoding;		/* TRACE_TEXT, TRACE_FIXED32, TRACE_VARINT or TRACE_FIXED64 */
+	long num_pages;		/* pages written so far */
+	long offset;		/* bytes written so far */
+	int placed;			/* "boolean"; runs were placed past the file position (see
+						 * trace_writer_place), so it has to move to the end */
+	page_t prev;		/* previous page (TRACE_VARINT deltas are taken against it) */
+	long *index;		/* byte offset of each TRACE_INDEX_STRIDE block (TRACE_VARINT) */
+	long index_cap;		/* number of entries index has room for */
+	unsigned char *writes;	/* binary: bitmap of the pages that are writes (NULL until one is) */
+	long writes_cap;	/* number of bytes writes has room for */
+};
+
+int trace_load(struct trace *trace, const char *file_name);
+void trace_free(struct trace *trace);
+void trace_parser_init(struct trace_parser *parser);
+int trace_parse(struct trace_parser *parser, const char *buf, size_t len, struct trace *trace);
+int trace_parse_end(struct trace_parser *parser, struct trace *trace);
+int trace_stream_open(struct trace_stream *stream, const char *file_name);
+int trace_stream_read(struct trace_stream *stream, page_t **pages, unsigned char **writes);
+void trace_stream_close(struct trace_stream *stream);
+int trace_encoding(const char *name);
+int trace_writer_open(struct trace_writer *writer, const char *file_name, int encoding);
+int trace_writer_put(struct trace_writer *writer, page_t page, int write);
+long trace_encode(int encoding, const page_t pages[], const unsigned char writes[],
+				  int num_pages, unsigned char *out);
+int trace_writer_put_encoded(struct trace_writer *writer, const unsigned char *bytes,
+							 long len, int num_pages, const unsigned char writes[]);
+long trace_writer_place(struct trace_writer *writer, const unsigned char *bytes,
+						long len, int num_pages, const unsigned char writes[]);
+int trace_writer_write_at(const struct trace_writer *writer, const unsigned char *bytes,
+						  long len, long at);
+int trace_writer_close(struct trace_writer *writer);
+
+#endif
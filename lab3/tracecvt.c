@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "trace.h"
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * tracecvt converts a file of page references from one format to another. The
+ * input can be a text trace (as written by pagegenerator) or a binary trace (see
+ * trace.c); its format is detected automatically. By default the output is a
+ * binary trace with 64-bit pages, which pagesim and pagestats can map and use
+ * without parsing or copying it. References marked as writes stay writes in
+ * every format.
+ *
+ * The output is written to a temporary file beside it, which only replaces the
+ * output once the whole trace has been written, so a conversion that fails leaves
+ * no partial trace behind (and an existing output is kept as it was). The input
+ * and the output can't be the same file.
+ *
+ * Usage:
+ *   tracecvt [-f format] infile outfile
+ *
+ * tracecvt accepts two command-line arguments, plus an optional format
+ * -f      - (optional) output format: fixed (default), fixed32, varint, or text
+ * infile  - the name of the trace to read ("-" reads stdin)
+ * outfile - the name of the trace to write
+ */
+
+//======================================================//
+const char * usage = "Usage:"
+"   tracecvt [-f format] infile outfile\n"
+"\n"
+"tracecvt accepts two command-line arguments, plus an optional format\n"
+"-f      - (optional) output format: fixed (default), fixed32, varint, or text\n"
+"infile  - the name of the trace to read (\"-\" reads stdin)\n"
+"outfile - the name of the trace to write\n"
+"\n";
+//======================================================//
+
+/*
+ * This function reports an error in writing the output, removes the temporary
+ * file it was being written to, and exits.
+ *		:param action: what could not be done to the output (i.e., "write")
+ *		:param out_name: the name of the output file
+ *		:param tmp_name: the temporary file
+ */
+void fail(const char *action, const char *out_name, const char *tmp_name) {
+	printf("Error: cannot %s file %s\n", action, out_name);
+	unlink(tmp_name);
+	exit(1);
+}
+
+/*
+ * This function creates an empty temporary file in the same directory as the
+ * output, with the permissions a new output file would have been given.
+ *		:param out_name: the name of the output file
+ * **Returns**: the name of the temporary file (free it), or NULL if it could not be
+ *				created
+ */
+char * temp_output(const char *out_name) {
+	char *tmp_name = malloc(strlen(out_name) + sizeof(".XXXXXX"));
+	mode_t mask;
+	int fd;
+
+	if (!tmp_name)
+		return NULL;
+	sprintf(tmp_name, "%s.XXXXXX", out_name);
+	if ((fd = mkstemp(tmp_name)) < 0) {
+		free(tmp_name);
+		return NULL;
+	}
+	mask = umask(0);
+	umask(mask);
+	fchmod(fd, 0666 & ~mask);
+	close(fd);
+	return tmp_name;
+}
+
+/*
+ * Main function for the tracecvt application. This function reads the whole
+ * input trace, then writes every page to a temporary file in the chosen format,
+ * and moves it over the output trace once it is complete.
+ */
+int main(int argc, char *argv[]) {
+
+	int encoding = TRACE_FIXED64;	/* format of the output file */
+	struct trace trace;			/* the pages read from the input file */
+	struct trace_writer writer;	/* the output file */
+	struct stat in_info, out_info;
+	char *in_name, *out_name, *tmp_name;
+	int opt, i, err;
+
+	/* checking the options, then the rest of the input from the command line */
+	while ((opt = getopt(argc, argv, "f:")) != -1) {
+		if (opt == 'f' && (encoding = trace_encoding(optarg)) == -2) {
+			printf("Error: unknown format %s (fixed, fixed32, varint, or text).\n\n%s", optarg, usage);
+			exit(1);
+		}
+		else if (opt != 'f') {
+			printf("Error: Invalid option.\n\n%s", usage);
+			exit(1);
+		}
+	}
+	if (argc - optind != 2) {
+		printf("Error: Invalid number of parameters.\n\n%s", usage);
+		exit(1);
+	}
+	in_name = argv[optind];
+	out_name = argv[optind + 1];
+
+	/* writing over the input would destroy it (a binary trace is read in place) */
+	err = (strcmp(in_name, "-") == 0) ? fstat(STDIN_FILENO, &in_info) : stat(in_name, &in_info);
+	if (err == 0 && stat(out_name, &out_info) == 0 && in_info.st_dev == out_info.st_dev &&
+		in_info.st_ino == out_info.st_ino) {
+		printf("Error: %s and %s are the same file.\n", in_name, out_name);
+		exit(1);
+	}
+
+	/* read the input trace, whatever its format */
+	err = trace_load(&trace, in_name);
+	if (err == TRACE_ERR_OPEN) {
+		printf("Error: cannot open file %s for reading.\n", in_name);
+		exit(1);
+	}
+	else if (err == TRACE_ERR_MEMORY) {
+		printf("Error: cannot allocate memory for the page references in %s.\n", in_name);
+		exit(1);
+	}
+	else if (err == TRACE_ERR_FORMAT) {
+		printf("Error: %s is not a valid trace file.\n", in_name);
+		exit(1);
+	}
+
+	/* write it back out in the chosen format, then put it in place */
+	if (!(tmp_name = temp_output(out_name))) {
+		printf("Error: cannot create file %s\n", out_name);
+		exit(1);
+	}
+	if (trace_writer_open(&writer, tmp_name, encoding) != 0)
+		fail("create", out_name, tmp_name);
+	for (i = 0, err = 0; i < trace.num_pages && err == 0; i++)
+		err = trace_writer_put(&writer, trace.pages[i], trace.writes && trace.writes[i]);
+	if (err == TRACE_ERR_FORMAT) {
+		printf("Error: page %" PRIpage " does not fit in the fixed32 format.\n", trace.pages[i - 1]);
+		unlink(tmp_name);
+		exit(1);
+	}
+	if (err != 0 || trace_writer_close(&writer) != 0)
+		fail("write", out_name, tmp_name);
+	if (rename(tmp_name, out_name) != 0)
+		fail("replace", out_name, tmp_name);
+
+	free(tmp_name);
+	trace_free(&trace);
+	return 0;
+}
@@ -0,0 +1,352 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "algorithms.h"
+#include "pagemap.h"
+#include "workingset.h"
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * workingset contains the variable-allocation page replacement algorithms, whose
+ * resident set grows and shrinks during a run instead of always filling frame_num
+ * frames. frame_num is the most memory they may use; frames they let go of are
+ * empty again (PAGE_NONE) until a later fault takes them.
+ *
+ * - ws: Denning's working set. The resident set is exactly the pages among the
+ *   last tau references, tau being frame_num (so it never outgrows memory): as each
+ *   reference arrives, the reference tau back leaves the window, and its page is
+ *   released if that was its last use. A ring of the frames the last tau
+ *   references used makes this O(1) per reference.
+ * - pff: page fault frequency (Chu & Opderbeck, 1972). On a fault, if more than
+ *   tau references (half as many as there are frames) have gone by since the last
+ *   one, faults are rare enough that the resident set shrinks to the pages
+ *   referenced since then; otherwise it just grows by the new page. If memory is
+ *   full, a hand looks for a page not referenced since the last fault to evict (or,
+ *   if there is none, the least recently used page it passed). The shrink scans
+ *   every frame, but it only happens after a fault-free stretch of more than tau
+ *   references, so it costs O(1) per reference overall.
+ *
+ * wss_timeline is the analyzer that goes with them: the working set size over the
+ * course of a reference string, for several values of tau at once. The working set
+ * of window tau changes by at most one page in and one page out per reference: the
+ * new reference's page joins it if it was last referenced tau or more references
+ * ago, and the page of the reference tau back leaves it if its next reference is
+ * tau or more references after that one (i.e., not within the window). The
+ * distances back are found with a pagemap of every page's last position, and the
+ * distances ahead are recorded there as they are found, in a ring over the last
+ * (largest tau) references, so each reference costs one lookup plus O(1) per tau.
+ *
+ * Usage:
+ *   Compile with another file; there is no main function
+ */
+
+//======================================================//
+
+/* a working set or page fault frequency engine */
+struct ws_engine {
+	struct engine base;
+	struct pagemap index;	/* page -> frame slot of the resident pages */
+	int *free_slots;		/* stack of the empty frames */
+	int num_free;
+	int *last_use;			/* time each frame's page was last referenced (-1 if empty) */
+	int now;				/* references so far (the virtual time) */
+	int tau;				/* ws: the window; pff: the longest stretch without a fault
+							   for the faults to count as frequent */
+	int *window;			/* ws: frame each of the last tau references used (a ring) */
+	int at;					/* ws: position of the current reference in the ring */
+	int last_fault;			/* pff: time of the last fault */
+	int hand;				/* pff: the frame the search for a victim looks at next */
+};
+
+static void ws_destroy(struct engine *engine);
+
+/*
+ * Function to set up a working set or page fault frequency engine with empty frames.
+ *		:param arr: an array of pages to be allocated
+ *		:param arr_size: the number of pages to be allocated
+ *		:param frame_num: the number of frames in physical memory
+ *		:param pff: "boolean"; the engine runs pff rather than ws
+ * **Returns**: the engine, or NULL if memory could not be allocated
+ */
+static struct ws_engine * ws_new(page_t arr[], int arr_size, int frame_num, int pff) {
+	struct ws_engine *e = calloc(1, sizeof(struct ws_engine));
+	int i;
+	if (!e)
+		return NULL;
+	if (engine_init(&e->base, frame_num) != 0 ||
+		!(e->free_slots = malloc((frame_num + 1) * sizeof(int))) ||
+		!(e->last_use = malloc((frame_num + 1) * sizeof(int))) ||
+		pagemap_init(&e->index, frame_num, page_span(arr, arr_size)) != 0 ||
+		(!pff && !(e->window = malloc((frame_num + 1) * sizeof(int))))) {
+		ws_destroy(&e->base);
+		return NULL;
+	}
+	for (i = 0; i < frame_num; i++) {
+		e->free_slots[i] = frame_num - 1 - i;
+		e->last_use[i] = -1;
+	}
+	e->num_free = frame_num;
+	e->now = 0;
+	e->tau = pff ? frame_num / 2 : frame_num;
+	e->at = 0;
+	e->last_fault = 0;
+	e->hand = 0;
+	return e;
+}
+
+/*
+ * Function to load a page into an empty frame, or in place of a victim.
+ *		:param e: the engine
+ *		:param slot: the frame slot
+ *		:param page: the page
+ */
+static void ws_load(struct ws_engine *e, int slot, page_t page) {
+	if (e->base.frames[slot] != PAGE_NONE)
+		pagemap_remove(&e->index, e->base.frames[slot]);
+	e->base.frames[slot] = page;
+	e->base.slot = slot;
+	e->last_use[slot] = e->now;
+	pagemap_put(&e->index, page, slot);
+}
+
+/*
+ * Function to take a page out of memory, leaving its frame empty.
+ *		:param e: the engine
+ *		:param slot: the page's frame slot
+ */
+static void ws_release(struct ws_engine *e, int slot) {
+	pagemap_remove(&e->index, e->base.frames[slot]);
+	engine_release(&e->base, slot);
+	e->last_use[slot] = -1;
+	e->free_slots[e->num_free++] = slot;
+}
+
+/*
+ * Function to handle one reference under the working set policy.
+ *		:param e: the engine
+ *		:param page: the page referenced
+ * **Returns**: 1 if the page faulted, 0 otherwise
+ */
+static int ws_step(struct ws_engine *e, page_t page) {
+	int slot, faulted = 0;
+
+	/* the reference tau back leaves the window, and its page the working set if that
+	 * was its last use (so there is always a free frame for this one) */
+	if (e->tau > 0 && e->now >= e->tau) {
+		slot = e->window[e->at];
+		if (e->last_use[slot] == e->now - e->tau)
+			ws_release(e, slot);
+	}
+
+	slot = pagemap_get(&e->index, page);
+	if (slot == -1) {
+		faulted = 1;
+		if (e->tau > 0) {
+			slot = e->free_slots[--e->num_free];
+			ws_load(e, slot, page);
+		}
+	}
+	if (slot != -1) {
+		e->last_use[slot] = e->now;
+		e->window[e->at] = slot;
+		if (++e->at == e->tau)
+			e->at = 0;
+	}
+	e->now++;
+	engine_count(&e->base, faulted);
+	return faulted;
+}
+
+/*
+ * Function to find a victim when memory is full under page fault frequency: the
+ * first frame from the hand whose page hasn't been referenced since the last fault,
+ * or, if a whole turn finds none, the least recently used page.
+ *		:param e: the engine (with at least one frame, all full)
+ * **Returns**: the victim's frame slot
+ */
+static int pff_sweep(struct ws_engine *e) {
+	int n = e->base.frame_num, at = e->hand, oldest = e->hand, i;
+	for (i = 0; i < n; i++) {
+		if (e->last_use[at] < e->last_fault)
+			break;
+		if (e->last_use[at] < e->last_use[oldest])
+			oldest = at;
+		if (++at == n)
+			at = 0;
+	}
+	if (i == n)
+		at = oldest;
+	e->hand = (at + 1 < n) ? at + 1 : 0;
+	return at;
+}
+
+/*
+ * Function to handle one reference under the page fault frequency policy.
+ *		:param e: the engine
+ *		:param page: the page referenced
+ * **Returns**: 1 if the page faulted, 0 otherwise
+ */
+static int pff_step(struct ws_engine *e, page_t page) {
+	int slot = pagemap_get(&e->index, page), faulted = 0, i;
+	if (slot != -1) {
+		e->last_use[slot] = e->now;
+	}
+	else {
+		faulted = 1;
+		if (e->base.frame_num > 0) {
+			/* faults far apart: keep only the pages referenced since the last one */
+			if (e->now - e->last_fault > e->tau) {
+				for (i = 0; i < e->base.frame_num; i++) {
+					if (e->last_use[i] >= 0 && e->last_use[i] < e->last_fault)
+						ws_release(e, i);
+				}
+			}
+			slot = (e->num_free > 0) ? e->free_slots[--e->num_free] : pff_sweep(e);
+			ws_load(e, slot, page);
+		}
+		e->last_fault = e->now;
+	}
+	e->now++;
+	engine_count(&e->base, faulted);
+	return faulted;
+}
+
+/* the working set engines' init, access, batch access and destroy entry points
+ * (see struct policy) */
+static struct engine * ws_init(page_t arr[], int arr_size, int frame_num) {
+	struct ws_engine *e = ws_new(arr, arr_size, frame_num, 0);
+	return e ? &e->base : NULL;
+}
+
+static struct engine * pff_init(page_t arr[], int arr_size, int frame_num) {
+	struct ws_engine *e = ws_new(arr, arr_size, frame_num, 1);
+	return e ? &e->base : NULL;
+}
+
+static int ws_access(struct engine *engine, page_t page) {
+	return ws_step((struct ws_engine *) engine, page);
+}
+
+static int pff_access(struct engine *engine, page_t page) {
+	return pff_step((struct ws_engine *) engine, page);
+}
+
+static void ws_access_batch(struct engine *engine, page_t pages[], int count) {
+	struct ws_engine *e = (struct ws_engine *) engine;
+	int i;
+	for (i = 0; i < count; i++)
+		ws_step(e, pages[i]);
+}
+
+static void pff_access_batch(struct engine *engine, page_t pages[], int count) {
+	struct ws_engine *e = (struct ws_engine *) engine;
+	int i;
+	for (i = 0; i < count; i++)
+		pff_step(e, pages[i]);
+}
+
+static void ws_destroy(struct engine *engine) {
+	struct ws_engine *e = (struct ws_engine *) engine;
+	pagemap_destroy(&e->index);
+	free(e->free_slots);
+	free(e->last_use);
+	free(e->window);
+	engine_free(engine);
+	free(e);
+}
+
+const struct policy ws_policy = {
+	"ws", "WS", MAX_FAST_MEMORY_FRAMES, 0, 0, 0, NULL,
+	ws_init, ws_access, ws_access_batch, engine_stats, ws_destroy
+};
+
+const struct policy pff_policy = {
+	"pff", "PFF", MAX_FAST_MEMORY_FRAMES, 0, 0, 0, NULL,
+	pff_init, pff_access, pff_access_batch, engine_stats, ws_destroy
+};
+
+//======================================================//
+
+/*
+ * Function to compute the working set size over the course of a reference string,
+ * for several windows at once, as the mean size over each interval of references.
+ *		:param arr: the page references
+ *		:param arr_size: the number of page references
+ *		:param taus: the windows (positive)
+ *		:param num_taus: the number of windows
+ *		:param interval: the number of references per interval (positive)
+ *		:param means: an array which will store the mean working set size of each
+ *					  interval for each window, num_taus per interval (the last
+ *					  interval may be shorter)
+ *		:param peaks: an array which will store the largest working set size of each
+ *					  window
+ * **Returns**: 0 on success, -1 if memory could not be allocated
+ */
+int wss_timeline(page_t arr[], int arr_size, const int taus[], int num_taus, int interval,
+				 double means[], int peaks[]) {
+	struct pagemap last;	/* page -> position of its last reference */
+	int max_tau = 0, k, t, prev, back, at, from, err = 0;
+
+	for (k = 0; k < num_taus; k++) {
+		if (taus[k] > max_tau)
+			max_tau = taus[k];
+		peaks[k] = 0;
+	}
+
+	/* distance ahead to the next reference to the same page, of each of the last
+	 * max_tau + 1 references (INT_MAX until it's known) */
+	int ring_len = max_tau + 1;
+	int *ahead = malloc(ring_len * sizeof(int));
+	int *size = calloc(num_taus, sizeof(int));		/* working set size of each window */
+	long *sums = calloc(num_taus, sizeof(long));	/* their sum over the interval so far */
+	if (!ahead || !size || !sums || pagemap_init(&last, 1024, page_span(arr, arr_size)) != 0) {
+		free(ahead);
+		free(size);
+		free(sums);
+		return -1;
+	}
+
+	at = 0;
+	for (t = 0; t < arr_size && err == 0; t++) {
+		prev = pagemap_get(&last, arr[t]);
+		back = (prev < 0) ? INT_MAX : t - prev;
+		err = pagemap_put(&last, arr[t], t);
+		ahead[at] = INT_MAX;
+		if (back <= max_tau)
+			ahead[(at >= back) ? at - back : at - back + ring_len] = back;
+
+		for (k = 0; k < num_taus; k++) {
+			if (back >= taus[k])
+				size[k]++;
+			if (t >= taus[k]) {
+				from = (at >= taus[k]) ? at - taus[k] : at - taus[k] + ring_len;
+				if (ahead[from] >= taus[k])
+					size[k]--;
+			}
+			sums[k] += size[k];
+			if (size[k] > peaks[k])
+				peaks[k] = size[k];
+		}
+		if (++at == ring_len)
+			at = 0;
+
+		/* the end of an interval (or of the references) */
+		if ((t + 1) % interval == 0 || t == arr_size - 1) {
+			double *row = &means[(t / interval) * num_taus];
+			int refs = t % interval + 1;
+			for (k = 0; k < num_taus; k++) {
+				row[k] = (double) sums[k] / refs;
+				sums[k] = 0;
+			}
+		}
+	}
+
+	pagemap_destroy(&last);
+	free(ahead);
+	free(size);
+	free(sums);
+	return (err == 0) ? 0 : -1;
+}
@@ -0,0 +1,13 @@
+#ifndef WORKINGSET_H
+#define WORKINGSET_H
+
+#include "page.h"
+#include "policy.h"
+
+extern const struct policy ws_policy;
+extern const struct policy pff_policy;
+
+int wss_timeline(page_t arr[], int arr_size, const int taus[], int num_taus, int interval,
+				 double means[], int peaks[]);
+
+#endif
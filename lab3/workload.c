@@ -0,0 +1,476 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "workload.h"
+
+#define SEQ_DEFAULT_RUN 256		/* default run length of a sequential scan */
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * workload describes the reference patterns pagegenerator can produce, so traces
+ * can have the locality real programs do, instead of only uniformly random pages.
+ * A workload is given as a string of one or more patterns separated by commas:
+ *
+ *   uniform               every page from 0 to range - 1 equally likely
+ *   zipf[:s]              page k is referenced in proportion to 1 / (k + 1)^s
+ *                         (s > 0, default 1): a few hot pages, and a long tail
+ *   phase[:size[:period]] uniform within a working set of size consecutive pages
+ *                         (default range / 10), which moves somewhere new every
+ *                         period references (default count / 10)
+ *   seq[:run]             sequential scans: runs of run consecutive pages (default
+ *                         256), each starting at a new random page
+ *   loop[:length]         a looping scan over pages 0 to length - 1 (default
+ *                         range / 2), which defeats LRU whenever it doesn't fit
+ *
+ * and each pattern can end with @weight (default 1) to make a mixture, in which
+ * each reference comes from one pattern, chosen in proportion to the weights
+ * (e.g., "zipf:0.9@8,loop:500@1,uniform@1").
+ *
+ * Every pattern is sampled in constant time. Zipf uses rejection-inversion
+ * (Hormann & Derflinger, 1996), which needs no table however large the range, and
+ * the pattern of each reference in a mixture is chosen with an alias table.
+ *
+ * The random numbers come from Philox4x32-10 (Salmon et al., 2011), a counter-based
+ * generator: its output is a keyed hash of a counter, with no state carried from
+ * one number to the next. The key is the seed, and the counter is the position of
+ * the reference, how many times it has been drawn again (see below), and how many
+ * numbers this draw has used so far. Where a phase's working set or a scan's run
+ * starts is likewise a hash of the seed and the number of the phase or run. So
+ * every candidate for reference i is a function of the seed and i alone, and any
+ * part of a trace can be generated on its own thread.
+ *
+ * No page may equal the one before it; a candidate that does is drawn again. That
+ * makes each reference depend on the one before, so a part generated on its own
+ * starts from a guess at the page before it (the first candidate for it), and once
+ * the part before is done, workload_refill redoes the start of the part if the
+ * guess was wrong, up to where it agrees again (almost always at once). The trace
+ * is then the same however it was split up.
+ *
+ * Any workload can also write: each reference writes its page with probability
+ * write_ratio, decided by a hash of the seed and its position alone, so the
+ * writes don't depend on the pages, or on how the trace was split up either.
+ *
+ * Usage:
+ *   Compile with another file; there is no main function
+ */
+
+//======================================================//
+
+/*
+ * Function to scramble a number (the splitmix64 finalizer), for choices made by
+ * position rather than by drawing a random number.
+ *		:param x: the number
+ * **Returns**: a hash of it
+ */
+static uint64_t mix64(uint64_t x) {
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+/*
+ * Function to run the Philox4x32-10 block function: ten rounds of multiplies and
+ * xors that turn a 128-bit counter into 128 random bits under a 64-bit key.
+ *		:param ctr: the counter
+ *		:param key: the key
+ *		:param out: where to store the random bits
+ */
+static void philox(const uint32_t ctr[4], const uint32_t key[2], uint32_t out[4]) {
+	uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+	uint32_t k0 = key[0], k1 = key[1];
+	int round;
+
+	for (round = 0; round < 10; round++) {
+		uint64_t p0 = (uint64_t) 0xD2511F53 * c0, p1 = (uint64_t) 0xCD9E8D57 * c2;
+		c0 = (uint32_t) (p1 >> 32) ^ c1 ^ k0;
+		c1 = (uint32_t) p1;
+		c2 = (uint32_t) (p0 >> 32) ^ c3 ^ k1;
+		c3 = (uint32_t) p0;
+		k0 += 0x9E3779B9;
+		k1 += 0xBB67AE85;
+	}
+	out[0] = c0;
+	out[1] = c1;
+	out[2] = c2;
+	out[3] = c3;
+}
+
+/* the random numbers of one draw of one reference */
+struct draws {
+	uint32_t key[2];	/* the seed */
+	uint32_t ctr[4];	/* reference (low and high word), attempt, block of numbers */
+	uint32_t out[4];	/* the current block of numbers */
+	int left;			/* 64-bit numbers left in it */
+};
+
+/*
+ * Function to take the next 64 random bits of a draw.
+ *		:param d: the draw
+ * **Returns**: the random bits
+ */
+static uint64_t next_draw(struct draws *d) {
+	if (d->left == 0) {
+		philox(d->ctr, d->key, d->out);
+		d->ctr[3]++;
+		d->left = 2;
+	}
+	d->left--;
+	return ((uint64_t) d->out[2 * d->left + 1] << 32) | d->out[2 * d->left];
+}
+
+/*
+ * Function to turn 64 random bits into a number uniformly distributed in [0, 1).
+ *		:param bits: the random bits
+ * **Returns**: the number
+ */
+static double unit(uint64_t bits) {
+	return (bits >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* log1p(x) / x and expm1(x) / x, which stay accurate as x goes to 0 */
+static double helper1(double x) {
+	return (fabs(x) > 1e-8) ? log1p(x) / x : 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x));
+}
+
+static double helper2(double x) {
+	return (fabs(x) > 1e-8) ? expm1(x) / x : 1 + x * 0.5 * (1 + x / 3 * (1 + 0.25 * x));
+}
+
+/* the Zipf hat function h(x) = x^-s, its integral H, and H's inverse */
+static double zipf_h(double s, double x) {
+	return exp(-s * log(x));
+}
+
+static double zipf_hint(double s, double x) {
+	double log_x = log(x);
+	return helper2((1 - s) * log_x) * log_x;
+}
+
+static double zipf_hinv(double s, double x) {
+	double t = x * (1 - s);
+	if (t < -1)
+		t = -1;
+	return exp(helper1(t) * x);
+}
+
+/*
+ * Function to draw a Zipf distributed rank by rejection-inversion.
+ *		:param part: the pattern (with its constants set up)
+ *		:param range: the number of ranks
+ *		:param d: the draw to take random numbers from
+ * **Returns**: a rank from 1 to range
+ */
+static page_t zipf_rank(const struct workload_part *part, page_t range, struct draws *d) {
+	for (;;) {
+		double u = part->h_n + unit(next_draw(d)) * (part->h_x1 - part->h_n);
+		double x = zipf_hinv(part->s, u);
+		page_t k;
+
+		if (x < 1.5)
+			k = 1;
+		else if (x + 0.5 >= (double) range)
+			k = range;
+		else
+			k = (page_t) (x + 0.5);
+
+		if ((double) k - x <= part->accept ||
+			u >= zipf_hint(part->s, (double) k + 0.5) - zipf_h(part->s, (double) k))
+			return k;
+	}
+}
+
+/*
+ * Function to build the alias table that chooses a part of a workload in
+ * proportion to the parts' weights (Vose's method).
+ *		:param workload: the workload (with its parts set up)
+ */
+static void build_alias(struct workload *workload) {
+	int n = workload->num_parts, small[WORKLOAD_MAX_PARTS], large[WORKLOAD_MAX_PARTS];
+	int num_small = 0, num_large = 0, i;
+	double scaled[WORKLOAD_MAX_PARTS], total = 0;
+
+	for (i = 0; i < n; i++)
+		total += workload->parts[i].weight;
+	for (i = 0; i < n; i++) {
+		scaled[i] = workload->parts[i].weight * n / total;
+		workload->alias[i] = i;
+		if (scaled[i] < 1)
+			small[num_small++] = i;
+		else
+			large[num_large++] = i;
+	}
+
+	/* pair each short column with a tall one that tops it up */
+	while (num_small > 0 && num_large > 0) {
+		int s = small[--num_small], l = large[num_large - 1];
+		workload->prob[s] = scaled[s];
+		workload->alias[s] = l;
+		scaled[l] -= 1 - scaled[s];
+		if (scaled[l] < 1) {
+			num_large--;
+			small[num_small++] = l;
+		}
+	}
+	while (num_large > 0)
+		workload->prob[large[--num_large]] = 1;
+	while (num_small > 0)
+		workload->prob[small[--num_small]] = 1;
+}
+
+/*
+ * Function to read an optional number parameter of a pattern.
+ *		:param spec: where the parameter would start (at a ':' if it's there)
+ *		:param value: where to store it, if it's there
+ * **Returns**: where the rest of the pattern starts, or NULL if the parameter
+ *				isn't a number
+ */
+static const char * parse_param(const char *spec, double *value) {
+	char *end;
+	if (*spec != ':')
+		return spec;
+	*value = strtod(spec + 1, &end);
+	return (end == spec + 1) ? NULL : end;
+}
+
+/*
+ * Function to set up one pattern of a workload from its parameters.
+ *		:param part: the pattern (with its kind set)
+ *		:param p1: its first parameter, or -1 if none was given
+ *		:param p2: its second parameter, or -1 if none was given
+ *		:param range: pages are drawn from 0 to range - 1
+ *		:param count: the length of the trace
+ * **Returns**: 0, or -1 if the parameters aren't valid for the pattern
+ */
+static int setup_part(struct workload_part *part, double p1, double p2, page_t range,
+					  long count) {
+	part->size = 0;
+	part->period = 0;
+	if (p2 >= 0 && part->kind != WORKLOAD_PHASE)
+		return -1;
+
+	switch (part->kind) {
+	case WORKLOAD_ZIPF:
+		part->s = (p1 < 0) ? 1.0 : p1;
+		if (!(part->s > 0))
+			return -1;
+		part->h_x1 = zipf_hint(part->s, 1.5) - 1;
+		part->h_n = zipf_hint(part->s, (double) range + 0.5);
+		part->accept = 2 - zipf_hinv(part->s, zipf_hint(part->s, 2.5) - zipf_h(part->s, 2));
+		return 0;
+
+	case WORKLOAD_PHASE:
+		part->size = (p1 < 0) ? range / 10 : (page_t) p1;
+		part->period = (p2 < 0) ? count / 10 : (long) p2;
+		if (part->size < 2)
+			part->size = 2;
+		if (part->period < 1)
+			part->period = 1;
+		return (part->size > range) ? -1 : 0;
+
+	case WORKLOAD_SEQ:
+		part->size = (p1 < 0) ? SEQ_DEFAULT_RUN : (page_t) p1;
+		return (part->size < 1) ? -1 : 0;
+
+	case WORKLOAD_LOOP:
+		part->size = (p1 < 0) ? range / 2 : (page_t) p1;
+		if (part->size < 2)
+			part->size = 2;
+		return (part->size > range) ? -1 : 0;
+
+	default:
+		return (p1 >= 0) ? -1 : 0;
+	}
+}
+
+/*
+ * Function to set up a workload from its description (see above).
+ *		:param workload: the workload to set up
+ *		:param spec: the description, e.g. "zipf:1.2" or "zipf@3,loop:100@1"
+ *		:param range: pages are drawn from 0 to range - 1
+ *		:param count: the length of the trace (sets the default phase period)
+ *		:param seed: the seed of the per-phase and per-run choices
+ * **Returns**: 0, or -1 if the description isn't valid (the message saying why
+ *				has been printed)
+ */
+int workload_parse(struct workload *workload, const char *spec, page_t range, long count,
+				   uint64_t seed) {
+	static const char *names[] = { "uniform", "zipf", "phase", "seq", "loop" };
+
+	workload->range = range;
+	workload->seed = seed;
+	workload->write_ratio = 0;
+	workload->num_parts = 0;
+
+	while (*spec) {
+		struct workload_part *part = &workload->parts[workload->num_parts];
+		double p1 = -1, p2 = -1;
+		size_t len = strcspn(spec, ":@,");
+		char *end;
+		int kind;
+
+		if (workload->num_parts == WORKLOAD_MAX_PARTS) {
+			printf("Error: a workload can mix at most %d patterns.\n", WORKLOAD_MAX_PARTS);
+			return -1;
+		}
+		for (kind = 0; kind <= WORKLOAD_LOOP; kind++) {
+			if (strlen(names[kind]) == len && strncmp(spec, names[kind], len) == 0)
+				break;
+		}
+		if (kind > WORKLOAD_LOOP) {
+			printf("Error: unknown workload pattern %.*s (uniform, zipf, phase, seq, or loop).\n",
+				   (int) len, spec);
+			return -1;
+		}
+		if (range < 2) {
+			printf("Error: the %s pattern needs a range of at least 2.\n", names[kind]);
+			return -1;
+		}
+
+		/* parameters, then the weight, then the comma before the next pattern */
+		part->kind = kind;
+		part->weight = 1;
+		spec += len;
+		if ((spec = parse_param(spec, &p1)) && (spec = parse_param(spec, &p2)) &&
+			*spec == '@') {
+			part->weight = strtod(spec + 1, &end);
+			spec = (end == spec + 1 || !(part->weight > 0)) ? NULL : end;
+		}
+		if (spec && *spec == ',' && spec[1] != '\0')
+			spec++;
+		else if (spec && *spec != '\0')
+			spec = NULL;
+
+		if (!spec || setup_part(part, p1, p2, range, count) != 0) {
+			printf("Error: invalid parameters for the %s pattern.\n", names[kind]);
+			return -1;
+		}
+		workload->num_parts++;
+	}
+
+	if (workload->num_parts == 0) {
+		printf("Error: empty workload description.\n");
+		return -1;
+	}
+	build_alias(workload);
+	return 0;
+}
+
+/*
+ * Function to draw a candidate for reference i of a trace.
+ *		:param workload: the workload
+ *		:param i: the position of the reference in the trace
+ *		:param attempt: 0, or how many candidates for this reference came out equal
+ *						to the page before it and were thrown away
+ * **Returns**: the page
+ */
+page_t workload_page(const struct workload *workload, long i, int attempt) {
+	const struct workload_part *part = &workload->parts[0];
+	page_t range = workload->range, start;
+	struct draws d;
+
+	d.key[0] = (uint32_t) workload->seed;
+	d.key[1] = (uint32_t) (workload->seed >> 32);
+	d.ctr[0] = (uint32_t) i;
+	d.ctr[1] = (uint32_t) ((uint64_t) i >> 32);
+	d.ctr[2] = (uint32_t) attempt;
+	d.ctr[3] = 0;
+	d.left = 0;
+
+	if (workload->num_parts > 1) {
+		uint64_t bits = next_draw(&d);
+		int column = (int) ((bits >> 32) % workload->num_parts);
+		double coin = (bits & 0xffffffffULL) * (1.0 / 4294967296.0);
+		part = &workload->parts[(coin < workload->prob[column]) ? column : workload->alias[column]];
+	}
+
+	switch (part->kind) {
+	case WORKLOAD_ZIPF:
+		return zipf_rank(part, range, &d) - 1;
+
+	case WORKLOAD_PHASE:
+		start = mix64(workload->seed ^ mix64(i / part->period)) % (range - part->size + 1);
+		return start + next_draw(&d) % part->size;
+
+	/* the scans have nothing to draw again, so a redraw steps further along */
+	case WORKLOAD_SEQ:
+		start = mix64(workload->seed ^ mix64(~(uint64_t) (i / part->size))) % range;
+		return (start + i % part->size + attempt) % range;
+
+	case WORKLOAD_LOOP:
+		return (i + attempt) % part->size;
+
+	default:
+		return next_draw(&d) % range;
+	}
+}
+
+/*
+ * Function to draw reference i of a trace, given the page before it.
+ *		:param workload: the workload
+ *		:param i: the position of the reference in the trace
+ *		:param prev: the page before it
+ * **Returns**: the first candidate that differs from prev
+ */
+static page_t next_page(const struct workload *workload, long i, page_t prev) {
+	int attempt = 0;
+	page_t page = workload_page(workload, i, 0);
+	while (page == prev)
+		page = workload_page(workload, i, ++attempt);
+	return page;
+}
+
+/*
+ * Function to generate a run of references of a trace.
+ *		:param workload: the workload
+ *		:param start: the position of the first reference in the trace
+ *		:param num_pages: the number of references
+ *		:param prev: the page before the first one (or a guess at it)
+ *		:param pages: where to store them
+ */
+void workload_fill(const struct workload *workload, long start, int num_pages, page_t prev,
+				   page_t pages[]) {
+	int i;
+	for (i = 0; i < num_pages; i++)
+		pages[i] = prev = next_page(workload, start + i, prev);
+}
+
+/*
+ * Function to correct a run of references that workload_fill generated from a
+ * guess at the page before it, now that the real one is known. References are
+ * redone until one comes out as it was; every one after it then stands.
+ *		:param workload: the workload
+ *		:param start: the position of the first reference in the trace
+ *		:param num_pages: the number of references
+ *		:param prev: the page before the first one
+ *		:param pages: the references, as generated from the guess
+ */
+void workload_refill(const struct workload *workload, long start, int num_pages, page_t prev,
+					 page_t pages[]) {
+	int i;
+	for (i = 0; i < num_pages; i++) {
+		page_t page = next_page(workload, start + i, prev);
+		if (page == pages[i])
+			return;
+		pages[i] = prev = page;
+	}
+}
+
+/*
+ * Function to decide which of a run of references write their page.
+ *		:param workload: the workload
+ *		:param start: the position of the first reference in the trace
+ *		:param num_pages: the number of references
+ *		:param writes: where to store 1 for each write, 0 for each read
+ */
+void workload_fill_writes(const struct workload *workload, long start, int num_pages,
+						  unsigned char writes[]) {
+	uint64_t key = mix64(~workload->seed);
+	int i;
+	for (i = 0; i < num_pages; i++)
+		writes[i] = unit(mix64(key ^ (uint64_t) (start + i))) < workload->write_ratio;
+}
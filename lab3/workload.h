@@ -0,0 +1,51 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stdint.h>
+#include "page.h"
+
+#define WORKLOAD_MAX_PARTS 8	/* most modes one mixture can combine */
+
+/* the kinds of reference pattern a workload can be made of (see workload.c) */
+#define WORKLOAD_UNIFORM 0	/* every page equally likely */
+#define WORKLOAD_ZIPF 1		/* page k (from 0) has popularity 1 / (k + 1)^s */
+#define WORKLOAD_PHASE 2	/* uniform within a working set that moves every period */
+#define WORKLOAD_SEQ 3		/* runs of consecutive pages, each starting somewhere new */
+#define WORKLOAD_LOOP 4		/* the same consecutive pages, over and over */
+
+/* one reference pattern of a workload */
+struct workload_part {
+	int kind;			/* WORKLOAD_UNIFORM, WORKLOAD_ZIPF, ... */
+	double weight;		/* share of the references drawn from this pattern */
+	page_t size;		/* PHASE: working set size; SEQ: run length; LOOP: loop length */
+	long period;		/* PHASE: references per phase */
+
+	/* ZIPF: exponent, and the constants of rejection-inversion sampling */
+	double s;
+	double h_x1;		/* H(1.5) - 1 */
+	double h_n;			/* H(range + 0.5) */
+	double accept;		/* 2 - H^-1(H(2.5) - h(2)) */
+};
+
+/* a reference pattern, or a weighted mixture of several */
+struct workload {
+	page_t range;		/* pages are drawn from 0 to range - 1 */
+	uint64_t seed;		/* seed of the per-phase and per-run choices */
+	double write_ratio;	/* share of the references that write their page (0 by default) */
+	int num_parts;
+	struct workload_part parts[WORKLOAD_MAX_PARTS];
+	double prob[WORKLOAD_MAX_PARTS];	/* alias table choosing a part per reference */
+	int alias[WORKLOAD_MAX_PARTS];
+};
+
+int workload_parse(struct workload *workload, const char *spec, page_t range, long count,
+				   uint64_t seed);
+page_t workload_page(const struct workload *workload, long i, int attempt);
+void workload_fill(const struct workload *workload, long start, int num_pages, page_t prev,
+				   page_t pages[]);
+void workload_refill(const struct workload *workload, long start, int num_pages, page_t prev,
+					 page_t pages[]);
+void workload_fill_writes(const struct workload *workload, long start, int num_pages,
+						  unsigned char writes[]);
+
+#endif
@@ -0,0 +1,180 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include "workpool.h"
+
+/*
+ * Author: Peter Mountanos
+ * Date created: Oct. 16, 2026
+ *
+ * Description:
+ * workpool runs a fixed set of independent jobs on a pool of threads. The jobs
+ * are sorted by their estimated cost and dealt out round-robin, so each worker
+ * starts with a queue that runs from its most to its least expensive job. A
+ * worker takes jobs from the front of its own queue; once that is empty, it
+ * steals from the back of the other workers' queues. Since job costs can differ
+ * by orders of magnitude (an optimal policy run vs. a FIFO run), stealing keeps
+ * every thread busy until the last job is handed out.
+ *
+ * Usage:
+ *   Compile with another file (and -pthread); there is no main function
+ */
+
+//======================================================//
+
+/* one worker's queue of job indices; jobs[head..tail-1] are still waiting */
+struct job_queue {
+	int *jobs;
+	int head;
+	int tail;
+	pthread_mutex_t lock;
+};
+
+/* state shared by every worker of a pool */
+struct pool {
+	struct job_queue *queues;
+	int num_threads;
+	job_fn fn;
+	void *ctx;
+};
+
+/* what each worker thread is started with */
+struct worker {
+	struct pool *pool;
+	int id;
+};
+
+/* a job index paired with its estimated cost, for sorting */
+struct costed_job {
+	long cost;
+	int job;
+};
+
+/*
+ * Function to order jobs by decreasing cost, then by index.
+ *		:param a: pointer to the first struct costed_job
+ *		:param b: pointer to the second struct costed_job
+ * **Returns**: negative if a should run first, positive if b should
+ */
+static int by_cost(const void *a, const void *b) {
+	const struct costed_job *x = a, *y = b;
+	if (x->cost != y->cost)
+		return (x->cost > y->cost) ? -1 : 1;
+	return x->job - y->job;
+}
+
+/*
+ * Function to take a job off one end of a queue.
+ *		:param queue: the queue to take from
+ *		:param from_front: "boolean"; take the front (owner) or the back (thief)
+ * **Returns**: the job index, or -1 if the queue is empty
+ */
+static int take_job(struct job_queue *queue, int from_front) {
+	int job = -1;
+	pthread_mutex_lock(&queue->lock);
+	if (queue->head < queue->tail)
+		job = from_front ? queue->jobs[queue->head++] : queue->jobs[--queue->tail];
+	pthread_mutex_unlock(&queue->lock);
+	return job;
+}
+
+/*
+ * Function run by each worker thread: drain its own queue, then steal from the
+ * others until no job is left anywhere (no jobs are added once the pool starts).
+ *		:param arg: the worker's struct worker
+ * **Returns**: NULL
+ */
+static void * work(void *arg) {
+	struct worker *self = arg;
+	struct pool *pool = self->pool;
+	int job, k;
+
+	for (;;) {
+		job = take_job(&pool->queues[self->id], 1);
+		for (k = 1; job == -1 && k < pool->num_threads; k++)
+			job = take_job(&pool->queues[(self->id + k) % pool->num_threads], 0);
+		if (job == -1)
+			break;
+		pool->fn(pool->ctx, job);
+	}
+	return NULL;
+}
+
+/*
+ * Function to run every job, spread across a number of threads. It returns once
+ * all jobs have finished. With one thread the jobs are simply run in order.
+ *		:param num_jobs: the number of jobs (indices 0..num_jobs-1)
+ *		:param cost: estimated relative cost of each job (only the order matters)
+ *		:param num_threads: the number of worker threads to use
+ *		:param fn: the function that runs one job
+ *		:param ctx: context handed to fn for every job
+ * **Returns**: 0 on success, -1 if memory or threads could not be allocated
+ */
+int run_jobs(int num_jobs, long cost[], int num_threads, job_fn fn, void *ctx) {
+	int i;
+	if (num_threads > num_jobs)
+		num_threads = num_jobs;
+	if (num_threads <= 1) {
+		for (i = 0; i < num_jobs; i++)
+			fn(ctx, i);
+		return 0;
+	}
+
+	/* sort the jobs by cost, then deal them out so every queue runs most to least costly */
+	struct costed_job *order = malloc(num_jobs * sizeof(struct costed_job));
+	int *slots = malloc(num_jobs * sizeof(int));
+	struct job_queue *queues = calloc(num_threads, sizeof(struct job_queue));
+	struct worker *workers = malloc(num_threads * sizeof(struct worker));
+	pthread_t *threads = malloc(num_threads * sizeof(pthread_t));
+	if (!order || !slots || !queues || !workers || !threads) {
+		free(order);
+		free(slots);
+		free(queues);
+		free(workers);
+		free(threads);
+		return -1;
+	}
+
+	for (i = 0; i < num_jobs; i++) {
+		order[i].cost = cost[i];
+		order[i].job = i;
+	}
+	qsort(order, num_jobs, sizeof(struct costed_job), by_cost);
+
+	int t, used = 0;
+	for (t = 0; t < num_threads; t++) {
+		queues[t].jobs = &slots[used];
+		queues[t].head = queues[t].tail = 0;
+		for (i = t; i < num_jobs; i += num_threads)
+			queues[t].jobs[queues[t].tail++] = order[i].job;
+		used += queues[t].tail;
+		pthread_mutex_init(&queues[t].lock, NULL);
+	}
+
+	struct pool pool = { queues, num_threads, fn, ctx };
+	int started;
+	for (started = 0; started < num_threads; started++) {
+		workers[started].pool = &pool;
+		workers[started].id = started;
+		if (pthread_create(&threads[started], NULL, work, &workers[started]) != 0)
+			break;
+	}
+
+	/* if some threads failed to start, the running ones steal their jobs; if none
+	 * started, the caller's thread does the work */
+	if (started == 0) {
+		workers[0].pool = &pool;
+		workers[0].id = 0;
+		work(&workers[0]);
+	}
+	for (t = 0; t < started; t++)
+		pthread_join(threads[t], NULL);
+
+	for (t = 0; t < num_threads; t++)
+		pthread_mutex_destroy(&queues[t].lock);
+	free(order);
+	free(slots);
+	free(queues);
+	free(workers);
+	free(threads);
+	return 0;
+}
@@ -0,0 +1,9 @@
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+
+/* a job run by the pool: ctx is shared by every job, job is the job's index */
+typedef void (*job_fn)(void *ctx, int job);
+
+int run_jobs(int num_jobs, long cost[], int num_threads, job_fn fn, void *ctx);
+
+#endif